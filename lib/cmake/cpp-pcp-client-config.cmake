@@ -0,0 +1,10 @@
+# Package configuration of an installed cpp-pcp-client, for
+# find_package(cpp-pcp-client); it sets CPP_PCP_CLIENT_INCLUDE_DIRS and
+# CPP_PCP_CLIENT_LIBRARIES and defines the pcp_compile_schemas function
+get_filename_component(CPP_PCP_CLIENT_PREFIX "${CMAKE_CURRENT_LIST_DIR}/../../.." ABSOLUTE)
+
+set(CPP_PCP_CLIENT_INCLUDE_DIRS "${CPP_PCP_CLIENT_PREFIX}/include")
+find_library(CPP_PCP_CLIENT_LIBRARIES NAMES cpp-pcp-client libcpp-pcp-client
+    HINTS "${CPP_PCP_CLIENT_PREFIX}/lib" NO_DEFAULT_PATH)
+
+include("${CMAKE_CURRENT_LIST_DIR}/pcp_compile_schemas.cmake")
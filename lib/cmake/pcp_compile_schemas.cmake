@@ -0,0 +1,46 @@
+include(CMakeParseArguments)
+
+# The schema compiler is a target of the cpp-pcp-client build; once
+# installed, it's found in the bin directory of the install prefix
+if (NOT TARGET cpp-pcp-client-schema-compiler)
+    find_program(CPP_PCP_CLIENT_SCHEMA_COMPILER cpp-pcp-client-schema-compiler
+        HINTS "${CMAKE_CURRENT_LIST_DIR}/../../../bin")
+
+    if (NOT CPP_PCP_CLIENT_SCHEMA_COMPILER)
+        message(FATAL_ERROR "cpp-pcp-client-schema-compiler not found")
+    endif()
+
+    add_executable(cpp-pcp-client-schema-compiler IMPORTED)
+    set_target_properties(cpp-pcp-client-schema-compiler PROPERTIES
+        IMPORTED_LOCATION "${CPP_PCP_CLIENT_SCHEMA_COMPILER}")
+endif()
+
+# pcp_compile_schemas(<sources_var> NAME <name> NAMESPACE <namespace>
+#                     SCHEMAS <schema file>...)
+# Generate the validation functions of the given JSON schema files in
+# <name>.hpp and <name>.cc, within ${CMAKE_CURRENT_BINARY_DIR}/generated,
+# and store their paths in <sources_var>; see tools/schema_compiler.cc
+function(pcp_compile_schemas sources_var)
+    cmake_parse_arguments(ARG "" "NAME;NAMESPACE" "SCHEMAS" ${ARGN})
+    set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/generated")
+    set(header "${output_dir}/${ARG_NAME}.hpp")
+    set(source "${output_dir}/${ARG_NAME}.cc")
+    set(schemas)
+
+    foreach(schema ${ARG_SCHEMAS})
+        get_filename_component(schema_path "${schema}" ABSOLUTE)
+        list(APPEND schemas "${schema_path}")
+    endforeach()
+
+    add_custom_command(
+        OUTPUT "${header}" "${source}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${output_dir}"
+        COMMAND cpp-pcp-client-schema-compiler
+            "${ARG_NAMESPACE}" "${header}" "${source}" ${schemas}
+        DEPENDS cpp-pcp-client-schema-compiler ${schemas}
+        COMMENT "Compiling JSON schemas into ${ARG_NAME}"
+        VERBATIM
+    )
+
+    set(${sources_var} "${header}" "${source}" PARENT_SCOPE)
+endfunction()
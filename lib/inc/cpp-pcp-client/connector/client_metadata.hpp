@@ -5,6 +5,7 @@
 #include <cpp-pcp-client/util/logging.hpp>
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 namespace PCPClient {
@@ -29,6 +30,10 @@ class LIBCPP_PCP_CLIENT_EXPORT ClientMetadata {
     leatherman::logging::log_level loglevel{};
     std::ostream* logstream;
 
+    /// WebSocket subprotocols requested in the opening handshake,
+    /// by order of preference; the broker may select one of them
+    std::vector<std::string> ws_subprotocols {};
+
     /// Throws a connection_config_error in case: the client
     /// certificate file does not exist or is invalid; it fails to
     /// retrieve the client identity from the file; the client
@@ -8,7 +8,9 @@
 #include <cpp-pcp-client/export.h>
 
 #include <boost/nowide/fstream.hpp>
+#include <boost/utility/string_ref.hpp>
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -53,6 +55,7 @@ namespace websocketpp {
 namespace PCPClient {
 
   struct ws_config;
+  class IoReactor;
 
 // Constants
 
@@ -111,15 +114,30 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     Connection(std::vector<std::string> broker_ws_uris,
                ClientMetadata client_metadata);
 
+    /// As above, with the WebSocket events handled by the threads of
+    /// the specified reactor, which may be shared with other
+    /// Connection instances, rather than by a dedicated thread (in
+    /// case io_reactor is null). The instance must then not be
+    /// destroyed by its own callbacks (see IoReactor).
+    Connection(std::string broker_ws_uri,
+               ClientMetadata client_metadata,
+               std::shared_ptr<IoReactor> io_reactor);
+
+    Connection(std::vector<std::string> broker_ws_uris,
+               ClientMetadata client_metadata,
+               std::shared_ptr<IoReactor> io_reactor);
+
     ~Connection();
 
     /// Return the connection state
     ConnectionState getConnectionState() const;
 
     /// Callback setters (callbacks will be executed by the
-    /// WebSocket event handlers).
+    /// WebSocket event handlers). The payload of the message is
+    /// moved into the onMessage callback's argument, so the callback
+    /// can take its ownership without copying it.
     void setOnOpenCallback(std::function<void()> onOpen_callback);
-    void setOnMessageCallback(std::function<void(const std::string& msg)> onMessage_callback);
+    void setOnMessageCallback(std::function<void(std::string msg)> onMessage_callback);
     void setOnCloseCallback(std::function<void()> onClose_callback);
     void setOnFailCallback(std::function<void()> onFail_callback);
 
@@ -147,6 +165,14 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     void send(const std::string& msg);
     void send(void* const serialized_msg_ptr, size_t msg_len);
 
+    /// Send a binary message made of the concatenation of the
+    /// specified buffers; each buffer is appended once, from its own
+    /// storage, to the payload of the WebSocket message, which is
+    /// allocated once by the endpoint's message manager; that saves
+    /// an intermediate buffer and its copy.
+    /// Throw a connection_processing_error as above.
+    void send(const std::vector<boost::string_ref>& buffers);
+
     /// Ping the broker.
     /// Throw a connection_processing_error in case of failure.
     void ping(const std::string& binary_payload = PING_PAYLOAD_DEFAULT);
@@ -161,6 +187,11 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     /// Return the current broker WebSocket URI to target
     std::string const& getWsUri();
 
+    /// Return the WebSocket subprotocol selected by the broker among
+    /// the requested ones (see ClientMetadata) for the current
+    /// connection, or an empty string if none was
+    std::string getSubprotocol() const;
+
   private:
     /// WebSocket URIs of PCP brokers; first entry is the default
     std::vector<std::string> broker_ws_uris_;
@@ -186,19 +217,40 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     /// Consecutive pong timeouts counter (NB: useful for debug msgs)
     uint32_t consecutive_pong_timeouts_ { 0 };
 
+    /// Shared event loop, if any; it must outlive the endpoint
+    std::shared_ptr<IoReactor> io_reactor_;
+
+    /// The instance the endpoint handlers are executed on; each
+    /// handler holds the mutex while executing. cleanUp resets the
+    /// connection pointer, so that the handlers still pending on a
+    /// shared event loop afterwards become no-ops.
+    struct HandlerTarget {
+        Util::recursive_mutex mtx;
+        Connection* connection;
+        bool in_handler;
+    };
+
+    std::shared_ptr<HandlerTarget> handler_target_;
+
     /// Transport layer endpoint instance
     std::unique_ptr<WS_Client_Type> endpoint_;
 
-    /// Transport layer event loop thread
+    /// Transport layer event loop thread, unless the event loop is
+    /// shared
     std::shared_ptr<Util::thread> endpoint_thread_;
 
+    /// Handles of the WebSocket connections that may still have
+    /// pending handlers on the shared event loop, which may refer to
+    /// the endpoint
+    std::vector<WS_Connection_Handle> connection_handles_;
+
     /// To synchronize the onOpen event
     Util::condition_variable onOpen_cv;
     Util::mutex onOpen_mtx;
 
     // Callback functions called by the WebSocket event handlers.
     std::function<void()> onOpen_callback_;
-    std::function<void(const std::string& message)> onMessage_callback_;
+    std::function<void(std::string message)> onMessage_callback_;
     std::function<void()> onClose_callback_;
     std::function<void()> onFail_callback_;
 
@@ -208,6 +260,10 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     /// To manage the connection state
     Util::mutex state_mutex_;
 
+    /// The subprotocol of the current connection, set on open
+    std::string subprotocol_;
+    mutable Util::mutex subprotocol_mutex_;
+
     /// Connect and wait until the connection is open or for the
     /// configured connection_timeout
     void connectAndWait();
@@ -215,7 +271,11 @@ class LIBCPP_PCP_CLIENT_EXPORT Connection {
     /// Try closing the connection
     void tryClose();
 
-    /// Stop the event loop thread and perform the necessary clean up
+    /// Stop the event loop thread and perform the necessary clean up;
+    /// with a shared event loop, detach the pending handlers from
+    /// this instance instead, after waiting for the one executed by
+    /// another thread, if any, and leave the endpoint to the reactor
+    /// until they have completed
     void cleanUp();
 
     // Connect the endpoint
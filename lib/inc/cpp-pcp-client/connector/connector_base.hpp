@@ -11,10 +11,14 @@
 #include <cpp-pcp-client/validator/schema.hpp>
 
 #include <cpp-pcp-client/util/logging.hpp>
+#include <cpp-pcp-client/util/memory_resource.hpp>
+#include <cpp-pcp-client/util/message_stamps.hpp>
 #include <cpp-pcp-client/util/thread.hpp>
 
 #include <cpp-pcp-client/export.h>
 
+#include <atomic>
+
 
 namespace PCPClient {
 
@@ -77,10 +81,28 @@ class LIBCPP_PCP_CLIENT_EXPORT ConnectorBase {
         uint32_t pong_timeouts_before_retry,
         long ws_pong_timeout_ms);
 
+    // constructor io reactor addition
+    ConnectorBase(std::vector<std::string> broker_ws_uris,
+        std::string client_type,
+        std::string ca_crt_path,
+        std::string client_crt_path,
+        std::string client_key_path,
+        std::string client_crl_path,
+        std::string ws_proxy,
+        leatherman::logging::log_level loglevel,
+        std::ostream* logstream,
+        std::shared_ptr<IoReactor> io_reactor,
+        long ws_connection_timeout_ms,
+        uint32_t pong_timeouts_before_retry,
+        long ws_pong_timeout_ms);
+
     /// Calls stopMonitorTaskAndWait if the Monitoring Task thread is
     /// still active. In case an exception was previously stored by
     /// the Monitoring Task, the error message will be logged, but
     /// the exception won't be rethrown.
+    /// NB: a Connector must not be destroyed by its own callbacks;
+    ///     with a shared IoReactor, the destructor waits for the
+    ///     WebSocket handler being executed, if any (see IoReactor)
     virtual ~ConnectorBase();
 
     /// Throw a schema_redefinition_error if the specified schema has
@@ -91,6 +113,26 @@ class LIBCPP_PCP_CLIENT_EXPORT ConnectorBase {
     /// Set an optional callback for error messages
     void setPCPErrorCallback(MessageCallback callback);
 
+    /// Defer parsing and validating the JSON data of incoming
+    /// messages until a callback reads it through the getData or
+    /// hasInvalidData methods of ParsedChunks, whose data and
+    /// invalid_data fields are then not set; callbacks that don't
+    /// read the data won't pay for it. Disabled by default.
+    /// The data must not be accessed after the Connector is
+    /// destroyed, as it's validated with the Connector's schemas.
+    void setLazyDataParsing(bool lazy_data_parsing);
+
+    /// Take the working memory for validating the envelopes of
+    /// incoming messages (the stack of the JSON reader) from an arena,
+    /// rewound after each message is dispatched, whose buffers come
+    /// from the specified resource (by default, the global heap); as
+    /// each Connector has its own arena, Connectors running in the
+    /// same process don't contend for it. The parsed chunks passed to
+    /// the callbacks are still allocated on the global heap. The
+    /// resource must outlive the Connector.
+    /// NB: this function is not thread safe; call it before connect()
+    void setMemoryResource(Util::MemoryResource* resource);
+
     /// Open the WebSocket connection
     ///
     /// Check the state of the underlying connection (WebSocket); in
@@ -190,6 +232,9 @@ class LIBCPP_PCP_CLIENT_EXPORT ConnectorBase {
     /// Client metadata
     ClientMetadata client_metadata_;
 
+    /// Shared event loop of the connection, if any (see IoReactor)
+    std::shared_ptr<IoReactor> io_reactor_;
+
     /// Content validator
     Validator validator_;
 
@@ -199,6 +244,20 @@ class LIBCPP_PCP_CLIENT_EXPORT ConnectorBase {
     /// Error callback
     MessageCallback error_callback_;
 
+    /// Flag; set by setLazyDataParsing, possibly while the event
+    /// loop reads it in processMessage
+    std::atomic<bool> lazy_data_parsing_;
+
+    /// IDs and expiry times of outbound messages
+    Util::MessageIdGenerator id_generator_;
+    Util::ExpiryFormatter expiry_formatter_;
+
+    /// Working memory of the envelope validation of processMessage,
+    /// which is only executed by the event loop of the connection,
+    /// one message at a time (also when the event loop is shared);
+    /// set by setMemoryResource
+    std::unique_ptr<Util::MonotonicBufferResource> message_arena_;
+
     void checkConnectionInitialization();
 
     // WebSocket Callback for the Connection instance to handle all
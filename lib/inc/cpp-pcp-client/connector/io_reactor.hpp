@@ -0,0 +1,92 @@
+#ifndef CPP_PCP_CLIENT_SRC_CONNECTOR_IO_REACTOR_H_
+#define CPP_PCP_CLIENT_SRC_CONNECTOR_IO_REACTOR_H_
+
+#include <cpp-pcp-client/util/thread.hpp>
+#include <cpp-pcp-client/export.h>
+
+#include <boost/asio/io_service.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace PCPClient {
+
+//
+// IoReactor
+//
+
+/// An event loop run by a fixed pool of threads, which can be
+/// shared by many Connection instances (and the Connectors that own
+/// them) instead of each Connection running its own event loop
+/// thread; a process with many Connectors then needs only as many
+/// I/O threads as the reactor has.
+///
+/// The handlers of a WebSocket connection are executed in the order
+/// of its events, one at a time, as the transport layer dispatches
+/// them through a strand per connection; handlers of different
+/// connections may be executed concurrently. As the threads are
+/// shared, the callbacks of a Connection should not block.
+///
+/// The reactor must be held by a std::shared_ptr; each Connection
+/// keeps a reference to it, so that it's stopped only after the
+/// last Connection is destroyed.
+///
+/// A Connection destructor waits for the handler of its WebSocket
+/// connection being executed by another thread, if any; the handlers
+/// that are still pending afterwards don't call into the Connection.
+/// Hence a Connection, or the Connector that owns it, can be
+/// destroyed by code executed by the reactor threads, but not by its
+/// own callbacks.
+class LIBCPP_PCP_CLIENT_EXPORT IoReactor {
+  public:
+    IoReactor() = delete;
+    IoReactor(const IoReactor&) = delete;
+    IoReactor& operator=(const IoReactor&) = delete;
+
+    /// Start num_threads threads running the event loop.
+    /// Throw a connection_config_error if num_threads is 0 or in
+    /// case it fails to start the threads.
+    explicit IoReactor(unsigned int num_threads);
+
+    /// Stop the event loop and wait for its threads to terminate
+    ~IoReactor();
+
+    /// Return the number of threads running the event loop
+    unsigned int getNumThreads() const;
+
+    /// Return the event loop, to initialize the transport layer
+    boost::asio::io_service& getIoService();
+
+    /// Return true if the calling thread runs the event loop
+    bool isEventLoopThread() const;
+
+    /// Keep the specified object until all the handles have expired,
+    /// which is checked periodically by the event loop; pending
+    /// handlers that refer to the object can then complete after
+    /// its owner has been destroyed. In case the event loop is
+    /// stopped first, the object is released with its pending
+    /// handlers.
+    void releaseWhenExpired(std::shared_ptr<void> object,
+                            std::vector<std::weak_ptr<void>> handles);
+
+  private:
+    /// Shared with the threads, as a thread that releases the last
+    /// reference to the reactor is detached rather than joined
+    std::shared_ptr<boost::asio::io_service> io_service_;
+
+    /// Keeps the event loop running when there are no connections
+    std::unique_ptr<boost::asio::io_service::work> work_;
+
+    std::vector<std::shared_ptr<Util::thread>> threads_;
+
+    /// Run the event loop until it's stopped; exceptions thrown by
+    /// the handlers are logged
+    static void runEventLoop(std::shared_ptr<boost::asio::io_service> io_service);
+
+    /// Stop the event loop and join the threads
+    void stop();
+};
+
+}  // namespace PCPClient
+
+#endif  // CPP_PCP_CLIENT_SRC_CONNECTOR_IO_REACTOR_H_
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cpp-pcp-client/connector/v1/session_association.hpp>
+#include <cpp-pcp-client/protocol/v1/envelope_template.hpp>
 #include <cpp-pcp-client/protocol/v1/message.hpp>
 
 #include <cpp-pcp-client/connector/connector_base.hpp>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <map>
@@ -122,12 +124,40 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
               uint32_t pong_timeouts_before_retry = 3,
               long ws_pong_timeout_ms = 5000);
 
+    // constructor for io reactor addition
+    Connector(std::vector<std::string> broker_ws_uris,
+              std::string client_type,
+              std::string ca_crt_path,
+              std::string client_crt_path,
+              std::string client_key_path,
+              std::string client_crl_path,
+              std::string ws_proxy,
+              leatherman::logging::log_level loglevel,
+              std::ostream* logstream,
+              std::shared_ptr<IoReactor> io_reactor,
+              long ws_connection_timeout_ms = 5000,
+              uint32_t association_timeout_s = 15,
+              uint32_t association_request_ttl_s = 10,  // Unused
+              uint32_t pong_timeouts_before_retry = 3,
+              long ws_pong_timeout_ms = 5000);
+
     /// Set an optional callback for associate responses
     void setAssociateCallback(MessageCallback callback);
 
     /// Set an optional callback for TTL expired messages
     void setTTLExpiredCallback(MessageCallback callback);
 
+    /// Set how the debug chunks of incoming messages are processed
+    /// (see DebugChunkPolicy). The default is DebugChunkPolicy::Lazy:
+    /// each hop is validated only for the callbacks that read the
+    /// debug chunks through the getDebug or getNumInvalidDebug methods
+    /// of ParsedChunks, whereas the debug and num_invalid_debug fields
+    /// are not set. NB: before, the default was Eager; callbacks that
+    /// read those fields directly must switch to the methods, or set
+    /// DebugChunkPolicy::Eager, which sets them before the callbacks
+    /// are executed.
+    void setDebugChunkPolicy(DebugChunkPolicy debug_chunk_policy);
+
     /// Open the WebSocket connection and perform Session Association
     ///
     /// Check the state of the underlying connection (WebSocket); in
@@ -228,6 +258,29 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
                      const std::vector<lth_jc::JsonContainer>& debug
                         = std::vector<lth_jc::JsonContainer> {});
 
+    /// Return the envelope template for messages of the specified
+    /// type, sent by this client to the specified targets; it can
+    /// be reused by the send() overloads below, so that the envelope
+    /// is not built anew for each message.
+    EnvelopeTemplate createEnvelopeTemplate(
+        const std::vector<std::string>& targets,
+        const std::string& message_type,
+        bool destination_report = false) const;
+
+    /// send() overloads that create and send a message with the
+    /// envelope rendered from the specified template, as above.
+    std::string send(const EnvelopeTemplate& envelope_template,
+                     unsigned int timeout,
+                     const lth_jc::JsonContainer& data_json,
+                     const std::vector<lth_jc::JsonContainer>& debug
+                        = std::vector<lth_jc::JsonContainer> {});
+
+    std::string send(const EnvelopeTemplate& envelope_template,
+                     unsigned int timeout,
+                     const std::string& data_binary,
+                     const std::vector<lth_jc::JsonContainer>& debug
+                        = std::vector<lth_jc::JsonContainer> {});
+
     std::string sendError(const std::vector<std::string>& targets,
                           unsigned int timeout,
                           const std::string& id,
@@ -240,6 +293,11 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
     // associated with the schema specified in the envelope.
     void processMessage(const std::string& msg_txt) override;
 
+    // As above, for a message owned by msg_owner; the lazy data and
+    // debug share its ownership, instead of copying the chunks
+    void processMessage(const std::string& msg_txt,
+                        std::shared_ptr<const void> msg_owner);
+
   private:
     /// Associate response callback
     MessageCallback associate_response_callback_;
@@ -253,16 +311,16 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
     /// To keep track of Associate Session timings
     AssociationTimings association_timings_;
 
-    MessageChunk createEnvelope(const std::vector<std::string>& targets,
-                                const std::string& message_type,
-                                unsigned int timeout,
-                                bool destination_report,
-                                std::string& msg_id);
+    /// Set by setDebugChunkPolicy, possibly while the event loop
+    /// reads it in processMessage
+    std::atomic<DebugChunkPolicy> debug_chunk_policy_;
+
+    std::string createEnvelope(const EnvelopeTemplate& envelope_template,
+                               unsigned int timeout,
+                               std::string& msg_id);
 
-    std::string sendMessage(const std::vector<std::string>& targets,
-                            const std::string& message_type,
+    std::string sendMessage(const EnvelopeTemplate& envelope_template,
                             unsigned int timeout,
-                            bool destination_report,
                             const std::string& data_txt,
                             const std::vector<lth_jc::JsonContainer>& debug);
 
@@ -274,6 +332,11 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
     // on onClose or onFail events.
     void closeAssociationTimings();
 
+    // Called by processMessage when an incoming message cannot be
+    // deserialized or validated: log the error and, in case a
+    // session association is in progress, report the failure.
+    void processDeserializationError(const std::string& err_msg);
+
     // PCP Callback executed by processMessage in case of an
     // associate session response.
     void associateResponseCallback(const ParsedChunks& parsed_chunks);
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cpp-pcp-client/protocol/v2/envelope_template.hpp>
 #include <cpp-pcp-client/protocol/v2/message.hpp>
 
 #include <cpp-pcp-client/connector/connector_base.hpp>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <map>
@@ -107,6 +109,21 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
               uint32_t pong_timeouts_before_retry = 3,
               long ws_pong_timeout_ms = 5000);
 
+    // constructor for io reactor addition
+    Connector(std::vector<std::string> broker_ws_uris,
+              std::string client_type,
+              std::string ca_crt_path,
+              std::string client_crt_path,
+              std::string client_key_path,
+              std::string client_crl_path,
+              std::string ws_proxy,
+              leatherman::logging::log_level loglevel,
+              std::ostream* logstream,
+              std::shared_ptr<IoReactor> io_reactor,
+              long ws_connection_timeout_ms = 5000,
+              uint32_t pong_timeouts_before_retry = 3,
+              long ws_pong_timeout_ms = 5000);
+
     /// Send the specified message.
     /// Throw a connection_processing_error in case of failure;
     /// throw a connection_not_init_error in case the connection
@@ -119,7 +136,8 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
     /// The caller may specify:
     ///   - target: a PCP URI string
     ///   - message_type: schema name that identifies the message type
-    ///   - data: as stringified JSON
+    ///   - data: as stringified JSON (checked and spliced verbatim,
+    ///     as described below for the EnvelopeTemplate overloads)
     ///
     /// All methods:
     ///   - throw a connection_processing_error in case of failure;
@@ -135,18 +153,110 @@ class LIBCPP_PCP_CLIENT_EXPORT Connector : public ConnectorBase {
                      const std::string& data_txt,
                      const std::string& in_reply_to = "");
 
+    /// Return the envelope template for messages of the specified
+    /// type, sent by this client to the specified target; it can be
+    /// reused by the send() overload below, so that the envelope is
+    /// not built anew for each message.
+    EnvelopeTemplate createEnvelopeTemplate(const std::string& target,
+                                            const std::string& message_type) const;
+
+    /// send() overload that creates and sends a message with the
+    /// envelope rendered from the specified template, as above.
+    std::string send(const EnvelopeTemplate& envelope_template,
+                     const lth_jc::JsonContainer& data_json,
+                     const std::string& in_reply_to = "");
+
+    /// As above, with the data as JSON text, which is spliced into
+    /// the message verbatim, without being parsed into a DOM and
+    /// serialized again. Unless disabled by setDataTextChecking, the
+    /// text is checked to be well-formed JSON first; throw a
+    /// leatherman::json_container::data_parse_error otherwise.
+    std::string send(const EnvelopeTemplate& envelope_template,
+                     const std::string& data_txt,
+                     const std::string& in_reply_to = "");
+
+    /// Create and send a message with binary data, which is carried
+    /// by the data entry as a base64 string (RFC 4648, with padding);
+    /// receivers that registered the schema of the message type as
+    /// ContentType::Binary get it back in ParsedChunks::binary_data.
+    /// Return the ID of the message and throw as send() does.
+    std::string sendBinary(const std::string& target,
+                           const std::string& message_type,
+                           const std::string& data_binary,
+                           const std::string& in_reply_to = "");
+
+    /// As above, with the envelope rendered from the specified
+    /// template; the data is encoded straight into the message.
+    std::string sendBinary(const EnvelopeTemplate& envelope_template,
+                           const std::string& data_binary,
+                           const std::string& in_reply_to = "");
+
+    /// Whether the send() overloads that take JSON text check it;
+    /// enabled by default. Disable it when the text is known to be
+    /// valid, e.g. when it's been produced by a serializer.
+    /// NB: this function is not thread safe
+    void setDataTextChecking(bool check_data_txt);
+
     std::string sendError(const std::string& target,
                           const std::string& in_reply_to,
                           const std::string& description);
 
+    /// Whether to request the MessagePack encoding of messages (see
+    /// protocol/v2/msgpack.hpp) through the WebSocket subprotocol of
+    /// the connection; disabled by default. It's used only if the
+    /// broker selects it, otherwise messages are sent as JSON text.
+    /// Messages are transcoded, so they are validated and delivered
+    /// to the callbacks as JSON ones.
+    /// NB: it's opt-in as it trades speed for size; on typical agent
+    /// payloads, a message round trip is about 15-20% slower than with
+    /// JSON, whereas messages are only 1-23% smaller. Enable it only
+    /// where the bandwidth matters more than the CPU time.
+    /// Throw a connection_config_error in case the connection was
+    /// already initialized by connect().
+    /// NB: this function is not thread safe
+    void setMessagePackEncoding(bool use_msgpack);
+
+    /// Whether the messages of the current connection are encoded with
+    /// MessagePack, as negotiated with the broker
+    bool isUsingMessagePack() const;
+
+    /// Open the WebSocket connection, as ConnectorBase::connect() does;
+    /// the message encoding negotiated with the broker is then read
+    /// once, rather than for each message sent or processed.
+    void connect(int max_connect_attempts = 0) override;
+
   protected:
     // WebSocket Callback for the Connection instance to handle all
     // incoming messages.
-    // Parse and validate the passed message; execute the callback
-    // associated with the schema specified in the envelope.
+    // Decode the message, in case MessagePack was negotiated, then
+    // process it as JSON text (see processJsonMessage).
     void processMessage(const std::string& msg_txt) override;
 
   private:
+    // Set by setDataTextChecking
+    bool check_data_txt_;
+
+    // Whether MessagePack was negotiated for the current connection;
+    // set when it's open and reset when it's closed
+    std::atomic<bool> using_message_pack_;
+
+    // Set using_message_pack_ from the subprotocol of the connection
+    void updateMessageEncoding();
+
+    // Parse and validate the passed message; execute the callback
+    // associated with the schema specified in the envelope.
+    void processJsonMessage(const std::string& msg_txt);
+
+    // Render the message with the specified data, which must be valid
+    // JSON text, and send it; return its ID
+    std::string sendText(const EnvelopeTemplate& envelope_template,
+                         boost::string_ref data_txt,
+                         const std::string& in_reply_to);
+
+    // Send the rendered message, encoded with MessagePack if it was
+    // negotiated
+    void sendRendered(const std::string& msg_txt);
+
     // PCP Callback executed by processMessage when an error message
     // is received.
     void errorMessageCallback(const ParsedChunks&);
@@ -6,6 +6,8 @@
 #include <cpp-pcp-client/validator/schema.hpp>
 #include <cpp-pcp-client/export.h>
 
+#include <functional>
+#include <memory>
 #include <string>
 
 namespace PCPClient {
@@ -16,6 +18,18 @@ namespace PCPClient {
 namespace lth_jc = leatherman::json_container;
 
 struct LIBCPP_PCP_CLIENT_EXPORT ParsedChunks {
+    // Parses and validates the JSON data of a lazy instance (see the
+    // lazy JSON data ctor), given its envelope; store the data and
+    // return true if it's valid, otherwise return false
+    using DataParser = std::function<bool(const lth_jc::JsonContainer& envelope,
+                                          lth_jc::JsonContainer& data)>;
+
+    // Parses and validates the debug chunks of an instance whose
+    // debug is lazy (see setDebugParser); store the valid ones and
+    // return the number of invalid ones
+    using DebugParser = std::function<unsigned int(
+        std::vector<lth_jc::JsonContainer>& debug)>;
+
     // Envelope
     lth_jc::JsonContainer envelope;
 
@@ -29,6 +43,7 @@ struct LIBCPP_PCP_CLIENT_EXPORT ParsedChunks {
     // Debug
     std::vector<lth_jc::JsonContainer> debug;
     unsigned int num_invalid_debug;
+    unsigned int num_skipped_debug;     // neither parsed nor validated
 
     ParsedChunks();
 
@@ -51,7 +66,63 @@ struct LIBCPP_PCP_CLIENT_EXPORT ParsedChunks {
                  std::vector<lth_jc::JsonContainer> _debug,
                  unsigned int _num_invalid_debug);
 
+    // Lazy JSON data ctor: the data is parsed and validated by the
+    // first getData or hasInvalidData call, on any copy of this
+    // instance; the data and invalid_data fields are not set
+    ParsedChunks(lth_jc::JsonContainer _envelope,
+                 DataParser _data_parser,           // lazy JSON data
+                 std::vector<lth_jc::JsonContainer> _debug,
+                 unsigned int _num_invalid_debug);
+
+    // Return the JSON data; parse and validate it first, in case of
+    // lazy data. The returned container is empty if the data is
+    // invalid. Thread-safe.
+    const lth_jc::JsonContainer& getData() const;
+
+    // Return true if the data is invalid; parse and validate it
+    // first, in case of lazy data. Thread-safe.
+    bool hasInvalidData() const;
+
+    // Make the debug lazy: the debug chunks will be parsed and
+    // validated by debug_parser on the first getDebug or
+    // getNumInvalidDebug call, on any copy of this instance; the
+    // debug and num_invalid_debug fields are then not set
+    void setDebugParser(DebugParser debug_parser);
+
+    // Return the valid debug chunks and the number of the invalid
+    // ones; parse and validate them first, in case of lazy debug.
+    // Thread-safe.
+    const std::vector<lth_jc::JsonContainer>& getDebug() const;
+    unsigned int getNumInvalidDebug() const;
+
     std::string toString() const;
+
+  private:
+    // The state of the lazy data, shared by the copies of the
+    // instance; null if the data is not lazy
+    struct LazyData;
+    std::shared_ptr<LazyData> lazy_data_;
+
+    const LazyData& getLazyData() const;
+
+    // As above, for the debug chunks
+    struct LazyDebug;
+    std::shared_ptr<LazyDebug> lazy_debug_;
+
+    const LazyDebug& getLazyDebug() const;
+};
+
+//
+// EnvelopeFields
+//
+
+// The envelope entries needed to route a message, retrieved while
+// validating the envelope, before building its DOM; an entry that is
+// missing from the envelope is empty
+struct LIBCPP_PCP_CLIENT_EXPORT EnvelopeFields {
+    std::string id;
+    std::string message_type;
+    std::string sender;
 };
 
 }  // namespace PCPClient
@@ -43,6 +43,8 @@ struct LIBCPP_PCP_CLIENT_EXPORT MessageChunk {
 
     MessageChunk();
 
+    // The content is moved from the argument; pass an rvalue to
+    // avoid copying it
     MessageChunk(uint8_t _descriptor, uint32_t _size, std::string _content);
 
     MessageChunk(uint8_t _descriptor, std::string _content);
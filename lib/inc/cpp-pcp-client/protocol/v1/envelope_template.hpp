@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cpp-pcp-client/export.h>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+#include <vector>
+
+namespace PCPClient {
+namespace v1 {
+
+//
+// EnvelopeTemplate
+//
+
+// The envelope of the messages of a given type, with given targets
+// and sender: the constant entries are rendered once, as JSON text,
+// so that each message only needs its id and expires entries to be
+// patched in. Instances are immutable and can be shared by threads.
+class LIBCPP_PCP_CLIENT_EXPORT EnvelopeTemplate {
+  public:
+    EnvelopeTemplate() = delete;
+
+    EnvelopeTemplate(const std::vector<std::string>& targets,
+                     const std::string& message_type,
+                     const std::string& sender,
+                     bool destination_report = false);
+
+    // Getters
+    const std::string& getMessageType() const;
+    size_t getNumTargets() const;
+
+    // Return the size of the envelope rendered with the given entries
+    size_t getEnvelopeSize(boost::string_ref id,
+                           boost::string_ref expires) const;
+
+    // Render the envelope on the specified buffer, replacing its
+    // content; no memory is allocated if the capacity of the buffer
+    // is at least getEnvelopeSize().
+    // The id and expires entries are inserted verbatim, so they must
+    // not need JSON escaping (as UUIDs and ISO 8601 times).
+    void renderOn(std::string& buffer,
+                  boost::string_ref id,
+                  boost::string_ref expires) const;
+
+    // As renderOn, on a new string allocated with the exact size
+    std::string render(boost::string_ref id,
+                       boost::string_ref expires) const;
+
+  private:
+    std::string message_type_;
+    size_t num_targets_;
+
+    // The constant entries, followed by the closing brace
+    std::string fields_;
+};
+
+}  // namespace v1
+}  // namespace PCPClient
@@ -6,15 +6,28 @@
 #include <cpp-pcp-client/validator/validator.hpp>
 #include <cpp-pcp-client/export.h>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <initializer_list>
 #include <stdint.h>  // uint8_t
 
 namespace PCPClient {
 namespace v1 {
 
+//
+// DebugChunkPolicy
+//
+
+// How getParsedChunks processes the debug chunks:
+//  - Eager: parse each chunk and validate it and each of its hops;
+//  - Lazy: do that on the first access (see ParsedChunks::getDebug);
+//  - Skip: don't process them; only set ParsedChunks::num_skipped_debug.
+enum class DebugChunkPolicy { Eager, Lazy, Skip };
+
 //
 // Message
 //
@@ -26,7 +39,8 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     Message() = delete;
 
     // Construct a Message by parsing the payload delivered
-    // by the transport layer as a std::string.
+    // by the transport layer as a std::string; the chunks are copied
+    // (see MessageView to access them in place).
     // Throw an unsupported_version_error in case the indicated
     // message format version is not supported.
     // Throw a message_serialization_error in case of invalid message.
@@ -35,6 +49,8 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     // Create a new message with a given envelope.
     // Throw a invalid_chunk_error in case of invalid chunk
     // (unknown descriptor or wrong size).
+    // The chunks passed to the ctors and modifiers are moved into the
+    // message; pass rvalues to avoid copying their content.
     explicit Message(MessageChunk envelope);
 
     // ... and a data chunk; throw a invalid_chunk_error as above
@@ -52,22 +68,45 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     void setDataChunk(MessageChunk data_chunk);
     void addDebugChunk(MessageChunk debug_chunk);
 
-    // Getters
+    // Getters; the returned references are valid as long as the
+    // message and its chunks are
     uint8_t getVersion() const;
-    MessageChunk getEnvelopeChunk() const;
-    MessageChunk getDataChunk() const;
-    std::vector<MessageChunk> getDebugChunks() const;
+    const MessageChunk& getEnvelopeChunk() const;
+    const MessageChunk& getDataChunk() const;
+    const std::vector<MessageChunk>& getDebugChunks() const;
+
+    // Move the data chunk out of the message, which is then left
+    // without data
+    MessageChunk releaseDataChunk();
 
     // Inspectors
     bool hasData() const;
     bool hasDebug() const;
 
     // Return the buffer containing the bytes of the serialized
-    // message.
-    // Throw a message_processing_error in case it fails to allocate
-    // memory for the buffer.
+    // message; it's allocated once, with the exact size.
+    // Throw a message_serialization_error in case it fails to
+    // allocate memory for the buffer.
     SerializedMessage getSerialized() const;
 
+    // Return the size of the serialized message [byte].
+    size_t getSerializedSize() const;
+
+    // Return the serialized message as a list of buffers that refer
+    // to the chunks of this instance, without copying them; the
+    // instance must outlive the returned FrameBuffers.
+    FrameBuffers getFrameBuffers() const;
+
+    // Return the protocol version of new messages.
+    static uint8_t getCurrentVersion();
+
+    // Serialize the message on the specified buffer, without
+    // allocating memory, and return the number of bytes written
+    // (i.e. getSerializedSize()).
+    // Throw a message_serialization_error in case buffer_size is
+    // smaller than the serialized message.
+    size_t serializeOn(uint8_t* buffer, size_t buffer_size) const;
+
     // Parse the content of all message chunks, validate, and return
     // them as a ParsedChunks instance. The data chunk will be
     // validated with the schema indicated in the envelope.
@@ -83,6 +122,27 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     // ParsedChunks objects; no error will will be propagated.
     ParsedChunks getParsedChunks(const Validator& validator) const;
 
+    // Validate the envelope while parsing it, without building its
+    // DOM (see Validator::validateText), and return the entries
+    // needed to route the message; that allows dropping bad messages,
+    // and those that have no callback, before any chunk is parsed.
+    // Throw as getParsedChunks does.
+    EnvelopeFields validateEnvelope(const Validator& validator) const;
+
+    // Same as getParsedChunks, for a message whose envelope was
+    // already validated by validateEnvelope; the DOM of the data
+    // chunk is built only if the data is valid.
+    // In case lazy_data is set, the JSON data is parsed and validated
+    // only when first accessed (see the lazy JSON data ctor of
+    // ParsedChunks); validator must then outlive the returned
+    // ParsedChunks instance and its copies; the same applies to the
+    // debug chunks in case of DebugChunkPolicy::Lazy.
+    ParsedChunks getParsedChunks(
+        const Validator& validator,
+        const EnvelopeFields& envelope_fields,
+        bool lazy_data = false,
+        DebugChunkPolicy debug_policy = DebugChunkPolicy::Eager) const;
+
     // Return a string representation of all message fields.
     std::string toString() const;
 
@@ -92,11 +152,90 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     MessageChunk data_chunk_;
     std::vector<MessageChunk> debug_chunks_;
 
-    void parseMessage(const std::string& transport_msg);
-
-    void validateVersion(const uint8_t& version) const;
     void validateChunk(const MessageChunk& chunk) const;
 };
 
+//
+// MessageView
+//
+
+// A chunk of a MessageView; content points into the transport payload
+struct LIBCPP_PCP_CLIENT_EXPORT ChunkView {
+    uint8_t descriptor;
+    boost::string_ref content;
+};
+
+// Read-only access to a message delivered by the transport layer,
+// without copying it: the chunk headers are parsed in place and the
+// contents of the chunks refer to the original payload, which must
+// then outlive the MessageView. Not thread-safe.
+class LIBCPP_PCP_CLIENT_EXPORT MessageView {
+  public:
+    MessageView() = delete;
+
+    // Parse the chunk headers of the payload.
+    // Throw an unsupported_version_error in case the indicated
+    // message format version is not supported.
+    // Throw a message_serialization_error in case of invalid message.
+    explicit MessageView(boost::string_ref transport_payload);
+
+    // As above, for a payload owned by payload_owner; the lazy data
+    // and debug parsers of getParsedChunks then share its ownership
+    // and read the chunks in place, instead of copying them.
+    MessageView(boost::string_ref transport_payload,
+                std::shared_ptr<const void> payload_owner);
+
+    // Getters
+    uint8_t getVersion() const;
+    ChunkView getEnvelopeChunk() const;
+    ChunkView getDataChunk() const;
+    const std::vector<ChunkView>& getDebugChunks() const;
+
+    // Inspectors
+    bool hasData() const;
+    bool hasDebug() const;
+
+    // Return the envelope content; it's parsed only once, by the
+    // first call of this function or of getParsedChunks.
+    // Throw a data_parse_error in case of invalid JSON text.
+    const lth_jc::JsonContainer& getEnvelope() const;
+
+    // As the Message functions with the same signature; the parsed
+    // envelope is reused, instead of parsing its content again, and
+    // the JSON chunks are validated in place.
+    // The parsed data and debug don't refer to the payload, but, in
+    // case of lazy processing, validator must outlive them.
+    // The working memory of the envelope validation can be taken
+    // from an arena (see Validator::validateText).
+    EnvelopeFields validateEnvelope(
+        const Validator& validator,
+        Util::MonotonicBufferResource* arena = nullptr) const;
+
+    ParsedChunks getParsedChunks(const Validator& validator) const;
+
+    ParsedChunks getParsedChunks(
+        const Validator& validator,
+        const EnvelopeFields& envelope_fields,
+        bool lazy_data = false,
+        DebugChunkPolicy debug_policy = DebugChunkPolicy::Eager) const;
+
+    // Return a string representation of all message fields.
+    std::string toString() const;
+
+  private:
+    uint8_t version_;
+    ChunkView envelope_chunk_;
+    ChunkView data_chunk_;
+    std::vector<ChunkView> debug_chunks_;
+
+    // Null until the envelope is parsed
+    mutable std::unique_ptr<lth_jc::JsonContainer> envelope_;
+
+    // Null, unless the payload is shared
+    std::shared_ptr<const void> payload_owner_;
+
+    void parsePayload(boost::string_ref transport_payload);
+};
+
 }  // namespace v1
 }  // namespace PCPClient
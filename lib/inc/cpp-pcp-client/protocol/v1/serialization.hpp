@@ -6,7 +6,10 @@
 #include <leatherman/locale/locale.hpp>
 
 #include <boost/predef/other/endian.h>
+#include <boost/utility/string_ref.hpp>
 
+#include <array>
+#include <cstring>  // memcpy
 #include <string>
 #include <vector>
 #include <stdint.h>  // uint8_t
@@ -44,6 +47,69 @@ inline uint32_t getHostNumber(const uint32_t& number) {
 
 #endif  // BOOST_ENDIAN_LITTLE_BYTE
 
+//
+// Chunk header
+//
+
+// Size of the descriptor and size fields of a chunk [byte]
+constexpr size_t CHUNK_HEADER_SIZE = 5;
+
+// Return the byte of the specified index of a number stored in
+// network byte order (big endian), whatever the host byte order is
+constexpr uint8_t getNetworkByte(uint32_t number, unsigned int idx) {
+    return static_cast<uint8_t>(number >> (8 * (3 - idx)));
+}
+
+// Return the size of a serialized chunk with the given content size
+constexpr size_t getSerializedChunkSize(size_t content_size) {
+    return CHUNK_HEADER_SIZE + content_size;
+}
+
+// Write the header of a chunk (descriptor and content size) on the
+// buffer, which must have room for CHUNK_HEADER_SIZE bytes; return
+// the pointer to the byte past the header
+inline uint8_t* writeChunkHeader(uint8_t descriptor,
+                                 uint32_t content_size,
+                                 uint8_t* buffer) {
+    buffer[0] = descriptor;
+    buffer[1] = getNetworkByte(content_size, 0);
+    buffer[2] = getNetworkByte(content_size, 1);
+    buffer[3] = getNetworkByte(content_size, 2);
+    buffer[4] = getNetworkByte(content_size, 3);
+    return buffer + CHUNK_HEADER_SIZE;
+}
+
+//
+// FrameBuffers
+//
+
+// The serialized form of a message as a list of buffers, so that it
+// can be sent without concatenating its chunks (see the vectored
+// Connection::send): the version byte and the chunk headers are
+// stored by the instance, whereas the content of each chunk refers
+// to the storage of the caller, which must outlive the instance.
+class LIBCPP_PCP_CLIENT_EXPORT FrameBuffers {
+  public:
+    explicit FrameBuffers(uint8_t version);
+
+    // Append a chunk; it's up to the caller to order them as the
+    // protocol requires (envelope, optional data, debug)
+    void addChunk(uint8_t descriptor, boost::string_ref content);
+
+    // Return the buffers, in order: the version byte, then the header
+    // and the content of each chunk
+    std::vector<boost::string_ref> getBuffers() const;
+
+    // Return the size of the serialized message [byte]
+    size_t size() const;
+
+  private:
+    using ChunkHeader = std::array<uint8_t, CHUNK_HEADER_SIZE>;
+
+    uint8_t version_;
+    std::vector<std::pair<ChunkHeader, boost::string_ref>> chunks_;
+};
+
 //
 // Serialize
 //
@@ -57,20 +123,16 @@ inline void serialize_(const T& thing,
 template<>
 inline void serialize_(const std::string& txt,
                        SerializedMessage::iterator& buffer_itr) {
-    for (const auto& c : txt) {
-        auto ptr = reinterpret_cast<const uint8_t*>(&c);
-        std::copy(ptr, ptr + sizeof(c), buffer_itr);
-        buffer_itr += sizeof(c);
-    }
+    if (!txt.empty())
+        std::memcpy(&*buffer_itr, txt.data(), txt.size());
+    buffer_itr += txt.size();
 }
 
 template<>
 inline void serialize_(const uint32_t& number,
                        SerializedMessage::iterator& buffer_itr) {
-    auto network_number = getNetworkNumber(number);
-    auto byte_ptr = reinterpret_cast<const uint8_t*>(&network_number);
-    std::copy(byte_ptr, byte_ptr + 4, buffer_itr);
-    buffer_itr += 4;
+    for (unsigned int idx = 0; idx < 4; idx++)
+        *buffer_itr++ = getNetworkByte(number, idx);
 }
 
 
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cpp-pcp-client/export.h>
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+
+namespace PCPClient {
+namespace v2 {
+
+// Return txt as JSON text, i.e. as a quoted and escaped JSON string;
+// it can be spliced as the data of a message (see renderOn)
+LIBCPP_PCP_CLIENT_EXPORT std::string quoteJsonString(boost::string_ref txt);
+
+//
+// EnvelopeTemplate
+//
+
+// The envelope of the messages of a given type, with given target and
+// sender: the constant entries are rendered once, as JSON text, so
+// that each message only needs its id, in_reply_to and data entries
+// to be patched in. Instances are immutable and can be shared by
+// threads.
+class LIBCPP_PCP_CLIENT_EXPORT EnvelopeTemplate {
+  public:
+    EnvelopeTemplate() = delete;
+
+    EnvelopeTemplate(const std::string& target,
+                     const std::string& message_type,
+                     const std::string& sender);
+
+    // Getters
+    const std::string& getMessageType() const;
+
+    // Return the size of the message rendered with the given entries
+    size_t getMessageSize(boost::string_ref id,
+                          boost::string_ref in_reply_to,
+                          boost::string_ref data_txt) const;
+
+    // Render the message on the specified buffer, replacing its
+    // content; no memory is allocated if the capacity of the buffer
+    // is at least getMessageSize().
+    // The id must not need JSON escaping (as UUIDs); in_reply_to is
+    // escaped and omitted if empty; data_txt must be valid JSON text
+    // and is inserted verbatim.
+    void renderOn(std::string& buffer,
+                  boost::string_ref id,
+                  boost::string_ref in_reply_to,
+                  boost::string_ref data_txt) const;
+
+    // As renderOn, on a new string allocated with the exact size
+    std::string render(boost::string_ref id,
+                       boost::string_ref in_reply_to,
+                       boost::string_ref data_txt) const;
+
+    // As renderOn, with the data written by a rapidjson Writer while
+    // traversing the JsonContainer, straight into the buffer; neither
+    // the data is serialized on its own nor an envelope DOM is built.
+    void renderJsonOn(std::string& buffer,
+                      boost::string_ref id,
+                      boost::string_ref in_reply_to,
+                      const leatherman::json_container::JsonContainer& data) const;
+
+    // As renderJsonOn, on a new string
+    std::string renderJson(boost::string_ref id,
+                           boost::string_ref in_reply_to,
+                           const leatherman::json_container::JsonContainer& data) const;
+
+    // As renderOn, with the data entry set to the base64 encoding of
+    // binary_data, as a JSON string (RFC 4648, with padding); the data is
+    // encoded straight into the buffer
+    void renderBinaryOn(std::string& buffer,
+                        boost::string_ref id,
+                        boost::string_ref in_reply_to,
+                        boost::string_ref binary_data) const;
+
+    // As renderBinaryOn, on a new string allocated with the exact size
+    std::string renderBinary(boost::string_ref id,
+                             boost::string_ref in_reply_to,
+                             boost::string_ref binary_data) const;
+
+  private:
+    std::string message_type_;
+
+    // The constant entries, followed by the key of the data entry
+    std::string fields_;
+
+    // Render the entries that precede the data on buffer
+    void renderHeadOn(std::string& buffer,
+                      boost::string_ref id,
+                      boost::string_ref in_reply_to) const;
+};
+
+}  // namespace v2
+}  // namespace PCPClient
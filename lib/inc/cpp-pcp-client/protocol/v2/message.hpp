@@ -26,6 +26,12 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     // Create a new message with a given envelope.
     explicit Message(lth_jc::JsonContainer envelope);
 
+    // Create a new message with a given envelope, whose data entry is
+    // set to the base64 encoding of binary_data (RFC 4648, with padding);
+    // receivers that registered the schema of the message type as
+    // ContentType::Binary get the binary data back.
+    Message(lth_jc::JsonContainer envelope, boost::string_ref binary_data);
+
     // Construct a Message by parsing the payload delivered
     // by the transport layer as a std::string.
     //
@@ -33,6 +39,12 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     // invalid JSON text.
     explicit Message(const std::string& transport_payload);
 
+    // As above, for a payload encoded with MessagePack (see
+    // msgpack.hpp); it's transcoded to JSON text first.
+    // Throw a data_parse_error in case the payload is not valid
+    // MessagePack or cannot be represented as JSON.
+    static Message fromMessagePack(const std::string& transport_payload);
+
     // Parse the content of all message chunks, validate, and return
     // them as a ParsedChunks instance. The data chunk will be
     // validated with the schema indicated in the envelope.
@@ -46,14 +58,44 @@ class LIBCPP_PCP_CLIENT_EXPORT Message {
     //
     // Note that bad debug/data chunks are reported in the returned
     // ParsedChunks objects; no error will will be propagated.
+    //
+    // In case the schema of the message type is registered as
+    // ContentType::Binary, the data must be a base64 string; it's
+    // decoded into the binary_data field.
     ParsedChunks getParsedChunks(const Validator& validator) const;
 
+    // Validate the envelope of a transport payload while parsing it,
+    // without building its DOM (see Validator::validateText), and
+    // return the entries needed to route the message; that allows
+    // dropping bad messages, and those that have no callback, before
+    // constructing a Message.
+    // The working memory of the validation can be taken from an arena
+    // (see Validator::validateText).
+    // Throw as getParsedChunks does.
+    static EnvelopeFields validateEnvelope(
+        const std::string& transport_payload,
+        const Validator& validator,
+        Util::MonotonicBufferResource* arena = nullptr);
+
+    // Same as getParsedChunks, for a message whose envelope was
+    // already validated by validateEnvelope.
+    // In case lazy_data is set, the data is extracted and validated
+    // only when first accessed (see the lazy JSON data ctor of
+    // ParsedChunks); validator must then outlive the returned
+    // ParsedChunks instance and its copies.
+    ParsedChunks getParsedChunks(const Validator& validator,
+                                 const EnvelopeFields& envelope_fields,
+                                 bool lazy_data = false) const;
+
     // Getter
     lth_jc::JsonContainer const& getEnvelope() const;
 
     // Return a string representation of the message.
     std::string toString() const;
 
+    // Return the MessagePack encoding of the message
+    std::string toMessagePack() const;
+
   private:
     lth_jc::JsonContainer envelope_;
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cpp-pcp-client/export.h>
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+
+/* MessagePack encoding of v2 messages, an opt-in alternative to JSON
+   text that's negotiated with the broker through the WebSocket
+   subprotocol of the connection (see Connector::setMessagePackEncoding).
+
+   Messages are transcoded between the two formats, so that the
+   envelope and data are validated exactly as JSON ones: only the
+   MessagePack types that map to JSON are supported (nil, boolean,
+   integer, float, str, array and map with str keys); bin and ext
+   values are rejected. Integers and strings are encoded with their
+   smallest format; floats always as float 64, to be lossless.
+*/
+
+namespace PCPClient {
+namespace v2 {
+namespace Protocol {
+
+// The WebSocket subprotocol that selects the MessagePack encoding
+static const std::string MESSAGE_PACK_SUBPROTOCOL { "pcp-msgpack" };
+
+}  // namespace Protocol
+
+// Return the MessagePack encoding of the specified JSON text; it's
+// read by the rapidjson SAX reader, without building a DOM.
+// Throw a leatherman::json_container::data_parse_error in case the
+// text is not well-formed JSON.
+LIBCPP_PCP_CLIENT_EXPORT std::string jsonToMessagePack(boost::string_ref json_txt);
+
+// As above, by traversing the specified JsonContainer
+LIBCPP_PCP_CLIENT_EXPORT std::string jsonToMessagePack(
+    const leatherman::json_container::JsonContainer& json);
+
+// Return the JSON text of the specified MessagePack value.
+// Throw a leatherman::json_container::data_parse_error in case the
+// value is truncated, followed by other bytes, nested too deeply or
+// not representable as JSON.
+LIBCPP_PCP_CLIENT_EXPORT std::string messagePackToJson(boost::string_ref msgpack);
+
+}  // namespace v2
+}  // namespace PCPClient
@@ -0,0 +1,102 @@
+#ifndef CPP_PCP_CLIENT_SRC_UTIL_MEMORY_RESOURCE_HPP_
+#define CPP_PCP_CLIENT_SRC_UTIL_MEMORY_RESOURCE_HPP_
+
+#include <cpp-pcp-client/export.h>
+
+#include <cstddef>
+
+/* Polymorphic memory resources, modelled after C++17's std::pmr ones,
+   which aren't available in C++11. They allow the connectors to take
+   the working memory of the validation of the envelopes of incoming
+   messages from an arena, rather than from the global heap (see
+   ConnectorBase::setMemoryResource). The chunks, envelopes and data
+   of the messages are std::string and JsonContainer instances, which
+   keep using the global heap.
+*/
+
+namespace PCPClient {
+namespace Util {
+
+static constexpr std::size_t MAX_ALIGNMENT { alignof(long double) };
+
+//
+// MemoryResource
+//
+
+class LIBCPP_PCP_CLIENT_EXPORT MemoryResource {
+  public:
+    virtual ~MemoryResource() = default;
+
+    // Throw a std::bad_alloc in case it fails to allocate memory
+    void* allocate(std::size_t bytes, std::size_t alignment = MAX_ALIGNMENT);
+
+    void deallocate(void* ptr, std::size_t bytes,
+                    std::size_t alignment = MAX_ALIGNMENT);
+
+  private:
+    virtual void* doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void doDeallocate(void* ptr, std::size_t bytes,
+                              std::size_t alignment) = 0;
+};
+
+// Return the resource that uses the global operator new and delete
+LIBCPP_PCP_CLIENT_EXPORT MemoryResource* getNewDeleteResource();
+
+//
+// MonotonicBufferResource
+//
+
+// Allocates memory by bumping a pointer into buffers obtained from the
+// upstream resource, with geometric growth; deallocate() is a no-op,
+// memory is only reclaimed at once by rewind(), release() or the dtor.
+// Meant for data whose lifetime ends at a known point, such as the
+// processing of a message. Not thread-safe.
+class LIBCPP_PCP_CLIENT_EXPORT MonotonicBufferResource : public MemoryResource {
+  public:
+    // The first buffer has initial_size bytes, the next ones grow
+    // geometrically; rewind() keeps no buffer larger than
+    // max_retained_size bytes
+    explicit MonotonicBufferResource(std::size_t initial_size = 4096,
+                                     MemoryResource* upstream = getNewDeleteResource(),
+                                     std::size_t max_retained_size = 1024 * 1024);
+
+    MonotonicBufferResource(const MonotonicBufferResource&) = delete;
+    MonotonicBufferResource& operator=(const MonotonicBufferResource&) = delete;
+
+    ~MonotonicBufferResource();
+
+    // Make all the memory available again; only the largest buffer
+    // that isn't larger than max_retained_size is kept, the others
+    // are returned to the upstream resource, so that the next cycle
+    // of allocations of similar size doesn't need any upstream
+    // allocation, whereas a single large cycle doesn't pin its memory.
+    // The growth of the buffers restarts from the kept one.
+    void rewind();
+
+    // Return all buffers to the upstream resource
+    void release();
+
+  private:
+    struct Buffer;
+
+    MemoryResource* upstream_;
+    std::size_t initial_size_;
+    std::size_t max_retained_size_;
+    std::size_t next_size_;
+
+    // The most recent buffer; it points to the previous
+    Buffer* buffers_;
+    char* current_;
+    char* end_;
+
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override;
+    void doDeallocate(void* ptr, std::size_t bytes,
+                      std::size_t alignment) override;
+
+    void addBuffer(std::size_t min_size);
+};
+
+}  // namespace Util
+}  // namespace PCPClient
+
+#endif  // CPP_PCP_CLIENT_SRC_UTIL_MEMORY_RESOURCE_HPP_
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cpp-pcp-client/util/thread.hpp>
+#include <cpp-pcp-client/export.h>
+
+#include <atomic>
+#include <ctime>
+#include <string>
+#include <stdint.h>
+
+namespace PCPClient {
+namespace Util {
+
+//
+// MessageIdGenerator
+//
+
+// Generates the IDs of outbound messages as random (version 4) UUIDs,
+// without allocating memory; the random bits come from a SplitMix64
+// sequence whose state is advanced atomically, so that a generator
+// can be shared by threads without locking.
+// NB: the IDs are unique, not unpredictable; don't use them as tokens.
+class LIBCPP_PCP_CLIENT_EXPORT MessageIdGenerator {
+  public:
+    // Length of the IDs, in the 8-4-4-4-12 hex format of UUIDs
+    static constexpr size_t ID_SIZE { 36 };
+
+    // Seed the sequence with std::random_device and the current time
+    MessageIdGenerator();
+
+    explicit MessageIdGenerator(uint64_t seed);
+
+    // Write a new ID on the specified buffer, that must have room for
+    // ID_SIZE chars; no string terminator is written.
+    void generateOn(char* buffer);
+
+    // As generateOn, on a new string
+    std::string generate();
+
+  private:
+    std::atomic<uint64_t> state_;
+
+    uint64_t next();
+};
+
+//
+// ExpiryFormatter
+//
+
+// Formats the expiry times of outbound messages, in UTC and ISO 8601
+// format with second precision; the last formatted time is cached, so
+// that the text is rendered again only when the second changes.
+// Thread-safe.
+class LIBCPP_PCP_CLIENT_EXPORT ExpiryFormatter {
+  public:
+    // Length of the formatted times, as in "2016-02-18T13:34:58Z"
+    static constexpr size_t EXPIRY_SIZE { 20 };
+
+    ExpiryFormatter();
+
+    // Write on the specified buffer, that must have room for
+    // EXPIRY_SIZE chars, the time timeout seconds from now; no string
+    // terminator is written.
+    void formatOn(unsigned int timeout, char* buffer);
+
+    // As formatOn, on a new string
+    std::string format(unsigned int timeout);
+
+    // Write the specified time on buffer, as above, without caching it
+    static void formatTimeOn(std::time_t time, char* buffer);
+
+  private:
+    Util::mutex mtx_;
+    std::time_t cached_time_;
+    char cached_txt_[EXPIRY_SIZE];
+};
+
+}  // namespace Util
+}  // namespace PCPClient
@@ -6,6 +6,7 @@
 #pragma GCC diagnostic ignored "-Wunused-variable"
 #include <boost/thread/thread.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 #include <boost/exception_ptr.hpp>
 #include <boost/throw_exception.hpp>
 #pragma GCC diagnostic pop
@@ -24,6 +25,7 @@ namespace Util {
 
 using thread = boost::thread;
 using mutex = boost::mutex;
+using recursive_mutex = boost::recursive_mutex;
 using condition_variable = boost::condition_variable;
 const boost::defer_lock_t defer_lock {};
 
@@ -7,6 +7,7 @@
 #include <map>
 #include <string>
 #include <set>
+#include <vector>
 
 
 // boost forward declarations used in valijson forward declarations
@@ -39,6 +40,18 @@ namespace lth_jc = leatherman::json_container;
 enum class TypeConstraint { Object, Array, String, Int, Bool, Double, Null, Any };
 enum class ContentType { Json, Binary };
 
+// A function that checks data directly, without interpreting a JSON
+// schema; returns true if the data is valid
+using NativeValidator = bool (*)(const lth_jc::JsonContainer& data);
+
+// The type constraint of a top-level property, as added by
+// Schema::addConstraint(field, type, required)
+struct PropertyType {
+    std::string name;
+    TypeConstraint type;
+    bool required;
+};
+
 class LIBCPP_PCP_CLIENT_EXPORT schema_error : public std::runtime_error  {
   public:
     explicit schema_error(std::string const& msg)
@@ -81,10 +94,32 @@ class LIBCPP_PCP_CLIENT_EXPORT Schema {
     void addConstraint(std::string field, TypeConstraint type, bool required = false);
     void addConstraint(std::string field, Schema sub_schema, bool required = false);
 
+    // Set a native validator that accepts exactly the data that
+    // matches the schema's constraints; the Validator will run it in
+    // place of the valijson one. Adding a constraint afterwards
+    // removes the native validator, as it would no longer be
+    // equivalent. Pass nullptr to remove it.
+    void setNativeValidator(NativeValidator native_validator);
+
     const std::string getName() const;
     ContentType getContentType() const;
+    TypeConstraint getType() const;
     const valijson::Schema getRaw() const;
 
+    // Return nullptr if no native validator was set
+    NativeValidator getNativeValidator() const;
+
+    // Return true if the schema only constrains the type of the data
+    // and the types of its top-level properties, so that the data can
+    // be validated while being parsed (see Validator::validateText);
+    // that's not the case for parsed JSON schemas and for schemas
+    // with sub-schema constraints
+    bool isStreamable() const;
+
+    // The type constraints of the top-level properties, in the order
+    // they were added
+    const std::vector<PropertyType>& getPropertyTypes() const;
+
   private:
     std::string name_;
 
@@ -105,6 +140,14 @@ class LIBCPP_PCP_CLIENT_EXPORT Schema {
     std::unique_ptr<V_C::PropertySchemaMap> pattern_properties_;
     std::unique_ptr<V_C::RequiredProperties> required_properties_;
 
+    // Equivalent to the above constraints, if set
+    NativeValidator native_validator_;
+
+    // The type constraints of the properties, as added; flag set in
+    // case a sub-schema constraint was added
+    std::vector<PropertyType> property_types_;
+    bool has_sub_schemas_;
+
     // Convert PCPClient::TypeConstraint to the validjson ones
     V_C::TypeConstraint getConstraint(TypeConstraint type) const;
 
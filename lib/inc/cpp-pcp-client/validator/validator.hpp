@@ -2,10 +2,18 @@
 #define CPP_PCP_CLIENT_SRC_VALIDATOR_VALIDATOR_H_
 
 #include <cpp-pcp-client/validator/schema.hpp>
+#include <cpp-pcp-client/util/memory_resource.hpp>
 #include <cpp-pcp-client/util/thread.hpp>
 #include <cpp-pcp-client/export.h>
 
-#include <map>
+#include <boost/utility/string_ref.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace PCPClient {
 
@@ -44,29 +52,158 @@ class LIBCPP_PCP_CLIENT_EXPORT validation_error : public validator_error {
 
 namespace lth_jc = leatherman::json_container;
 
+// A top-level property of JSON data whose string value is retrieved
+// by Validator::validateText
+struct PropertyCapture {
+    boost::string_ref name;
+    std::string value;
+};
+
+// An item of a batch validated by Validator::validateBatch: the data
+// and the name of the schema it must match
+using ValidationItem = std::pair<lth_jc::JsonContainer, std::string>;
+
+enum class ValidationStatus { Valid, Invalid, SchemaNotFound, Error };
+
+// The outcome of the validation of a batch item; error describes why
+// the item is not Valid
+struct ValidationResult {
+    ValidationStatus status;
+    std::string error;
+};
+
 class LIBCPP_PCP_CLIENT_EXPORT Validator {
   public:
     Validator();
 
-    // NB: Validator is thread-safe; it employs a mutex for that. As a
-    //     consequence, Validator instances are not copyable.
+    // NB: Validator is thread-safe; registerSchema employs a mutex
+    //     for that, whereas lookups read the registered schemas
+    //     without locking. As a consequence, Validator instances are
+    //     not copyable; the moved one is left without schemas.
     Validator(Validator&& other_validator);
 
+    ~Validator();
+
+    // Compile the schema into its valijson representation and add it
+    // to the registry; the compiled schema is immutable and it will
+    // be shared by all the subsequent validate() calls. In case the
+    // schema has a native validator, validate() will run that instead;
+    // the valijson one is then only used to describe validation
+    // failures in the log.
+    // Throw a schema_redefinition_error in case a schema with the
+    // same name was already registered.
     void registerSchema(const Schema& schema);
 
+    // Register a validator generated from a JSON schema (see the
+    // pcp_compile_schemas CMake function) with the specified name;
+    // validate() will run it without interpreting any schema.
+    // Throw a schema_redefinition_error in case a schema with the
+    // same name was already registered, or a validator_error in case
+    // compiled_validator is null.
+    void registerCompiledSchema(std::string schema_name,
+                                NativeValidator compiled_validator,
+                                ContentType content_type = ContentType::Json);
+
     // Validates data with the specified schema.
     // Throw a schema_not_found error in case the specified schema
     // was not registered.
     // Throw a validation_error in case the data does not match the
     // specified schema.
-    void validate(const lth_jc::JsonContainer& data, std::string schema_name) const;
+    // Lookups don't lock nor allocate memory.
+    void validate(const lth_jc::JsonContainer& data,
+                  boost::string_ref schema_name) const;
+
+    // Validate JSON text with the specified schema while parsing it
+    // with the rapidjson SAX reader, without building a DOM; parsing
+    // stops at the first violation. The text of schemas that are not
+    // streamable (see Schema::isStreamable) or that were registered
+    // by registerCompiledSchema is parsed into a JsonContainer and
+    // checked as validate() does.
+    // The value of each captured property is set, in case the data
+    // has such property with a string value; in case of duplicate
+    // keys, the first one is captured, as JsonContainer::get does.
+    // Throw a schema_not_found error as validate() does.
+    // json_txt doesn't need to be null-terminated, so it can point
+    // into a larger buffer, e.g. a chunk of a transport payload.
+    // Throw a data_parse_error in case json_txt is not valid JSON.
+    // Throw a validation_error in case the data does not match the
+    // specified schema.
+    // In case an arena is specified, the working memory of the SAX
+    // reader is allocated from it, rather than from the heap; it's
+    // reclaimed when the arena is rewound or released. Otherwise it's
+    // a single block, taken from the heap and freed before returning.
+    void validateText(boost::string_ref json_txt,
+                      boost::string_ref schema_name,
+                      std::vector<PropertyCapture>* captures = nullptr,
+                      Util::MonotonicBufferResource* arena = nullptr) const;
+
+    // Validate JSON text as validateText does and, only if it's
+    // valid, parse it into a JsonContainer.
+    // Throw as validateText does.
+    lth_jc::JsonContainer parseText(boost::string_ref json_txt,
+                                    boost::string_ref schema_name) const;
+
+    // Validate num_items items, starting at items, with num_workers
+    // threads (one per hardware thread, in case of 0), including the
+    // calling one; each worker validates a contiguous run of items at
+    // a time. All the items are checked against the schemas that
+    // were registered when the call started, and the result of each
+    // one is stored at the same index of the returned vector.
+    // Don't throw for any item: schema_not_found_error and
+    // validation_error are reported as SchemaNotFound and Invalid,
+    // other exceptions as Error. In case a worker thread can't be
+    // started, the remaining workers validate its share.
+    std::vector<ValidationResult> validateBatch(const ValidationItem* items,
+                                                std::size_t num_items,
+                                                unsigned int num_workers = 0) const;
+
+    // As above, for all the items of the vector
+    std::vector<ValidationResult> validateBatch(const std::vector<ValidationItem>& items,
+                                                unsigned int num_workers = 0) const;
+
+    bool includesSchema(boost::string_ref schema_name) const;
 
-    bool includesSchema(std::string schema_name) const;
-    ContentType getSchemaContentType(std::string schema_name) const;
+    // Throw a schema_not_found error in case the specified schema
+    // was not registered.
+    ContentType getSchemaContentType(boost::string_ref schema_name) const;
 
   private:
-    std::map<std::string, Schema> schema_map_;
-    mutable Util::mutex lookup_mutex_;
+    // The rules of a streamable schema, checked by the handler of
+    // the SAX events of validateText; defined in validator.cc
+    struct StreamingSchema;
+
+    // A registered schema, compiled once by registerSchema; it's
+    // never modified afterwards, so validate() can use it from
+    // multiple threads without copying it. raw_schema is null for
+    // the schemas registered by registerCompiledSchema, whereas
+    // streaming_schema is null for those that are not streamable.
+    struct CompiledSchema {
+        ContentType content_type;
+        std::shared_ptr<const valijson::Schema> raw_schema;
+        NativeValidator native_validator;
+        std::shared_ptr<const StreamingSchema> streaming_schema;
+    };
+
+    // Append-only hash table of the compiled schemas, keyed by name;
+    // defined in validator.cc. Registration inserts in place, under
+    // registration_mutex_, whereas lookups read it without locking.
+    // Entries are never removed, so they live as long as the
+    // Validator does
+    struct Registry;
+
+    std::unique_ptr<Registry> registry_;
+    Util::mutex registration_mutex_;
+
+    const CompiledSchema& getCompiledSchema(boost::string_ref schema_name) const;
+    void validateData(const lth_jc::JsonContainer& data,
+                      boost::string_ref schema_name,
+                      const CompiledSchema& compiled_schema) const;
+    void validateStream(boost::string_ref json_txt,
+                        boost::string_ref schema_name,
+                        const StreamingSchema& streaming_schema,
+                        std::vector<PropertyCapture>* captures,
+                        Util::MonotonicBufferResource* arena) const;
+    void addSchema(std::string schema_name, CompiledSchema compiled_schema);
 };
 
 }  // namespace PCPClient
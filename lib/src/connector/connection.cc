@@ -9,6 +9,7 @@
 
 #include <cpp-pcp-client/connector/connection.hpp>
 #include <cpp-pcp-client/connector/errors.hpp>
+#include <cpp-pcp-client/connector/io_reactor.hpp>
 #include <cpp-pcp-client/protocol/v1/message.hpp>
 #include <cpp-pcp-client/util/thread.hpp>
 #include <cpp-pcp-client/util/chrono.hpp>
@@ -31,6 +32,7 @@
 
 #include <leatherman/logging/logging.hpp>
 
+#include <leatherman/util/scope_exit.hpp>
 #include <leatherman/util/timer.hpp>
 
 #include <leatherman/locale/locale.hpp>
@@ -68,6 +70,28 @@ static const uint32_t CONNECTION_BACKOFF_MULTIPLIER { 2 };
 // Connection
 //
 
+// Return a handler that executes the specified method of the target's
+// Connection, unless cleanUp has detached it from the target; a
+// detached handler returns a value-initialized Result
+template <typename Target, typename Result, typename... Args>
+static std::function<Result(Args...)> bindHandler(
+        std::shared_ptr<Target> target,
+        Result (Connection::*method)(Args...))
+{
+    return [target, method](Args... args) -> Result {
+        Util::lock_guard<Util::recursive_mutex> the_lock { target->mtx };
+
+        if (target->connection == nullptr)
+            return Result();
+
+        auto was_in_handler = target->in_handler;
+        target->in_handler = true;
+        lth_util::scope_exit handler_exiter {
+            [&target, was_in_handler]() { target->in_handler = was_in_handler; } };
+        return (target->connection->*method)(std::move(args)...);
+    };
+}
+
 Connection::Connection(std::string broker_ws_uri,
                        ClientMetadata client_metadata)
         : Connection { std::vector<std::string> { std::move(broker_ws_uri) },
@@ -77,55 +101,85 @@ Connection::Connection(std::string broker_ws_uri,
 
 Connection::Connection(std::vector<std::string> broker_ws_uris,
                        ClientMetadata client_metadata)
+        : Connection { std::move(broker_ws_uris),
+                       std::move(client_metadata),
+                       nullptr }
+{
+}
+
+Connection::Connection(std::string broker_ws_uri,
+                       ClientMetadata client_metadata,
+                       std::shared_ptr<IoReactor> io_reactor)
+        : Connection { std::vector<std::string> { std::move(broker_ws_uri) },
+                       std::move(client_metadata),
+                       std::move(io_reactor) }
+{
+}
+
+Connection::Connection(std::vector<std::string> broker_ws_uris,
+                       ClientMetadata client_metadata,
+                       std::shared_ptr<IoReactor> io_reactor)
         : timings {},
           broker_ws_uris_ { std::move(broker_ws_uris) },
           client_metadata_ { std::move(client_metadata) },
           connection_state_ { ConnectionState::initialized },
           connection_target_index_ { 0u },
           consecutive_pong_timeouts_ { 0 },
+          io_reactor_ { std::move(io_reactor) },
+          handler_target_ { new HandlerTarget() },
           endpoint_ { new WS_Client_Type() }
 {
+    handler_target_->connection = this;
+    handler_target_->in_handler = false;
+
     // Disable websocket logging until PE-33165 is resolved.
     setWebSocketLogLevel(leatherman::logging::log_level::none);
     setWebSocketLogStream(nullptr);
 
     // Initialize the transport system. Note that in perpetual mode,
-    // the event loop does not terminate when there are no connections
-    endpoint_->init_asio();
-    endpoint_->start_perpetual();
+    // the event loop does not terminate when there are no connections;
+    // a shared event loop is kept running by its reactor. In both
+    // cases, the handlers of each WebSocket connection are serialized
+    // by its strand, as the endpoint is configured for multithreading
+    if (io_reactor_ != nullptr) {
+        endpoint_->init_asio(&io_reactor_->getIoService());
+    } else {
+        endpoint_->init_asio();
+        endpoint_->start_perpetual();
+    }
 
     try {
         // Handlers
+        // Handlers; they're executed through handler_target_, as they
+        // may still be pending on a shared event loop when this
+        // instance is destroyed
         endpoint_->set_tls_init_handler(
-            std::bind(&Connection::onTlsInit, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onTlsInit));
         endpoint_->set_open_handler(
-            std::bind(&Connection::onOpen, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onOpen));
         endpoint_->set_close_handler(
-            std::bind(&Connection::onClose, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onClose));
         endpoint_->set_fail_handler(
-            std::bind(&Connection::onFail, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onFail));
         endpoint_->set_message_handler(
-            std::bind(&Connection::onMessage, this,
-                      std::placeholders::_1, std::placeholders::_2));
+            bindHandler(handler_target_, &Connection::onMessage));
         endpoint_->set_ping_handler(
-            std::bind(&Connection::onPing, this,
-                      std::placeholders::_1, std::placeholders::_2));
+            bindHandler(handler_target_, &Connection::onPing));
         endpoint_->set_pong_handler(
-            std::bind(&Connection::onPong, this,
-                      std::placeholders::_1, std::placeholders::_2));
+            bindHandler(handler_target_, &Connection::onPong));
         endpoint_->set_pong_timeout_handler(
-            std::bind(&Connection::onPongTimeout, this,
-                      std::placeholders::_1, std::placeholders::_2));
+            bindHandler(handler_target_, &Connection::onPongTimeout));
         endpoint_->set_tcp_pre_init_handler(
-            std::bind(&Connection::onPreTCPInit, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onPreTCPInit));
         endpoint_->set_tcp_post_init_handler(
-            std::bind(&Connection::onPostTCPInit, this, std::placeholders::_1));
+            bindHandler(handler_target_, &Connection::onPostTCPInit));
 
         // Pong timeout
         endpoint_->set_pong_timeout(client_metadata_.pong_timeout_ms);
 
-        // Start the event loop thread
-        endpoint_thread_.reset(new Util::thread(&WS_Client_Type::run, endpoint_.get()));
+        // Start the event loop thread, unless the event loop is shared
+        if (io_reactor_ == nullptr)
+            endpoint_thread_.reset(new Util::thread(&WS_Client_Type::run, endpoint_.get()));
     } catch (...) {
         LOG_DEBUG("Failed to configure the WebSocket endpoint; about to stop "
                   "the event loop");
@@ -210,7 +264,7 @@ void Connection::setOnOpenCallback(std::function<void()> c_b)
     onOpen_callback_ = c_b;
 }
 
-void Connection::setOnMessageCallback(std::function<void(const std::string& msg)> c_b)
+void Connection::setOnMessageCallback(std::function<void(std::string msg)> c_b)
 {
     onMessage_callback_ = c_b;
 }
@@ -349,6 +403,34 @@ void Connection::send(void* const serialized_msg_ptr, size_t msg_len)
             lth_loc::format("failed to send message: {1}", ec.message()) };
 }
 
+void Connection::send(const std::vector<boost::string_ref>& buffers)
+{
+    size_t msg_len { 0 };
+    for (const auto& buffer : buffers)
+        msg_len += buffer.size();
+
+    websocketpp::lib::error_code ec;
+    auto ws_connection = endpoint_->get_con_from_hdl(connection_handle_, ec);
+
+    if (!ec) {
+        // The message manager reserves msg_len bytes for the payload;
+        // the buffers are appended, so that it's not zero-filled first
+        auto ws_msg = ws_connection->get_message(websocketpp::frame::opcode::binary,
+                                                 msg_len);
+        auto& payload = ws_msg->get_raw_payload();
+        payload.reserve(msg_len);
+
+        for (const auto& buffer : buffers)
+            payload.append(buffer.data(), buffer.size());
+
+        ec = ws_connection->send(ws_msg);
+    }
+
+    if (ec)
+        throw connection_processing_error {
+            lth_loc::format("failed to send message: {1}", ec.message()) };
+}
+
 void Connection::ping(const std::string& binary_payload)
 {
     websocketpp::lib::error_code ec;
@@ -443,6 +525,33 @@ void Connection::cleanUp()
         }
     }
 
+    if (io_reactor_ != nullptr) {
+        // The event loop is shared, so it can't be joined; wait for
+        // the handler executed by another thread, if any, and detach
+        // the pending ones from this instance
+        {
+            Util::lock_guard<Util::recursive_mutex> the_lock { handler_target_->mtx };
+
+            if (handler_target_->in_handler)
+                LOG_ERROR("The Connection is being destroyed by one of its "
+                          "own WebSocket handlers");
+
+            handler_target_->connection = nullptr;
+        }
+
+        // The pending handlers of a WebSocket connection may refer to
+        // the endpoint, so it's released by the reactor once all the
+        // connections have been released
+        if (!std::all_of(connection_handles_.begin(),
+                         connection_handles_.end(),
+                         [](const WS_Connection_Handle& hdl) { return hdl.expired(); }))
+            io_reactor_->releaseWhenExpired(
+                std::shared_ptr<void>(std::move(endpoint_)),
+                std::vector<std::weak_ptr<void>>(connection_handles_.begin(),
+                                                 connection_handles_.end()));
+        return;
+    }
+
     endpoint_->stop_perpetual();
 
     if (endpoint_thread_ != nullptr && endpoint_thread_->joinable())
@@ -463,6 +572,31 @@ void Connection::connect_()
                             "with {1}: {2}", ws_uri, ec.message()) };
 
     connection_handle_ = connection_ptr->get_handle();
+
+    if (io_reactor_ != nullptr) {
+        connection_handles_.erase(
+            std::remove_if(connection_handles_.begin(),
+                           connection_handles_.end(),
+                           [](const WS_Connection_Handle& hdl) {
+                               return hdl.expired();
+                           }),
+            connection_handles_.end());
+        connection_handles_.push_back(connection_handle_);
+    }
+
+    for (const auto& subprotocol : client_metadata_.ws_subprotocols) {
+        connection_ptr->add_subprotocol(subprotocol, ec);
+        if (ec)
+            throw connection_processing_error {
+                lth_loc::format("failed to request the WebSocket subprotocol "
+                                "{1}: {2}", subprotocol, ec.message()) };
+    }
+
+    {
+        Util::lock_guard<Util::mutex> the_lock { subprotocol_mutex_ };
+        subprotocol_.clear();
+    }
+
     if (client_metadata_.proxy.length() > 0) {
         connection_ptr->set_proxy(client_metadata_.proxy);
         LOG_INFO("Establishing the WebSocket connection with '{1}'"
@@ -483,6 +617,12 @@ void Connection::connect_()
     }
 }
 
+std::string Connection::getSubprotocol() const
+{
+    Util::lock_guard<Util::mutex> the_lock { subprotocol_mutex_ };
+    return subprotocol_;
+}
+
 std::string const& Connection::getWsUri()
 {
     auto c_t = connection_target_index_.load();
@@ -692,6 +832,31 @@ void Connection::onOpen(WS_Connection_Handle hdl) {
     LOG_INFO("Successfully established a WebSocket connection with the PCP "
              "broker at {1}", getWsUri());
 
+    if (!client_metadata_.ws_subprotocols.empty()) {
+        websocketpp::lib::error_code ec;
+        auto ws_connection = endpoint_->get_con_from_hdl(hdl, ec);
+
+        if (!ec) {
+            // NB: the client endpoint doesn't set its subprotocol from
+            // the handshake response, so get_subprotocol() can't be used
+            const auto& selected =
+                ws_connection->get_response_header("Sec-WebSocket-Protocol");
+            const auto& requested = client_metadata_.ws_subprotocols;
+            Util::lock_guard<Util::mutex> the_lock { subprotocol_mutex_ };
+
+            if (std::find(requested.begin(), requested.end(), selected)
+                    != requested.end()) {
+                subprotocol_ = selected;
+                LOG_DEBUG("WebSocket subprotocol selected by the broker: '{1}'",
+                          subprotocol_);
+            } else if (!selected.empty()) {
+                LOG_WARNING("The broker selected the WebSocket subprotocol "
+                            "'{1}', which was not requested; ignoring it",
+                            selected);
+            }
+        }
+    }
+
     {
         Util::lock_guard<Util::mutex> { onOpen_mtx };
         connection_state_ = ConnectionState::open;
@@ -721,7 +886,7 @@ void Connection::onMessage(WS_Connection_Handle hdl,
         try {
             // NB: on_message_callback_ should not raise; in case of
             // failure; it must be able to notify back the error...
-            onMessage_callback_(msg->get_payload());
+            onMessage_callback_(std::move(msg->get_raw_payload()));
         } catch (std::exception&  e) {
             LOG_ERROR("onMessage WebSocket callback failure: {1}", e.what());
         } catch (...) {
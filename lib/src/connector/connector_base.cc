@@ -32,9 +32,14 @@ ConnectorBase::ConnectorBase(std::vector<std::string> broker_ws_uris,
                              std::move(ws_connection_timeout_ms),
                              std::move(pong_timeouts_before_retry),
                              std::move(ws_pong_timeout_ms) },
+          io_reactor_ {},
           validator_ {},
           schema_callback_pairs_ {},
           error_callback_ {},
+          lazy_data_parsing_ { false },
+          id_generator_ {},
+          expiry_formatter_ {},
+          message_arena_ { new Util::MonotonicBufferResource {} },
           is_monitoring_ { false },
           monitor_thread_ {},
           monitor_mutex_ {},
@@ -62,9 +67,14 @@ ConnectorBase::ConnectorBase(std::vector<std::string> broker_ws_uris,
                              std::move(ws_connection_timeout_ms),
                              std::move(pong_timeouts_before_retry),
                              std::move(ws_pong_timeout_ms) },
+          io_reactor_ {},
           validator_ {},
           schema_callback_pairs_ {},
           error_callback_ {},
+          lazy_data_parsing_ { false },
+          id_generator_ {},
+          expiry_formatter_ {},
+          message_arena_ { new Util::MonotonicBufferResource {} },
           is_monitoring_ { false },
           monitor_thread_ {},
           monitor_mutex_ {},
@@ -94,9 +104,14 @@ ConnectorBase::ConnectorBase(std::vector<std::string> broker_ws_uris,
                              std::move(ws_connection_timeout_ms),
                              std::move(pong_timeouts_before_retry),
                              std::move(ws_pong_timeout_ms) },
+          io_reactor_ {},
           validator_ {},
           schema_callback_pairs_ {},
           error_callback_ {},
+          lazy_data_parsing_ { false },
+          id_generator_ {},
+          expiry_formatter_ {},
+          message_arena_ { new Util::MonotonicBufferResource {} },
           is_monitoring_ { false },
           monitor_thread_ {},
           monitor_mutex_ {},
@@ -130,9 +145,56 @@ ConnectorBase::ConnectorBase(std::vector<std::string> broker_ws_uris,
                              std::move(ws_connection_timeout_ms),
                              std::move(pong_timeouts_before_retry),
                              std::move(ws_pong_timeout_ms) },
+          io_reactor_ {},
           validator_ {},
           schema_callback_pairs_ {},
           error_callback_ {},
+          lazy_data_parsing_ { false },
+          id_generator_ {},
+          expiry_formatter_ {},
+          message_arena_ { new Util::MonotonicBufferResource {} },
+          is_monitoring_ { false },
+          monitor_thread_ {},
+          monitor_mutex_ {},
+          monitor_cond_var_ {},
+          must_stop_monitoring_ { false }
+{ }
+
+// constructor for io reactor addition
+ConnectorBase::ConnectorBase(std::vector<std::string> broker_ws_uris,
+                             std::string client_type,
+                             std::string ca_crt_path,
+                             std::string client_crt_path,
+                             std::string client_key_path,
+                             std::string client_crl_path,
+                             std::string ws_proxy,
+                             lth_log::log_level loglevel,
+                             std::ostream* logstream,
+                             std::shared_ptr<IoReactor> io_reactor,
+                             long ws_connection_timeout_ms,
+                             uint32_t pong_timeouts_before_retry,
+                             long ws_pong_timeout_ms)
+        : connection_ptr_ { nullptr },
+          broker_ws_uris_ { std::move(broker_ws_uris) },
+          client_metadata_ { std::move(client_type),
+                             std::move(ca_crt_path),
+                             std::move(client_crt_path),
+                             std::move(client_key_path),
+                             std::move(client_crl_path),
+                             std::move(ws_proxy),
+                             std::move(loglevel),
+                             logstream,
+                             std::move(ws_connection_timeout_ms),
+                             std::move(pong_timeouts_before_retry),
+                             std::move(ws_pong_timeout_ms) },
+          io_reactor_ { std::move(io_reactor) },
+          validator_ {},
+          schema_callback_pairs_ {},
+          error_callback_ {},
+          lazy_data_parsing_ { false },
+          id_generator_ {},
+          expiry_formatter_ {},
+          message_arena_ { new Util::MonotonicBufferResource {} },
           is_monitoring_ { false },
           monitor_thread_ {},
           monitor_mutex_ {},
@@ -177,13 +239,23 @@ void ConnectorBase::setPCPErrorCallback(MessageCallback callback)
     error_callback_ = callback;
 }
 
+void ConnectorBase::setLazyDataParsing(bool lazy_data_parsing)
+{
+    lazy_data_parsing_ = lazy_data_parsing;
+}
+
+void ConnectorBase::setMemoryResource(Util::MemoryResource* resource)
+{
+    message_arena_.reset(new Util::MonotonicBufferResource { 4096, resource });
+}
+
 // Manage the connection state
 
 void ConnectorBase::connect(int max_connect_attempts)
 {
     if (connection_ptr_ == nullptr) {
         // Initialize the WebSocket connection
-        connection_ptr_.reset(new Connection(broker_ws_uris_, client_metadata_));
+        connection_ptr_.reset(new Connection(broker_ws_uris_, client_metadata_, io_reactor_));
 
         // Set WebSocket callbacks
         connection_ptr_->setOnMessageCallback(
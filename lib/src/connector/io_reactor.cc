@@ -0,0 +1,127 @@
+#include <cpp-pcp-client/connector/io_reactor.hpp>
+#include <cpp-pcp-client/connector/errors.hpp>
+
+#define LEATHERMAN_LOGGING_NAMESPACE CPP_PCP_CLIENT_LOGGING_PREFIX".io_reactor"
+
+#include <leatherman/logging/logging.hpp>
+
+#include <leatherman/locale/locale.hpp>
+
+#include <boost/asio/deadline_timer.hpp>
+
+#include <algorithm>
+
+namespace PCPClient {
+
+namespace lth_loc  = leatherman::locale;
+
+// Interval between the checks of releaseWhenExpired
+static const long RELEASE_CHECK_INTERVAL_MS { 100 };
+
+IoReactor::IoReactor(unsigned int num_threads)
+        : io_service_ { new boost::asio::io_service() },
+          work_ { new boost::asio::io_service::work(*io_service_) },
+          threads_ {}
+{
+    if (num_threads == 0)
+        throw connection_config_error {
+            lth_loc::translate("the I/O reactor needs at least one thread") };
+
+    try {
+        for (unsigned int idx = 0; idx < num_threads; idx++)
+            threads_.emplace_back(new Util::thread(&IoReactor::runEventLoop, io_service_));
+    } catch (const std::exception& e) {
+        LOG_DEBUG("Failed to start the I/O reactor threads: {1}", e.what());
+        stop();
+        throw connection_config_error {
+            lth_loc::format("failed to start the I/O reactor: {1}", e.what()) };
+    }
+
+    LOG_DEBUG("Started the I/O reactor with {1} threads", num_threads);
+}
+
+IoReactor::~IoReactor()
+{
+    stop();
+}
+
+unsigned int IoReactor::getNumThreads() const
+{
+    return static_cast<unsigned int>(threads_.size());
+}
+
+boost::asio::io_service& IoReactor::getIoService()
+{
+    return *io_service_;
+}
+
+bool IoReactor::isEventLoopThread() const
+{
+    auto this_id = Util::this_thread::get_id();
+
+    for (const auto& t : threads_)
+        if (t->get_id() == this_id)
+            return true;
+
+    return false;
+}
+
+// Release the object, by returning, once all the handles have
+// expired; otherwise check again after RELEASE_CHECK_INTERVAL_MS
+static void checkExpired(std::shared_ptr<boost::asio::deadline_timer> timer,
+                         std::shared_ptr<void> object,
+                         std::vector<std::weak_ptr<void>> handles)
+{
+    if (std::all_of(handles.begin(), handles.end(),
+                    [](const std::weak_ptr<void>& hdl) { return hdl.expired(); }))
+        return;
+
+    timer->expires_from_now(
+        boost::posix_time::milliseconds(RELEASE_CHECK_INTERVAL_MS));
+    timer->async_wait(
+        [timer, object, handles](const boost::system::error_code& ec) {
+            if (!ec)
+                checkExpired(timer, object, handles);
+        });
+}
+
+void IoReactor::releaseWhenExpired(std::shared_ptr<void> object,
+                                   std::vector<std::weak_ptr<void>> handles)
+{
+    std::shared_ptr<boost::asio::deadline_timer> timer {
+        new boost::asio::deadline_timer(*io_service_) };
+    checkExpired(std::move(timer), std::move(object), std::move(handles));
+}
+
+void IoReactor::runEventLoop(std::shared_ptr<boost::asio::io_service> io_service)
+{
+    for (;;) {
+        try {
+            io_service->run();
+            return;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Unexpected failure of an I/O reactor handler: {1}",
+                      e.what());
+        } catch (...) {
+            LOG_ERROR("Unexpected failure of an I/O reactor handler");
+        }
+    }
+}
+
+void IoReactor::stop()
+{
+    work_.reset();
+    io_service_->stop();
+
+    for (auto& t : threads_) {
+        // The last reference may be released by a handler, in which
+        // case the thread executing it can't be joined
+        if (t->get_id() == Util::this_thread::get_id()) {
+            t->detach();
+        } else if (t->joinable()) {
+            t->join();
+        }
+    }
+}
+
+}  // namespace PCPClient
@@ -8,8 +8,8 @@
 
 #include <leatherman/logging/logging.hpp>
 
+#include <leatherman/util/scope_exit.hpp>
 #include <leatherman/util/strings.hpp>
-#include <leatherman/util/time.hpp>
 #include <leatherman/util/timer.hpp>
 
 #include <leatherman/locale/locale.hpp>
@@ -136,7 +136,8 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(pong_timeouts_before_retry),
                           std::move(ws_pong_timeout_ms) },
           associate_response_callback_ {},
-          session_association_ { std::move(association_timeout_s) }
+          session_association_ { std::move(association_timeout_s) },
+          debug_chunk_policy_ { DebugChunkPolicy::Lazy }
 {
     // Add PCP schemas to the Validator instance member
     validator_.registerSchema(Protocol::EnvelopeSchema());
@@ -184,7 +185,8 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(pong_timeouts_before_retry),
                           std::move(ws_pong_timeout_ms) },
           associate_response_callback_ {},
-          session_association_ { std::move(association_timeout_s) }
+          session_association_ { std::move(association_timeout_s) },
+          debug_chunk_policy_ { DebugChunkPolicy::Lazy }
 {
     // Add PCP schemas to the Validator instance member
     validator_.registerSchema(Protocol::EnvelopeSchema());
@@ -234,7 +236,8 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(pong_timeouts_before_retry),
                           std::move(ws_pong_timeout_ms) },
           associate_response_callback_ {},
-          session_association_ { std::move(association_timeout_s) }
+          session_association_ { std::move(association_timeout_s) },
+          debug_chunk_policy_ { DebugChunkPolicy::Lazy }
 {
     // Add PCP schemas to the Validator instance member
     validator_.registerSchema(Protocol::EnvelopeSchema());
@@ -289,7 +292,66 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(pong_timeouts_before_retry),
                           std::move(ws_pong_timeout_ms) },
           associate_response_callback_ {},
-          session_association_ { std::move(association_timeout_s) }
+          session_association_ { std::move(association_timeout_s) },
+          debug_chunk_policy_ { DebugChunkPolicy::Lazy }
+{
+    // Add PCP schemas to the Validator instance member
+    validator_.registerSchema(Protocol::EnvelopeSchema());
+    validator_.registerSchema(Protocol::DebugSchema());
+    validator_.registerSchema(Protocol::DebugItemSchema());
+
+    // Register PCP callbacks
+    registerMessageCallback(
+        Protocol::AssociateResponseSchema(),
+        [this](const ParsedChunks& parsed_chunks) {
+            associateResponseCallback(parsed_chunks);
+        });
+
+    registerMessageCallback(
+        Protocol::ErrorMessageSchema(),
+        [this](const ParsedChunks& parsed_chunks) {
+            errorMessageCallback(parsed_chunks);
+        });
+
+    registerMessageCallback(
+        Protocol::TTLExpiredSchema(),
+        [this](const ParsedChunks& parsed_chunks) {
+            TTLMessageCallback(parsed_chunks);
+        });
+}
+
+// constructor for io reactor addition
+Connector::Connector(std::vector<std::string> broker_ws_uris,
+                     std::string client_type,
+                     std::string ca_crt_path,
+                     std::string client_crt_path,
+                     std::string client_key_path,
+                     std::string client_crl_path,
+                     std::string ws_proxy,
+                     lth_log::log_level loglevel,
+                     std::ostream* logstream,
+                     std::shared_ptr<IoReactor> io_reactor,
+                     long ws_connection_timeout_ms,
+                     uint32_t association_timeout_s,
+                     uint32_t association_request_ttl_s,
+                     uint32_t pong_timeouts_before_retry,
+                     long ws_pong_timeout_ms)
+        : ConnectorBase { std::move(broker_ws_uris),
+                          std::move(client_type),
+                          std::move(ca_crt_path),
+                          std::move(client_crt_path),
+                          std::move(client_key_path),
+                          std::move(client_crl_path),
+                          std::move(ws_proxy),
+                          std::move(loglevel),
+                          logstream,
+                          std::move(io_reactor),
+                          std::move(ws_connection_timeout_ms),
+                          std::move(pong_timeouts_before_retry),
+                          std::move(ws_pong_timeout_ms) },
+          associate_response_callback_ {},
+          session_association_ { std::move(association_timeout_s) },
+          debug_chunk_policy_ { DebugChunkPolicy::Lazy }
 {
     // Add PCP schemas to the Validator instance member
     validator_.registerSchema(Protocol::EnvelopeSchema());
@@ -328,18 +390,24 @@ void Connector::setTTLExpiredCallback(MessageCallback callback)
     TTL_expired_callback_ = callback;
 }
 
+void Connector::setDebugChunkPolicy(DebugChunkPolicy debug_chunk_policy)
+{
+    debug_chunk_policy_ = debug_chunk_policy;
+}
+
 // Manage connection association
 
 void Connector::connect(int max_connect_attempts)
 {
     if (connection_ptr_ == nullptr) {
         // Initialize the WebSocket connection
-        connection_ptr_.reset(new Connection(broker_ws_uris_, client_metadata_));
+        connection_ptr_.reset(new Connection(broker_ws_uris_, client_metadata_, io_reactor_));
 
         // Set WebSocket callbacks
         connection_ptr_->setOnMessageCallback(
             [this](std::string message) {
-                processMessage(message);
+                auto msg_owner = std::make_shared<const std::string>(std::move(message));
+                processMessage(*msg_owner, msg_owner);
             });
 
         connection_ptr_->setOnOpenCallback(
@@ -494,10 +562,13 @@ AssociationTimings Connector::getAssociationTimings() const
 void Connector::send(const Message& msg)
 {
     checkConnectionInitialization();
-    auto serialized_msg = msg.getSerialized();
+
+    // Append the chunks to the WebSocket message buffer, from their
+    // storage
+    auto frame_buffers = msg.getFrameBuffers();
     LOG_DEBUG("Sending message of {1} bytes:\n{2}",
-              serialized_msg.size(), msg.toString());
-    connection_ptr_->send(&serialized_msg[0], serialized_msg.size());
+              frame_buffers.size(), msg.toString());
+    connection_ptr_->send(frame_buffers.getBuffers());
 }
 
 std::string Connector::send(const std::vector<std::string>& targets,
@@ -506,10 +577,8 @@ std::string Connector::send(const std::vector<std::string>& targets,
                      const lth_jc::JsonContainer& data_json,
                      const std::vector<lth_jc::JsonContainer>& debug)
 {
-    return sendMessage(targets,
-                       message_type,
+    return sendMessage(createEnvelopeTemplate(targets, message_type),
                        timeout,
-                       false,
                        data_json.toString(),
                        debug);
 }
@@ -520,10 +589,8 @@ std::string Connector::send(const std::vector<std::string>& targets,
                      const std::string& data_binary,
                      const std::vector<lth_jc::JsonContainer>& debug)
 {
-    return sendMessage(targets,
-                       message_type,
+    return sendMessage(createEnvelopeTemplate(targets, message_type),
                        timeout,
-                       false,
                        data_binary,
                        debug);
 }
@@ -535,10 +602,10 @@ std::string Connector::send(const std::vector<std::string>& targets,
                      const lth_jc::JsonContainer& data_json,
                      const std::vector<lth_jc::JsonContainer>& debug)
 {
-    return sendMessage(targets,
-                       message_type,
+    return sendMessage(createEnvelopeTemplate(targets,
+                                              message_type,
+                                              destination_report),
                        timeout,
-                       destination_report,
                        data_json.toString(),
                        debug);
 }
@@ -550,14 +617,41 @@ std::string Connector::send(const std::vector<std::string>& targets,
                      const std::string& data_binary,
                      const std::vector<lth_jc::JsonContainer>& debug)
 {
-    return sendMessage(targets,
-                       message_type,
+    return sendMessage(createEnvelopeTemplate(targets,
+                                              message_type,
+                                              destination_report),
                        timeout,
-                       destination_report,
                        data_binary,
                        debug);
 }
 
+EnvelopeTemplate Connector::createEnvelopeTemplate(
+        const std::vector<std::string>& targets,
+        const std::string& message_type,
+        bool destination_report) const
+{
+    return EnvelopeTemplate { targets,
+                              message_type,
+                              client_metadata_.uri,
+                              destination_report };
+}
+
+std::string Connector::send(const EnvelopeTemplate& envelope_template,
+                     unsigned int timeout,
+                     const lth_jc::JsonContainer& data_json,
+                     const std::vector<lth_jc::JsonContainer>& debug)
+{
+    return sendMessage(envelope_template, timeout, data_json.toString(), debug);
+}
+
+std::string Connector::send(const EnvelopeTemplate& envelope_template,
+                     unsigned int timeout,
+                     const std::string& data_binary,
+                     const std::vector<lth_jc::JsonContainer>& debug)
+{
+    return sendMessage(envelope_template, timeout, data_binary, debug);
+}
+
 std::string Connector::sendError(const std::vector<std::string>& targets,
                      unsigned int timeout,
                      const std::string& id,
@@ -574,60 +668,55 @@ std::string Connector::sendError(const std::vector<std::string>& targets,
 // Private interface
 //
 
-MessageChunk Connector::createEnvelope(const std::vector<std::string>& targets,
-                                       const std::string& message_type,
-                                       unsigned int timeout,
-                                       bool destination_report,
-                                       std::string& msg_id)
+std::string Connector::createEnvelope(const EnvelopeTemplate& envelope_template,
+                                      unsigned int timeout,
+                                      std::string& msg_id)
 {
-    msg_id = lth_util::get_UUID();
-    auto expires = lth_util::get_ISO8601_time(timeout);
+    char id[Util::MessageIdGenerator::ID_SIZE];
+    char expires[Util::ExpiryFormatter::EXPIRY_SIZE];
+    id_generator_.generateOn(id);
+    expiry_formatter_.formatOn(timeout, expires);
+    msg_id.assign(id, sizeof(id));
     // TODO(ale): deal with locale & plural (PCP-257)
-    if (targets.size() == 1) {
+    if (envelope_template.getNumTargets() == 1) {
         LOG_DEBUG("Creating message with id {1} for {2} receiver",
-                  msg_id, targets.size());
+                  msg_id, envelope_template.getNumTargets());
     } else {
         LOG_DEBUG("Creating message with id {1} for {2} receivers",
-                  msg_id, targets.size());
+                  msg_id, envelope_template.getNumTargets());
     }
 
-    lth_jc::JsonContainer envelope_content {};
-
-    envelope_content.set<std::string>("id", msg_id);
-    envelope_content.set<std::string>("message_type", message_type);
-    envelope_content.set<std::vector<std::string>>("targets", targets);
-    envelope_content.set<std::string>("expires", expires);
-    envelope_content.set<std::string>("sender", client_metadata_.uri);
-
-    if (destination_report) {
-        envelope_content.set<bool>("destination_report", true);
-    }
-
-    return MessageChunk { ChunkDescriptor::ENVELOPE, envelope_content.toString() };
+    return envelope_template.render(msg_id,
+                                    boost::string_ref(expires, sizeof(expires)));
 }
 
-std::string Connector::sendMessage(const std::vector<std::string>& targets,
-                                   const std::string& message_type,
+std::string Connector::sendMessage(const EnvelopeTemplate& envelope_template,
                                    unsigned int timeout,
-                                   bool destination_report,
                                    const std::string& data_txt,
                                    const std::vector<lth_jc::JsonContainer>& debug)
 {
     std::string msg_id {};
-    auto envelope_chunk = createEnvelope(targets,
-                                         message_type,
-                                         timeout,
-                                         destination_report,
-                                         msg_id);
-    MessageChunk data_chunk { ChunkDescriptor::DATA, data_txt };
-    Message msg { envelope_chunk, data_chunk };
-
-    for (auto debug_content : debug) {
-        MessageChunk d_c { ChunkDescriptor::DEBUG, debug_content.toString() };
-        msg.addDebugChunk(d_c);
+    auto envelope_txt = createEnvelope(envelope_template, timeout, msg_id);
+    std::vector<std::string> debug_txts {};
+
+    for (const auto& debug_content : debug) {
+        debug_txts.push_back(debug_content.toString());
     }
 
-    send(msg);
+    // Send the chunks from their storage; the data, that may be a
+    // large binary string, is not copied into a Message
+    FrameBuffers frame_buffers { Message::getCurrentVersion() };
+    frame_buffers.addChunk(ChunkDescriptor::ENVELOPE, envelope_txt);
+    frame_buffers.addChunk(ChunkDescriptor::DATA, data_txt);
+
+    for (const auto& debug_txt : debug_txts) {
+        frame_buffers.addChunk(ChunkDescriptor::DEBUG, debug_txt);
+    }
+
+    checkConnectionInitialization();
+    LOG_DEBUG("Sending message of {1} bytes with id {2} and envelope:\n{3}",
+              frame_buffers.size(), msg_id, envelope_txt);
+    connection_ptr_->send(frame_buffers.getBuffers());
     return msg_id;
 }
 
@@ -652,17 +741,17 @@ void Connector::associateSession()
 
     // Envelope
     // NB: createEnvelope will update session_association_.request_id
-    auto envelope = createEnvelope(std::vector<std::string> { MY_BROKER_URI },
-                                   Protocol::ASSOCIATE_REQ_TYPE,
-                                   session_association_.association_timeout_s,
-                                   false,
-                                   session_association_.request_id);
+    auto envelope_txt = createEnvelope(
+        createEnvelopeTemplate(std::vector<std::string> { MY_BROKER_URI },
+                               Protocol::ASSOCIATE_REQ_TYPE),
+        session_association_.association_timeout_s,
+        session_association_.request_id);
 
     // Create and send message
     // NB: don't report a possible failure to session_association_;
     //     just let the onOpen handler close the WebSocket connection
     //     and let a connection_association_error be triggered
-    Message msg { envelope };
+    Message msg { MessageChunk { ChunkDescriptor::ENVELOPE, envelope_txt } };
     LOG_INFO("Sending Associate Session request with id {1} and a TTL of {2} s",
              session_association_.request_id, session_association_.association_timeout_s);
     send(msg);
@@ -671,28 +760,39 @@ void Connector::associateSession()
 // WebSocket - onMessage callback
 
 void Connector::processMessage(const std::string& msg_txt)
+{
+    processMessage(msg_txt, nullptr);
+}
+
+void Connector::processMessage(const std::string& msg_txt,
+                               std::shared_ptr<const void> msg_owner)
 {
 #ifdef DEV_LOG_RAW_MESSAGE
     LOG_DEBUG("Received message of {1} bytes - raw message:\n{2}",
               msg_txt.size(), msg_txt);
 #endif
 
+    // The working memory of the processing is reclaimed at once
+    lth_util::scope_exit arena_rewinder { [this]() { message_arena_->rewind(); } };
     std::string err_msg {};
 
-    // Deserialize the incoming message
-    std::unique_ptr<Message> msg_ptr;
+    // Deserialize the incoming message; its chunks are not copied, as
+    // msg_txt outlives the view
+    std::unique_ptr<MessageView> msg_ptr;
     try {
-        msg_ptr.reset(new Message(msg_txt));
+        msg_ptr.reset(new MessageView(msg_txt, std::move(msg_owner)));
     } catch (const message_error& e) {
         err_msg = lth_loc::format("Failed to deserialize message: {1}", e.what());
     }
 
-    // Parse message chunks, if the deserialization succeeded
-    ParsedChunks parsed_chunks;
+    // Validate the envelope, if the deserialization succeeded; that's
+    // done while parsing it, so no DOM is built for bad messages
+    EnvelopeFields envelope_fields {};
 
     if (err_msg.empty()) {
         try {
-            parsed_chunks = msg_ptr->getParsedChunks(validator_);
+            envelope_fields = msg_ptr->validateEnvelope(validator_,
+                                                        message_arena_.get());
         } catch (const validation_error& e) {
             err_msg = lth_loc::format("Invalid envelope - bad content: {1}", e.what());
         } catch (const lth_jc::data_parse_error& e) {
@@ -706,35 +806,55 @@ void Connector::processMessage(const std::string& msg_txt)
 
     if (!err_msg.empty()) {
         // Log and return; we cannot break the WebSocket event loop
-        LOG_ERROR(err_msg);
-        LOG_ACCESS((boost::format("DESERIALIZATION_ERROR %1% unknown unknown unknown")
-                    % connection_ptr_->getWsUri()).str());
-
-        if (session_association_.in_progress.load()) {
-            // Report that a bad message was received, as
-            // associateResponseCallback() won't be executed
-            Util::lock_guard<Util::mutex> the_lock { session_association_.mtx };
-            session_association_.got_messaging_failure = true;
-            session_association_.error = err_msg;
-            session_association_.cond_var.notify_one();
-        }
+        processDeserializationError(err_msg);
         return;
     }
 
-    auto message_type = parsed_chunks.envelope.get<std::string>("message_type");
-    auto id = parsed_chunks.envelope.get<std::string>("id");
-    auto sender = parsed_chunks.envelope.get<std::string>("sender");
+    const auto& message_type = envelope_fields.message_type;
     LOG_ACCESS((boost::format("AUTHORIZATION_SUCCESS %1% %2% %3% %4%")
-                   % connection_ptr_->getWsUri() % sender % message_type % id).str());
+                   % connection_ptr_->getWsUri() % envelope_fields.sender
+                   % message_type % envelope_fields.id).str());
 
-    // Execute the callback associated with the data schema
-    if (schema_callback_pairs_.find(message_type) != schema_callback_pairs_.end()) {
-        auto c_b = schema_callback_pairs_.at(message_type);
-        LOG_TRACE("Executing callback for a message with '{1}' schema", message_type);
-        c_b(parsed_chunks);
-    } else {
+    // Execute the callback associated with the data schema; the
+    // message chunks are parsed only in that case
+    auto c_b_itr = schema_callback_pairs_.find(message_type);
+
+    if (c_b_itr == schema_callback_pairs_.end()) {
         LOG_WARNING("No message callback has been registered for the '{1}' schema",
                     message_type);
+        return;
+    }
+
+    ParsedChunks parsed_chunks;
+
+    try {
+        parsed_chunks = msg_ptr->getParsedChunks(validator_, envelope_fields,
+                                                  lazy_data_parsing_.load(),
+                                                  debug_chunk_policy_.load());
+    } catch (const schema_not_found_error& e) {
+        // This is unexpected
+        processDeserializationError(
+            lth_loc::format("Unknown schema: {1}", e.what()));
+        return;
+    }
+
+    LOG_TRACE("Executing callback for a message with '{1}' schema", message_type);
+    c_b_itr->second(parsed_chunks);
+}
+
+void Connector::processDeserializationError(const std::string& err_msg)
+{
+    LOG_ERROR(err_msg);
+    LOG_ACCESS((boost::format("DESERIALIZATION_ERROR %1% unknown unknown unknown")
+                % connection_ptr_->getWsUri()).str());
+
+    if (session_association_.in_progress.load()) {
+        // Report that a bad message was received, as
+        // associateResponseCallback() won't be executed
+        Util::lock_guard<Util::mutex> the_lock { session_association_.mtx };
+        session_association_.got_messaging_failure = true;
+        session_association_.error = err_msg;
+        session_association_.cond_var.notify_one();
     }
 }
 
@@ -759,8 +879,8 @@ void Connector::associateResponseCallback(const ParsedChunks& parsed_chunks)
 
     auto response_id = parsed_chunks.envelope.get<std::string>("id");
     auto sender_uri = parsed_chunks.envelope.get<std::string>("sender");
-    auto success = parsed_chunks.data.get<bool>("success");
-    auto request_id = parsed_chunks.data.get<std::string>("id");
+    auto success = parsed_chunks.getData().get<bool>("success");
+    auto request_id = parsed_chunks.getData().get<std::string>("id");
 
     if (!session_association_.in_progress.load()) {
         LOG_WARNING("Received an unexpected Associate Session response; "
@@ -785,8 +905,8 @@ void Connector::associateResponseCallback(const ParsedChunks& parsed_chunks)
     if (success) {
         LOG_INFO("{1}: success", msg);
     } else {
-        if (parsed_chunks.data.includes("reason")) {
-            session_association_.error = parsed_chunks.data.get<std::string>("reason");
+        if (parsed_chunks.getData().includes("reason")) {
+            session_association_.error = parsed_chunks.getData().get<std::string>("reason");
             LOG_WARNING("{1}: failure - {2}", msg, session_association_.error);
         } else {
             session_association_.error.clear();
@@ -812,14 +932,14 @@ void Connector::errorMessageCallback(const ParsedChunks& parsed_chunks)
 
     auto error_id = parsed_chunks.envelope.get<std::string>("id");
     auto sender_uri = parsed_chunks.envelope.get<std::string>("sender");
-    auto description = parsed_chunks.data.get<std::string>("description");
+    auto description = parsed_chunks.getData().get<std::string>("description");
 
     std::string cause_id {};
     std::string msg { lth_loc::format("Received error {1} from {2}",
                                       error_id, sender_uri) };
 
-    if (parsed_chunks.data.includes("id")) {
-        cause_id = parsed_chunks.data.get<std::string>("id");
+    if (parsed_chunks.getData().includes("id")) {
+        cause_id = parsed_chunks.getData().get<std::string>("id");
         LOG_WARNING("{1} caused by message {2}: {3}", msg, cause_id, description);
     } else {
         LOG_WARNING("{1} (the id of the message that caused it is unknown): {2}",
@@ -852,7 +972,7 @@ void Connector::TTLMessageCallback(const ParsedChunks& parsed_chunks)
     assert(parsed_chunks.data_type == PCPClient::ContentType::Json);
 
     auto ttl_msg_id = parsed_chunks.envelope.get<std::string>("id");
-    auto expired_msg_id = parsed_chunks.data.get<std::string>("id");
+    auto expired_msg_id = parsed_chunks.getData().get<std::string>("id");
 
     LOG_WARNING("Received TTL Expired message {1} from {2} related to message {3}",
                 ttl_msg_id, parsed_chunks.envelope.get<std::string>("sender"),
@@ -1,18 +1,24 @@
 #include <cpp-pcp-client/connector/v2/connector.hpp>
 #include <cpp-pcp-client/protocol/v2/message.hpp>
+#include <cpp-pcp-client/protocol/v2/msgpack.hpp>
 #include <cpp-pcp-client/protocol/v2/schemas.hpp>
 #include <cpp-pcp-client/util/thread.hpp>
 #include <cpp-pcp-client/util/chrono.hpp>
 #include <cpp-pcp-client/util/logging.hpp>
 
+#include "util/json_scan.hpp"
+
 #define LEATHERMAN_LOGGING_NAMESPACE CPP_PCP_CLIENT_LOGGING_PREFIX".connector"
 
 #include <leatherman/logging/logging.hpp>
+#include <leatherman/util/scope_exit.hpp>
 #include <leatherman/util/strings.hpp>
 #include <leatherman/locale/locale.hpp>
 
 #include <boost/format.hpp>
 
+#include <algorithm>  // remove
+
 // TODO(ale): disable assert() once we're confident with the code...
 // To disable assert()
 // #define NDEBUG
@@ -112,7 +118,9 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(client_key_path),
                           std::move(ws_connection_timeout_ms),
                           std::move(pong_timeouts_before_retry),
-                          std::move(ws_pong_timeout_ms)}
+                          std::move(ws_pong_timeout_ms) },
+          check_data_txt_ { true },
+          using_message_pack_ { false }
 {
     // Rely on ConnectorBase being an abstract class with no operations in the constructor.
     for (auto& broker : broker_ws_uris_) {
@@ -148,7 +156,9 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(ws_proxy),
                           std::move(ws_connection_timeout_ms),
                           std::move(pong_timeouts_before_retry),
-                          std::move(ws_pong_timeout_ms)}
+                          std::move(ws_pong_timeout_ms) },
+          check_data_txt_ { true },
+          using_message_pack_ { false }
 {
     // Rely on ConnectorBase being an abstract class with no operations in the constructor.
     for (auto& broker : broker_ws_uris_) {
@@ -186,7 +196,9 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           std::move(ws_proxy),
                           std::move(ws_connection_timeout_ms),
                           std::move(pong_timeouts_before_retry),
-                          std::move(ws_pong_timeout_ms)}
+                          std::move(ws_pong_timeout_ms) },
+          check_data_txt_ { true },
+          using_message_pack_ { false }
 {
     // Rely on ConnectorBase being an abstract class with no operations in the constructor.
     for (auto& broker : broker_ws_uris_) {
@@ -228,7 +240,55 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
                           logstream,
                           std::move(ws_connection_timeout_ms),
                           std::move(pong_timeouts_before_retry),
-                          std::move(ws_pong_timeout_ms)}
+                          std::move(ws_pong_timeout_ms) },
+          check_data_txt_ { true },
+          using_message_pack_ { false }
+{
+    // Rely on ConnectorBase being an abstract class with no operations in the constructor.
+    for (auto& broker : broker_ws_uris_) {
+        broker += (broker.back() == '/' ? "" : "/") + client_metadata_.client_type;
+    }
+
+    // Add PCP schemas to the Validator instance member
+    validator_.registerSchema(Protocol::EnvelopeSchema());
+
+    // Register PCP callbacks
+    registerMessageCallback(
+        Protocol::ErrorMessageSchema(),
+        [this](const ParsedChunks& msg) {
+            errorMessageCallback(msg);
+        });
+}
+
+// constructor for io reactor addition
+Connector::Connector(std::vector<std::string> broker_ws_uris,
+                     std::string client_type,
+                     std::string ca_crt_path,
+                     std::string client_crt_path,
+                     std::string client_key_path,
+                     std::string client_crl_path,
+                     std::string ws_proxy,
+                     lth_log::log_level loglevel,
+                     std::ostream* logstream,
+                     std::shared_ptr<IoReactor> io_reactor,
+                     long ws_connection_timeout_ms,
+                     uint32_t pong_timeouts_before_retry,
+                     long ws_pong_timeout_ms)
+        : ConnectorBase { std::move(broker_ws_uris),
+                          std::move(client_type),
+                          std::move(ca_crt_path),
+                          std::move(client_crt_path),
+                          std::move(client_key_path),
+                          std::move(client_crl_path),
+                          std::move(ws_proxy),
+                          std::move(loglevel),
+                          logstream,
+                          std::move(io_reactor),
+                          std::move(ws_connection_timeout_ms),
+                          std::move(pong_timeouts_before_retry),
+                          std::move(ws_pong_timeout_ms) },
+          check_data_txt_ { true },
+          using_message_pack_ { false }
 {
     // Rely on ConnectorBase being an abstract class with no operations in the constructor.
     for (auto& broker : broker_ws_uris_) {
@@ -251,9 +311,16 @@ Connector::Connector(std::vector<std::string> broker_ws_uris,
 void Connector::send(const Message& msg)
 {
     checkConnectionInitialization();
-    auto stringified_msg = msg.toString();
-    LOG_DEBUG("Sending message:\n{1}", stringified_msg);
-    connection_ptr_->send(stringified_msg);
+
+    if (isUsingMessagePack()) {
+        LOG_DEBUG("Sending message:\n{1}", msg.toString());
+        auto msgpack = msg.toMessagePack();
+        connection_ptr_->send(&msgpack[0], msgpack.size());
+    } else {
+        auto stringified_msg = msg.toString();
+        LOG_DEBUG("Sending message:\n{1}", stringified_msg);
+        connection_ptr_->send(stringified_msg);
+    }
 }
 
 std::string Connector::send(const std::string& target,
@@ -261,59 +328,180 @@ std::string Connector::send(const std::string& target,
                      const lth_jc::JsonContainer& data_json,
                      const std::string& in_reply_to)
 {
-    auto msg_id = lth_util::get_UUID();
-    LOG_DEBUG("Creating message with id {1} for {2} receiver", msg_id, 1);
-
-    lth_jc::JsonContainer envelope_content {};
+    return send(createEnvelopeTemplate(target, message_type),
+                data_json,
+                in_reply_to);
+}
 
-    envelope_content.set("id", msg_id);
-    envelope_content.set("message_type", message_type);
-    envelope_content.set("target", target);
-    envelope_content.set("sender", client_metadata_.uri);
-    envelope_content.set("data", data_json);
+EnvelopeTemplate Connector::createEnvelopeTemplate(const std::string& target,
+                                                   const std::string& message_type) const
+{
+    return EnvelopeTemplate { target, message_type, client_metadata_.uri };
+}
 
-    if (!in_reply_to.empty()) {
-        envelope_content.set<std::string>("in_reply_to", in_reply_to);
-    }
+std::string Connector::send(const EnvelopeTemplate& envelope_template,
+                     const lth_jc::JsonContainer& data_json,
+                     const std::string& in_reply_to)
+{
+    auto msg_id = id_generator_.generate();
+    LOG_DEBUG("Creating message with id {1} for {2} receiver", msg_id, 1);
 
-    Message msg { envelope_content };
-    send(msg);
+    // The data is written straight into the message
+    sendRendered(envelope_template.renderJson(msg_id, in_reply_to, data_json));
     return msg_id;
 }
 
+std::string Connector::send(const EnvelopeTemplate& envelope_template,
+                     const std::string& data_txt,
+                     const std::string& in_reply_to)
+{
+    if (check_data_txt_)
+        Util::checkJsonText(data_txt);
+
+    return sendText(envelope_template, data_txt, in_reply_to);
+}
+
 std::string Connector::send(const std::string& target,
                      const std::string& message_type,
                      const std::string& data_txt,
                      const std::string& in_reply_to)
 {
-    return send(target, message_type, lth_jc::JsonContainer(data_txt), in_reply_to);
+    return send(createEnvelopeTemplate(target, message_type),
+                data_txt,
+                in_reply_to);
 }
 
-static lth_jc::JsonContainer asJsonContainer(std::string const& val)
+std::string Connector::sendBinary(const std::string& target,
+                     const std::string& message_type,
+                     const std::string& data_binary,
+                     const std::string& in_reply_to)
+{
+    return sendBinary(createEnvelopeTemplate(target, message_type),
+                      data_binary,
+                      in_reply_to);
+}
+
+std::string Connector::sendBinary(const EnvelopeTemplate& envelope_template,
+                     const std::string& data_binary,
+                     const std::string& in_reply_to)
+{
+    auto msg_id = id_generator_.generate();
+    LOG_DEBUG("Creating message with id {1} for {2} receiver", msg_id, 1);
+
+    sendRendered(envelope_template.renderBinary(msg_id, in_reply_to, data_binary));
+    return msg_id;
+}
+
+void Connector::setDataTextChecking(bool check_data_txt)
 {
-    lth_jc::JsonContainer container;
-    // set the value as a string ...
-    container.set<std::string>("", val);
-    // ... but retrieve it as a JSON container
-    return container.get<lth_jc::JsonContainer>("");
+    check_data_txt_ = check_data_txt;
 }
 
 std::string Connector::sendError(const std::string& target,
                      const std::string& in_reply_to,
                      const std::string& description)
 {
-    lth_jc::JsonContainer error_data = asJsonContainer(description);
-    return send(target, Protocol::ERROR_MSG_TYPE, error_data, in_reply_to);
+    // The description is quoted as a JSON string, which needs no check
+    return sendText(createEnvelopeTemplate(target, Protocol::ERROR_MSG_TYPE),
+                    quoteJsonString(description),
+                    in_reply_to);
+}
+
+void Connector::setMessagePackEncoding(bool use_msgpack)
+{
+    // The Connection copies the client metadata when initialized
+    if (connection_ptr_ != nullptr)
+        throw connection_config_error {
+            lth_loc::translate("the message encoding must be set before "
+                               "connecting") };
+
+    auto& subprotocols = client_metadata_.ws_subprotocols;
+    subprotocols.erase(std::remove(subprotocols.begin(), subprotocols.end(),
+                                   Protocol::MESSAGE_PACK_SUBPROTOCOL),
+                       subprotocols.end());
+
+    if (use_msgpack)
+        subprotocols.push_back(Protocol::MESSAGE_PACK_SUBPROTOCOL);
+}
+
+bool Connector::isUsingMessagePack() const
+{
+    return using_message_pack_.load();
+}
+
+// Manage the connection state
+
+void Connector::connect(int max_connect_attempts)
+{
+    if (connection_ptr_ == nullptr) {
+        // Initialize the WebSocket connection
+        connection_ptr_.reset(new Connection(broker_ws_uris_, client_metadata_, io_reactor_));
+
+        // Set WebSocket callbacks
+        connection_ptr_->setOnMessageCallback(
+            [this](std::string message) {
+                processMessage(message);
+            });
+
+        connection_ptr_->setOnOpenCallback(
+            [this]() {
+                updateMessageEncoding();
+            });
+
+        connection_ptr_->setOnCloseCallback(
+            [this]() {
+                using_message_pack_ = false;
+                notifyClose();
+            });
+    }
+
+    ConnectorBase::connect(max_connect_attempts);
+
+    // NB: connect() returns once the connection is open, possibly
+    //     before the onOpen callback is executed
+    updateMessageEncoding();
 }
 
 //
 // Private interface
 //
 
+void Connector::updateMessageEncoding()
+{
+    using_message_pack_ =
+        connection_ptr_->getSubprotocol() == Protocol::MESSAGE_PACK_SUBPROTOCOL;
+}
+
 //
 // Callbacks
 //
 
+// Send messages
+
+std::string Connector::sendText(const EnvelopeTemplate& envelope_template,
+                                boost::string_ref data_txt,
+                                const std::string& in_reply_to)
+{
+    auto msg_id = id_generator_.generate();
+    LOG_DEBUG("Creating message with id {1} for {2} receiver", msg_id, 1);
+
+    sendRendered(envelope_template.render(msg_id, in_reply_to, data_txt));
+    return msg_id;
+}
+
+void Connector::sendRendered(const std::string& msg_txt)
+{
+    checkConnectionInitialization();
+    LOG_DEBUG("Sending message:\n{1}", msg_txt);
+
+    if (isUsingMessagePack()) {
+        auto msgpack = jsonToMessagePack(msg_txt);
+        connection_ptr_->send(&msgpack[0], msgpack.size());
+    } else {
+        connection_ptr_->send(msg_txt);
+    }
+}
+
 // WebSocket - onMessage callback
 
 void Connector::processMessage(const std::string& msg_txt)
@@ -323,12 +511,38 @@ void Connector::processMessage(const std::string& msg_txt)
               msg_txt.size(), msg_txt);
 #endif
 
+    if (!isUsingMessagePack()) {
+        processJsonMessage(msg_txt);
+        return;
+    }
+
+    std::string json_txt {};
+    try {
+        json_txt = messagePackToJson(msg_txt);
+    } catch (const lth_jc::data_parse_error& e) {
+        // Log and return; we cannot break the WebSocket event loop
+        LOG_ERROR(lth_loc::format("Invalid message - invalid MessagePack content: {1}",
+                                  e.what()));
+        LOG_ACCESS((boost::format("DESERIALIZATION_ERROR %1% unknown unknown unknown")
+                    % connection_ptr_->getWsUri()).str());
+        return;
+    }
+
+    processJsonMessage(json_txt);
+}
+
+void Connector::processJsonMessage(const std::string& msg_txt)
+{
+    // The working memory of the processing is reclaimed at once
+    lth_util::scope_exit arena_rewinder { [this]() { message_arena_->rewind(); } };
     std::string err_msg {};
 
-    // Deserialize the incoming message
-    std::unique_ptr<Message> msg_ptr;
+    // Validate the envelope while parsing the incoming message; no
+    // DOM is built for bad messages
+    EnvelopeFields envelope_fields {};
     try {
-        msg_ptr.reset(new Message(msg_txt));
+        envelope_fields = Message::validateEnvelope(msg_txt, validator_,
+                                                    message_arena_.get());
     } catch (const lth_jc::data_parse_error& e) {
         err_msg = lth_loc::format("Invalid envelope - invalid JSON content: {1}",
                                   e.what());
@@ -347,24 +561,27 @@ void Connector::processMessage(const std::string& msg_txt)
         return;
     }
 
-    auto chunks = msg_ptr->getParsedChunks(validator_);
-    lth_jc::JsonContainer const& envelope = chunks.envelope;
-
-    auto message_type = envelope.get<std::string>("message_type");
-    auto id = envelope.get<std::string>("id");
-    auto sender = envelope.includes("sender") ? envelope.get<std::string>("sender") : MY_BROKER_URI;
+    const auto& message_type = envelope_fields.message_type;
+    auto sender = envelope_fields.sender.empty() ? MY_BROKER_URI : envelope_fields.sender;
     LOG_ACCESS((boost::format("AUTHORIZATION_SUCCESS %1% %2% %3% %4%")
-                   % connection_ptr_->getWsUri() % sender % message_type % id).str());
+                   % connection_ptr_->getWsUri() % sender % message_type
+                   % envelope_fields.id).str());
 
-    // Execute the callback associated with the data schema
-    if (schema_callback_pairs_.find(message_type) != schema_callback_pairs_.end()) {
-        auto c_b = schema_callback_pairs_.at(message_type);
-        LOG_TRACE("Executing callback for a message with '{1}' schema", message_type);
-        c_b(chunks);
-    } else {
+    // Execute the callback associated with the data schema; the
+    // message is parsed only in that case
+    auto c_b_itr = schema_callback_pairs_.find(message_type);
+
+    if (c_b_itr == schema_callback_pairs_.end()) {
         LOG_WARNING("No message callback has been registered for the '{1}' schema",
                     message_type);
+        return;
     }
+
+    Message msg { msg_txt };
+    auto chunks = msg.getParsedChunks(validator_, envelope_fields,
+                                      lazy_data_parsing_.load());
+    LOG_TRACE("Executing callback for a message with '{1}' schema", message_type);
+    c_b_itr->second(chunks);
 }
 
 // PCP - PCP Error message callback
@@ -377,9 +594,9 @@ void Connector::errorMessageCallback(const ParsedChunks& chunks)
     auto sender_uri = envelope.includes("sender") ? envelope.get<std::string>("sender") : MY_BROKER_URI;
 
     std::string description;
-    if (chunks.has_data && !chunks.invalid_data) {
+    if (chunks.has_data && !chunks.hasInvalidData()) {
         assert(chunks.data_type == ContentType::Json);
-        description = chunks.data.get<std::string>();
+        description = chunks.getData().get<std::string>();
     }
 
     std::string cause_id {};
@@ -1,11 +1,58 @@
 #include <cpp-pcp-client/protocol/parsed_chunks.hpp>
+#include <cpp-pcp-client/util/thread.hpp>
+
+#include <utility>
 
 namespace PCPClient {
 
+//
+// ParsedChunks::LazyData
+//
+
+struct ParsedChunks::LazyData {
+    DataParser data_parser;
+    Util::mutex mutex;
+    bool parsed;
+    bool invalid;
+    lth_jc::JsonContainer data;
+
+    explicit LazyData(DataParser _data_parser)
+            : data_parser { std::move(_data_parser) },
+              mutex {},
+              parsed { false },
+              invalid { false },
+              data {} {
+    }
+};
+
+//
+// ParsedChunks::LazyDebug
+//
+
+struct ParsedChunks::LazyDebug {
+    DebugParser debug_parser;
+    Util::mutex mutex;
+    bool parsed;
+    unsigned int num_invalid;
+    std::vector<lth_jc::JsonContainer> debug;
+
+    explicit LazyDebug(DebugParser _debug_parser)
+            : debug_parser { std::move(_debug_parser) },
+              mutex {},
+              parsed { false },
+              num_invalid { 0 },
+              debug {} {
+    }
+};
+
 //
 // ParsedChunks
 //
 
+// NB: lth_jc::JsonContainer has no move ctor (its rvalue ctor copies
+//     the DOM), so the envelope and data DOMs passed to the ctors are
+//     copied into the members; std::move wouldn't save anything
+
 // Default ctor
 ParsedChunks::ParsedChunks()
         : envelope {},
@@ -15,7 +62,10 @@ ParsedChunks::ParsedChunks()
           data {},
           binary_data { "" },
           debug {},
-          num_invalid_debug { 0 } {
+          num_invalid_debug { 0 },
+          num_skipped_debug { 0 },
+          lazy_data_ {},
+          lazy_debug_ {} {
 }
 
 // No data ctor
@@ -28,8 +78,11 @@ ParsedChunks::ParsedChunks(lth_jc::JsonContainer _envelope,
           data_type { ContentType::Json },
           data {},
           binary_data { "" },
-          debug { _debug },
-          num_invalid_debug { _num_invalid_debug } {
+          debug { std::move(_debug) },
+          num_invalid_debug { _num_invalid_debug },
+          num_skipped_debug { 0 },
+          lazy_data_ {},
+          lazy_debug_ {} {
 }
 
 // Invalid data ctor
@@ -43,8 +96,11 @@ ParsedChunks::ParsedChunks(lth_jc::JsonContainer _envelope,
           data_type { ContentType::Json },
           data {},
           binary_data { "" },
-          debug { _debug },
-          num_invalid_debug { _num_invalid_debug } {
+          debug { std::move(_debug) },
+          num_invalid_debug { _num_invalid_debug },
+          num_skipped_debug { 0 },
+          lazy_data_ {},
+          lazy_debug_ {} {
 }
 
 // JSON data ctor
@@ -58,8 +114,11 @@ ParsedChunks::ParsedChunks(lth_jc::JsonContainer _envelope,
           data_type { ContentType::Json },
           data { _data },
           binary_data { "" },
-          debug { _debug },
-          num_invalid_debug { _num_invalid_debug } {
+          debug { std::move(_debug) },
+          num_invalid_debug { _num_invalid_debug },
+          num_skipped_debug { 0 },
+          lazy_data_ {},
+          lazy_debug_ {} {
 }
 
 // Binary data ctor
@@ -72,9 +131,50 @@ ParsedChunks::ParsedChunks(lth_jc::JsonContainer _envelope,
           invalid_data { false },
           data_type { ContentType::Binary },
           data {},
-          binary_data { _binary_data },
-          debug { _debug },
-          num_invalid_debug { _num_invalid_debug } {
+          binary_data { std::move(_binary_data) },
+          debug { std::move(_debug) },
+          num_invalid_debug { _num_invalid_debug },
+          num_skipped_debug { 0 },
+          lazy_data_ {},
+          lazy_debug_ {} {
+}
+
+// Lazy JSON data ctor
+ParsedChunks::ParsedChunks(lth_jc::JsonContainer _envelope,
+                           DataParser _data_parser,
+                           std::vector<lth_jc::JsonContainer> _debug,
+                           unsigned int _num_invalid_debug)
+        : envelope { _envelope },
+          has_data { true },
+          invalid_data { false },
+          data_type { ContentType::Json },
+          data {},
+          binary_data { "" },
+          debug { std::move(_debug) },
+          num_invalid_debug { _num_invalid_debug },
+          num_skipped_debug { 0 },
+          lazy_data_ { std::make_shared<LazyData>(std::move(_data_parser)) },
+          lazy_debug_ {} {
+}
+
+const lth_jc::JsonContainer& ParsedChunks::getData() const {
+    return lazy_data_ == nullptr ? data : getLazyData().data;
+}
+
+bool ParsedChunks::hasInvalidData() const {
+    return lazy_data_ == nullptr ? invalid_data : getLazyData().invalid;
+}
+
+void ParsedChunks::setDebugParser(DebugParser debug_parser) {
+    lazy_debug_ = std::make_shared<LazyDebug>(std::move(debug_parser));
+}
+
+const std::vector<lth_jc::JsonContainer>& ParsedChunks::getDebug() const {
+    return lazy_debug_ == nullptr ? debug : getLazyDebug().debug;
+}
+
+unsigned int ParsedChunks::getNumInvalidDebug() const {
+    return lazy_debug_ == nullptr ? num_invalid_debug : getLazyDebug().num_invalid;
 }
 
 std::string ParsedChunks::toString() const {
@@ -82,20 +182,46 @@ std::string ParsedChunks::toString() const {
 
     if (has_data) {
         s += "\nDATA: ";
-        if (invalid_data) {
+        if (hasInvalidData()) {
             s += "INVALID";
         } else if (data_type == ContentType::Json) {
-            s += data.toString();
+            s += getData().toString();
         } else {
             s += binary_data;
         }
     }
 
-    for (auto& d : debug) {
+    for (auto& d : getDebug()) {
         s += ("\nDEBUG: " + d.toString());
     }
 
     return s;
 }
 
+const ParsedChunks::LazyData& ParsedChunks::getLazyData() const {
+    Util::lock_guard<Util::mutex> the_lock { lazy_data_->mutex };
+
+    if (!lazy_data_->parsed) {
+        lazy_data_->invalid = !lazy_data_->data_parser(envelope, lazy_data_->data);
+        lazy_data_->parsed = true;
+
+        // Release what the parser captured
+        lazy_data_->data_parser = nullptr;
+    }
+
+    return *lazy_data_;
+}
+
+const ParsedChunks::LazyDebug& ParsedChunks::getLazyDebug() const {
+    Util::lock_guard<Util::mutex> the_lock { lazy_debug_->mutex };
+
+    if (!lazy_debug_->parsed) {
+        lazy_debug_->num_invalid = lazy_debug_->debug_parser(lazy_debug_->debug);
+        lazy_debug_->parsed = true;
+        lazy_debug_->debug_parser = nullptr;
+    }
+
+    return *lazy_debug_;
+}
+
 }  // namespace PCPClient
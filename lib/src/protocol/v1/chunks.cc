@@ -1,5 +1,7 @@
 #include <cpp-pcp-client/protocol/v1/chunks.hpp>
 
+#include <utility>  // move
+
 namespace PCPClient {
 namespace v1 {
 
@@ -19,12 +21,15 @@ MessageChunk::MessageChunk(uint8_t _descriptor,
                            std::string _content)
         : descriptor { _descriptor },
           size { _size },
-          content { _content } {
+          content { std::move(_content) } {
 }
 
+// NB: size is initialized before content is moved (declaration order)
 MessageChunk::MessageChunk(uint8_t _descriptor,
                            std::string _content)
-        : MessageChunk(_descriptor, _content.size(), _content) {
+        : descriptor { _descriptor },
+          size { static_cast<uint32_t>(_content.size()) },
+          content { std::move(_content) } {
 }
 
 bool MessageChunk::operator==(const MessageChunk& other_msg_chunk) const {
@@ -0,0 +1,78 @@
+#include <cpp-pcp-client/protocol/v1/envelope_template.hpp>
+
+#include <leatherman/json_container/json_container.hpp>
+
+namespace PCPClient {
+namespace v1 {
+
+namespace lth_jc = leatherman::json_container;
+
+//
+// Constants
+//
+
+static const boost::string_ref ID_PREFIX { "{\"id\":\"" };
+static const boost::string_ref EXPIRES_PREFIX { "\",\"expires\":\"" };
+static const boost::string_ref FIELDS_PREFIX { "\"," };
+
+//
+// EnvelopeTemplate
+//
+
+EnvelopeTemplate::EnvelopeTemplate(const std::vector<std::string>& targets,
+                                   const std::string& message_type,
+                                   const std::string& sender,
+                                   bool destination_report)
+        : message_type_ { message_type },
+          num_targets_ { targets.size() },
+          fields_ {} {
+    lth_jc::JsonContainer fields {};
+
+    fields.set<std::string>("message_type", message_type);
+    fields.set<std::vector<std::string>>("targets", targets);
+    fields.set<std::string>("sender", sender);
+
+    if (destination_report) {
+        fields.set<bool>("destination_report", true);
+    }
+
+    // Drop the opening brace; the entries follow id and expires
+    fields_ = fields.toString().substr(1);
+}
+
+const std::string& EnvelopeTemplate::getMessageType() const {
+    return message_type_;
+}
+
+size_t EnvelopeTemplate::getNumTargets() const {
+    return num_targets_;
+}
+
+size_t EnvelopeTemplate::getEnvelopeSize(boost::string_ref id,
+                                         boost::string_ref expires) const {
+    return ID_PREFIX.size() + id.size()
+           + EXPIRES_PREFIX.size() + expires.size()
+           + FIELDS_PREFIX.size() + fields_.size();
+}
+
+void EnvelopeTemplate::renderOn(std::string& buffer,
+                                boost::string_ref id,
+                                boost::string_ref expires) const {
+    buffer.assign(ID_PREFIX.data(), ID_PREFIX.size());
+    buffer.append(id.data(), id.size());
+    buffer.append(EXPIRES_PREFIX.data(), EXPIRES_PREFIX.size());
+    buffer.append(expires.data(), expires.size());
+    buffer.append(FIELDS_PREFIX.data(), FIELDS_PREFIX.size());
+    buffer.append(fields_);
+}
+
+std::string EnvelopeTemplate::render(boost::string_ref id,
+                                     boost::string_ref expires) const {
+    std::string envelope {};
+    envelope.reserve(getEnvelopeSize(id, expires));
+    renderOn(envelope, id, expires);
+    return envelope;
+}
+
+}  // namespace v1
+}  // namespace PCPClient
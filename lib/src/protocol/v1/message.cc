@@ -8,6 +8,8 @@
 #include <leatherman/locale/locale.hpp>
 
 #include <algorithm>  // find
+#include <cstring>  // memcpy
+#include <utility>  // move
 
 // TODO(ale): disable assert() once we're confident with the code...
 // To disable assert()
@@ -29,7 +31,7 @@ namespace lth_loc = leatherman::locale;
 static const size_t MIN_ENVELOPE_SIZE { 6 };
 
 // Size of descriptor and size fields [byte]
-static const size_t CHUNK_METADATA_SIZE { 5 };
+static const size_t CHUNK_METADATA_SIZE { CHUNK_HEADER_SIZE };
 
 // Size of version field [byte]
 static const size_t VERSION_FIELD_SIZE { 1 };
@@ -38,45 +40,73 @@ static const size_t VERSION_FIELD_SIZE { 1 };
 // be used when creating new messages
 static std::vector<uint8_t> SUPPORTED_VERSIONS { 1 };
 
+// Throw an unsupported_version_error in case the version is not
+// supported
+static void validateVersion(uint8_t version) {
+    auto found = std::find(SUPPORTED_VERSIONS.begin(), SUPPORTED_VERSIONS.end(),
+                           version);
+    if (found == SUPPORTED_VERSIONS.end()) {
+        auto version_num = static_cast<int>(version);
+        LOG_ERROR("Unsupported message version: {1}", version_num);
+        throw unsupported_version_error {
+            lth_loc::format("unsupported message version: {1}", version_num) };
+    }
+}
+
 //
 // Message
 //
 
 // Constructors
 
+static MessageChunk toMessageChunk(const ChunkView& chunk_view) {
+    return MessageChunk { chunk_view.descriptor,
+                          static_cast<uint32_t>(chunk_view.content.size()),
+                          chunk_view.content.to_string() };
+}
+
 Message::Message(const std::string& transport_msg) : version_ {},
                                                      envelope_chunk_ {},
                                                      data_chunk_ {},
                                                      debug_chunks_ {} {
-    parseMessage(transport_msg);
+    MessageView msg_view { transport_msg };
+    version_ = msg_view.getVersion();
+    envelope_chunk_ = toMessageChunk(msg_view.getEnvelopeChunk());
+
+    if (msg_view.hasData())
+        data_chunk_ = toMessageChunk(msg_view.getDataChunk());
+
+    for (const auto& d_c : msg_view.getDebugChunks())
+        debug_chunks_.push_back(toMessageChunk(d_c));
 }
 
 Message::Message(MessageChunk envelope_chunk)
         : version_ { SUPPORTED_VERSIONS.back() },
-          envelope_chunk_ { envelope_chunk },
+          envelope_chunk_ { std::move(envelope_chunk) },
           data_chunk_ {},
           debug_chunks_ {} {
-    validateChunk(envelope_chunk);
+    validateChunk(envelope_chunk_);
 }
 
 Message::Message(MessageChunk envelope_chunk, MessageChunk data_chunk)
         : version_ { SUPPORTED_VERSIONS.back() },
-          envelope_chunk_ { envelope_chunk },
-          data_chunk_ { data_chunk },
+          envelope_chunk_ { std::move(envelope_chunk) },
+          data_chunk_ { std::move(data_chunk) },
           debug_chunks_ {} {
-    validateChunk(envelope_chunk);
-    validateChunk(data_chunk);
+    validateChunk(envelope_chunk_);
+    validateChunk(data_chunk_);
 }
 
 Message::Message(MessageChunk envelope_chunk, MessageChunk data_chunk,
                  MessageChunk debug_chunk)
         : version_ { SUPPORTED_VERSIONS.back() },
-          envelope_chunk_ { envelope_chunk },
-          data_chunk_ { data_chunk },
-          debug_chunks_ { debug_chunk } {
-    validateChunk(envelope_chunk);
-    validateChunk(data_chunk);
+          envelope_chunk_ { std::move(envelope_chunk) },
+          data_chunk_ { std::move(data_chunk) },
+          debug_chunks_ {} {
+    validateChunk(envelope_chunk_);
+    validateChunk(data_chunk_);
     validateChunk(debug_chunk);
+    debug_chunks_.push_back(std::move(debug_chunk));
 }
 
 // Add chunks
@@ -88,12 +118,12 @@ void Message::setDataChunk(MessageChunk data_chunk) {
         LOG_WARNING("Resetting data chunk");
     }
 
-    data_chunk_ = data_chunk;
+    data_chunk_ = std::move(data_chunk);
 }
 
 void Message::addDebugChunk(MessageChunk debug_chunk) {
     validateChunk(debug_chunk);
-    debug_chunks_.push_back(debug_chunk);
+    debug_chunks_.push_back(std::move(debug_chunk));
 }
 
 // Getters
@@ -102,18 +132,24 @@ uint8_t Message::getVersion() const {
     return version_;
 }
 
-MessageChunk Message::getEnvelopeChunk() const {
+const MessageChunk& Message::getEnvelopeChunk() const {
     return envelope_chunk_;
 }
 
-MessageChunk Message::getDataChunk() const {
+const MessageChunk& Message::getDataChunk() const {
     return data_chunk_;
 }
 
-std::vector<MessageChunk> Message::getDebugChunks() const {
+const std::vector<MessageChunk>& Message::getDebugChunks() const {
     return debug_chunks_;
 }
 
+MessageChunk Message::releaseDataChunk() {
+    MessageChunk data_chunk { std::move(data_chunk_) };
+    data_chunk_ = MessageChunk {};
+    return data_chunk;
+}
+
 // Inspectors
 
 bool Message::hasData() const {
@@ -126,44 +162,147 @@ bool Message::hasDebug() const {
 
 // Get the serialized message
 
+// Write the chunk on the buffer; return the pointer to the byte past it
+static uint8_t* writeChunk(const MessageChunk& chunk, uint8_t* buffer) {
+    const auto& content = chunk.content;
+    buffer = writeChunkHeader(chunk.descriptor,
+                              static_cast<uint32_t>(content.size()),
+                              buffer);
+    if (!content.empty())
+        std::memcpy(buffer, content.data(), content.size());
+    return buffer + content.size();
+}
+
 SerializedMessage Message::getSerialized() const {
     SerializedMessage buffer;
 
-    // Version (mandatory)
-    serialize<uint8_t>(version_, 1, buffer);
+    try {
+        buffer.resize(getSerializedSize());
+    } catch (const std::bad_alloc&) {
+        throw message_serialization_error {
+            lth_loc::translate("serialization: bad allocation") };
+    }
 
-    // Envelope (mandatory)
-    envelope_chunk_.serializeOn(buffer);
+    serializeOn(buffer.data(), buffer.size());
+    return buffer;
+}
+
+size_t Message::getSerializedSize() const {
+    // Version and envelope (mandatory)
+    auto size = VERSION_FIELD_SIZE
+                + getSerializedChunkSize(envelope_chunk_.content.size());
 
     if (hasData()) {
         // Data (optional)
-        data_chunk_.serializeOn(buffer);
+        size += getSerializedChunkSize(data_chunk_.content.size());
     }
 
-    if (hasDebug()) {
-        for (const auto& d_c : debug_chunks_)
-            // Debug (optional; mutiple)
-            d_c.serializeOn(buffer);
+    for (const auto& d_c : debug_chunks_) {
+        // Debug (optional; mutiple)
+        size += getSerializedChunkSize(d_c.content.size());
     }
 
-    return buffer;
+    return size;
+}
+
+FrameBuffers Message::getFrameBuffers() const {
+    FrameBuffers frame_buffers { version_ };
+    frame_buffers.addChunk(envelope_chunk_.descriptor, envelope_chunk_.content);
+
+    if (hasData()) {
+        frame_buffers.addChunk(data_chunk_.descriptor, data_chunk_.content);
+    }
+
+    for (const auto& d_c : debug_chunks_) {
+        frame_buffers.addChunk(d_c.descriptor, d_c.content);
+    }
+
+    return frame_buffers;
+}
+
+uint8_t Message::getCurrentVersion() {
+    return SUPPORTED_VERSIONS.back();
+}
+
+size_t Message::serializeOn(uint8_t* buffer, size_t buffer_size) const {
+    auto size = getSerializedSize();
+
+    if (buffer_size < size) {
+        throw message_serialization_error {
+            lth_loc::format("serialization: the buffer is too small ({1} "
+                            "bytes; {2} bytes needed)", buffer_size, size) };
+    }
+
+    auto next_ptr = buffer;
+    *next_ptr++ = version_;
+    next_ptr = writeChunk(envelope_chunk_, next_ptr);
+
+    if (hasData()) {
+        next_ptr = writeChunk(data_chunk_, next_ptr);
+    }
+
+    for (const auto& d_c : debug_chunks_) {
+        next_ptr = writeChunk(d_c, next_ptr);
+    }
+
+    assert(next_ptr == buffer + size);
+    return size;
 }
 
 // Parse JSON, validate schema, and return the content of chunks
 
-ParsedChunks Message::getParsedChunks(const Validator& validator) const {
-    // Envelope
-    lth_jc::JsonContainer envelope_content { envelope_chunk_.content };
-    validator.validate(envelope_content, Protocol::ENVELOPE_SCHEMA_NAME);
-    auto msg_id = envelope_content.get<std::string>("id");
+// Validate the envelope content while parsing it; return its routing
+// entries
+static EnvelopeFields validateEnvelopeContent(const Validator& validator,
+                                              boost::string_ref envelope_txt,
+                                              Util::MonotonicBufferResource* arena) {
+    std::vector<PropertyCapture> captures { { "id", "" },
+                                            { "message_type", "" },
+                                            { "sender", "" } };
+    validator.validateText(envelope_txt,
+                           Protocol::ENVELOPE_SCHEMA_NAME,
+                           &captures,
+                           arena);
+
+    return EnvelopeFields { std::move(captures[0].value),
+                            std::move(captures[1].value),
+                            std::move(captures[2].value) };
+}
 
-    // Debug
-    std::vector<lth_jc::JsonContainer> debug_content {};
+// Parse and validate the JSON data; return false, after logging the
+// error, in case it's invalid
+static bool parseData(const Validator& validator,
+                      boost::string_ref data_txt,
+                      const std::string& message_type,
+                      const std::string& msg_id,
+                      lth_jc::JsonContainer& data) {
+    std::string err_msg {};
+
+    try {
+        data = validator.parseText(data_txt, message_type);
+        return true;
+    } catch (leatherman::json_container::data_parse_error& e) {
+        err_msg = e.what();
+    } catch (validator_error& e) {
+        err_msg = e.what();
+    }
+
+    LOG_DEBUG("Invalid data in message {1}: {2}", msg_id, err_msg);
+    return false;
+}
+
+// Parse and validate the debug chunks; store the valid ones and
+// return the number of the invalid ones
+static unsigned int parseDebug(const Validator& validator,
+                               const std::vector<boost::string_ref>& debug_txts,
+                               const std::string& msg_id,
+                               std::vector<lth_jc::JsonContainer>& debug) {
     unsigned int num_invalid_debug { 0 };
-    for (const auto& d_c : debug_chunks_) {
+
+    for (const auto& d_txt : debug_txts) {
         try {
             // Parse the JSON text
-            lth_jc::JsonContainer parsed_debug { d_c.content };
+            lth_jc::JsonContainer parsed_debug { d_txt.to_string() };
 
             // Validate entire content (array)
             validator.validate(parsed_debug, Protocol::DEBUG_SCHEMA_NAME);
@@ -173,7 +312,7 @@ ParsedChunks Message::getParsedChunks(const Validator& validator) const {
                 validator.validate(hop, Protocol::DEBUG_ITEM_SCHEMA_NAME);
             }
 
-            debug_content.push_back(parsed_debug);
+            debug.push_back(parsed_debug);
         } catch (leatherman::json_container::data_parse_error& e) {
             num_invalid_debug++;
             LOG_DEBUG("Invalid debug in message {1}: {2}", msg_id, e.what());
@@ -183,37 +322,72 @@ ParsedChunks Message::getParsedChunks(const Validator& validator) const {
         }
     }
 
+    return num_invalid_debug;
+}
+
+// Parse the data chunk, if any (data_txt is ignored otherwise), and
+// return it with the parsed envelope and debug. In case of lazy data,
+// the chunk is read in place if payload_owner (the owner of the
+// chunks) is set, otherwise it's copied, as the message may be
+// destroyed before the data is accessed
+static ParsedChunks parseContent(const Validator& validator,
+                                 const lth_jc::JsonContainer& envelope_content,
+                                 const EnvelopeFields& envelope_fields,
+                                 bool has_data,
+                                 boost::string_ref data_txt,
+                                 const std::vector<lth_jc::JsonContainer>& debug_content,
+                                 unsigned int num_invalid_debug,
+                                 bool lazy_data,
+                                 std::shared_ptr<const void> payload_owner) {
+    const auto& msg_id = envelope_fields.id;
+
     // Data
-    if (hasData()) {
-        auto message_type = envelope_content.get<std::string>("message_type");
+    if (has_data) {
+        const auto& message_type = envelope_fields.message_type;
         auto content_type = validator.getSchemaContentType(message_type);
 
         if (content_type == ContentType::Json) {
-            std::string err_msg {};
-            try {
-                lth_jc::JsonContainer data_content_json { data_chunk_.content };
-                validator.validate(data_content_json, message_type);
+            if (lazy_data) {
+                if (payload_owner == nullptr) {
+                    auto data_copy = std::make_shared<const std::string>(
+                        data_txt.to_string());
+                    data_txt = *data_copy;
+                    payload_owner = std::move(data_copy);
+                }
+
+                ParsedChunks::DataParser data_parser {
+                    [&validator, payload_owner, data_txt, message_type, msg_id](
+                            const lth_jc::JsonContainer&,
+                            lth_jc::JsonContainer& data) {
+                        return parseData(validator, data_txt, message_type,
+                                         msg_id, data);
+                    } };
+
+                // Lazy JSON data content
+                return ParsedChunks { envelope_content,
+                                      std::move(data_parser),
+                                      debug_content,
+                                      num_invalid_debug };
+            }
+
+            lth_jc::JsonContainer data_content_json {};
 
+            if (parseData(validator, data_txt, message_type, msg_id,
+                          data_content_json)) {
                 // Valid JSON data content
                 return ParsedChunks { envelope_content,
                                       data_content_json,
                                       debug_content,
                                       num_invalid_debug };
-            } catch (leatherman::json_container::data_parse_error& e) {
-                err_msg = e.what();
-            } catch (validator_error& e) {
-                err_msg = e.what();
             }
 
-            LOG_DEBUG("Invalid data in message {1}: {2}", msg_id, err_msg);
-
             // Bad JSON data content
             return ParsedChunks { envelope_content,
                                   true,
                                   debug_content,
                                   num_invalid_debug };
         } else if (content_type == ContentType::Binary) {
-            auto data_content_binary = data_chunk_.content;
+            auto data_content_binary = data_txt.to_string();
 
             // Binary data content
             return ParsedChunks { envelope_content,
@@ -228,6 +402,80 @@ ParsedChunks Message::getParsedChunks(const Validator& validator) const {
     return ParsedChunks { envelope_content, debug_content, num_invalid_debug };
 }
 
+// Parse and validate the chunks of a message, given its parsed
+// envelope, by processing the debug ones as specified; as for
+// parseContent, the lazy debug is read in place if payload_owner is
+// set, otherwise it's copied
+static ParsedChunks parseChunks(const Validator& validator,
+                                const lth_jc::JsonContainer& envelope_content,
+                                const EnvelopeFields& envelope_fields,
+                                bool has_data,
+                                boost::string_ref data_txt,
+                                std::vector<boost::string_ref> debug_txts,
+                                bool lazy_data,
+                                DebugChunkPolicy debug_policy,
+                                std::shared_ptr<const void> payload_owner) {
+    const auto& msg_id = envelope_fields.id;
+    std::vector<lth_jc::JsonContainer> debug_content {};
+    unsigned int num_invalid_debug { 0 };
+
+    if (debug_policy == DebugChunkPolicy::Eager)
+        num_invalid_debug = parseDebug(validator, debug_txts, msg_id, debug_content);
+
+    auto parsed_chunks = parseContent(validator, envelope_content, envelope_fields,
+                                      has_data, data_txt, debug_content,
+                                      num_invalid_debug, lazy_data, payload_owner);
+
+    if (!debug_txts.empty()) {
+        if (debug_policy == DebugChunkPolicy::Lazy) {
+            if (payload_owner == nullptr) {
+                auto debug_copies = std::make_shared<std::vector<std::string>>(
+                    debug_txts.begin(), debug_txts.end());
+                debug_txts.assign(debug_copies->begin(), debug_copies->end());
+                payload_owner = std::move(debug_copies);
+            }
+
+            parsed_chunks.setDebugParser(
+                [&validator, payload_owner, debug_txts, msg_id](
+                        std::vector<lth_jc::JsonContainer>& debug) {
+                    return parseDebug(validator, debug_txts, msg_id, debug);
+                });
+        } else if (debug_policy == DebugChunkPolicy::Skip) {
+            parsed_chunks.num_skipped_debug =
+                static_cast<unsigned int>(debug_txts.size());
+        }
+    }
+
+    return parsed_chunks;
+}
+
+ParsedChunks Message::getParsedChunks(const Validator& validator) const {
+    return getParsedChunks(validator, validateEnvelope(validator));
+}
+
+EnvelopeFields Message::validateEnvelope(const Validator& validator) const {
+    return validateEnvelopeContent(validator, envelope_chunk_.content, nullptr);
+}
+
+ParsedChunks Message::getParsedChunks(const Validator& validator,
+                                      const EnvelopeFields& envelope_fields,
+                                      bool lazy_data,
+                                      DebugChunkPolicy debug_policy) const {
+    std::vector<boost::string_ref> debug_txts {};
+    for (const auto& d_c : debug_chunks_)
+        debug_txts.push_back(d_c.content);
+
+    return parseChunks(validator,
+                       lth_jc::JsonContainer { envelope_chunk_.content },
+                       envelope_fields,
+                       hasData(),
+                       data_chunk_.content,
+                       std::move(debug_txts),
+                       lazy_data,
+                       debug_policy,
+                       nullptr);
+}
+
 // toString
 
 std::string Message::toString() const {
@@ -248,53 +496,217 @@ std::string Message::toString() const {
 // Message - private interface
 //
 
-void Message::parseMessage(const std::string& transport_msg) {
+void Message::validateChunk(const MessageChunk& chunk) const {
+    auto desc_bit = chunk.descriptor & ChunkDescriptor::TYPE_MASK;
+
+    if (ChunkDescriptor::names.find(desc_bit) == ChunkDescriptor::names.end()) {
+        LOG_ERROR("Unknown chunk descriptor: {1}",
+                  static_cast<int>(chunk.descriptor));
+        throw invalid_chunk_error { lth_loc::translate("unknown descriptor") };
+    }
+
+    if (chunk.size != static_cast<uint32_t>(chunk.content.size())) {
+        // TODO(ale): deal with locale and plural
+        if (chunk.size == 1) {
+            assert(chunk.content.size() != 1);
+            LOG_ERROR("Incorrect size for {1} chunk; declared {2} byte, got {3} bytes",
+                      ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
+        } else {
+            if (chunk.content.size() == 1) {
+                LOG_ERROR("Incorrect size for {1} chunk; declared {2} bytes, got {3} byte",
+                          ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
+            } else {
+                LOG_ERROR("Incorrect size for {1} chunk; declared {2} bytes, got {3} bytes",
+                          ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
+            }
+        }
+        throw invalid_chunk_error { lth_loc::translate("invalid size") };
+    }
+}
+
+//
+// MessageView
+//
+
+// Read a field of a chunk header, or the content of a chunk, and
+// advance the pointer past it; the caller checks the payload size
+
+static uint8_t readByte(const char*& ptr) {
+    return static_cast<uint8_t>(*ptr++);
+}
+
+static uint32_t readSize(const char*& ptr) {
+    uint32_t value { 0 };
+    for (unsigned int idx = 0; idx < 4; idx++)
+        value = (value << 8) | static_cast<uint8_t>(*ptr++);
+    return value;
+}
+
+static boost::string_ref readContent(uint32_t size, const char*& ptr) {
+    boost::string_ref content { ptr, size };
+    ptr += size;
+    return content;
+}
+
+// Constructor
+
+MessageView::MessageView(boost::string_ref transport_payload)
+        : MessageView(transport_payload, nullptr) {
+}
+
+MessageView::MessageView(boost::string_ref transport_payload,
+                         std::shared_ptr<const void> payload_owner)
+        : version_ {},
+          envelope_chunk_ {},
+          data_chunk_ {},
+          debug_chunks_ {},
+          envelope_ {},
+          payload_owner_ { std::move(payload_owner) } {
+    parsePayload(transport_payload);
+}
+
+// Getters
+
+uint8_t MessageView::getVersion() const {
+    return version_;
+}
+
+ChunkView MessageView::getEnvelopeChunk() const {
+    return envelope_chunk_;
+}
+
+ChunkView MessageView::getDataChunk() const {
+    return data_chunk_;
+}
+
+const std::vector<ChunkView>& MessageView::getDebugChunks() const {
+    return debug_chunks_;
+}
+
+// Inspectors
+
+bool MessageView::hasData() const {
+    return data_chunk_.descriptor != 0;
+}
+
+bool MessageView::hasDebug() const {
+    return !debug_chunks_.empty();
+}
+
+// Parse JSON, validate schema, and return the content of chunks
+
+const lth_jc::JsonContainer& MessageView::getEnvelope() const {
+    if (envelope_ == nullptr)
+        envelope_.reset(new lth_jc::JsonContainer(envelope_chunk_.content.to_string()));
+
+    return *envelope_;
+}
+
+EnvelopeFields MessageView::validateEnvelope(const Validator& validator,
+                                             Util::MonotonicBufferResource* arena) const {
+    return validateEnvelopeContent(validator, envelope_chunk_.content, arena);
+}
+
+ParsedChunks MessageView::getParsedChunks(const Validator& validator) const {
+    const auto& envelope = getEnvelope();
+    validator.validate(envelope, Protocol::ENVELOPE_SCHEMA_NAME);
+
+    EnvelopeFields envelope_fields {
+        envelope.get<std::string>("id"),
+        envelope.get<std::string>("message_type"),
+        envelope.includes("sender") ? envelope.get<std::string>("sender") : "" };
+    return getParsedChunks(validator, envelope_fields);
+}
+
+ParsedChunks MessageView::getParsedChunks(const Validator& validator,
+                                          const EnvelopeFields& envelope_fields,
+                                          bool lazy_data,
+                                          DebugChunkPolicy debug_policy) const {
+    std::vector<boost::string_ref> debug_txts {};
+    for (const auto& d_c : debug_chunks_)
+        debug_txts.push_back(d_c.content);
+
+    return parseChunks(validator,
+                       getEnvelope(),
+                       envelope_fields,
+                       hasData(),
+                       data_chunk_.content,
+                       std::move(debug_txts),
+                       lazy_data,
+                       debug_policy,
+                       payload_owner_);
+}
+
+// toString
+
+static std::string chunkToString(const ChunkView& chunk) {
+    return "size: " + std::to_string(chunk.content.size()) + " bytes - content: "
+           + chunk.content.to_string();
+}
+
+std::string MessageView::toString() const {
+    auto s = std::to_string(version_) + chunkToString(envelope_chunk_);
+
+    if (hasData()) {
+        s += chunkToString(data_chunk_);
+    }
+
+    for (const auto& debug_chunk : debug_chunks_) {
+        s += chunkToString(debug_chunk);
+    }
+
+    return s;
+}
+
+//
+// MessageView - private interface
+//
+
+void MessageView::parsePayload(boost::string_ref transport_msg) {
     auto msg_size = transport_msg.size();
 
     if (msg_size < MIN_ENVELOPE_SIZE) {
         LOG_ERROR("Invalid msg; envelope is too small");
-        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
         throw message_serialization_error {
             lth_loc::translate("invalid msg: envelope too small") };
     }
 
-    // Serialization buffer
-
-    auto buffer = SerializedMessage(transport_msg.begin(), transport_msg.end());
-    SerializedMessage::const_iterator next_itr { buffer.begin() };
+    // The chunks are parsed in place
+    auto next_ptr = transport_msg.data();
 
     // Version
 
-    auto msg_version = deserialize<uint8_t>(1, next_itr);
+    auto msg_version = readByte(next_ptr);
     validateVersion(msg_version);
 
     // Envelope (mandatory chunk)
 
-    auto envelope_desc = deserialize<uint8_t>(1, next_itr);
+    auto envelope_desc = readByte(next_ptr);
     auto envelope_desc_bit = envelope_desc & ChunkDescriptor::TYPE_MASK;
     if (envelope_desc_bit != ChunkDescriptor::ENVELOPE) {
         LOG_ERROR("Invalid msg; missing envelope descriptor");
-        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
         throw message_serialization_error {
             lth_loc::translate("invalid msg: no envelope descriptor") };
     }
 
-    auto envelope_size = deserialize<uint32_t>(4, next_itr);
+    auto envelope_size = readSize(next_ptr);
     if (envelope_size > UINT_MAX - (VERSION_FIELD_SIZE + CHUNK_METADATA_SIZE)) {
         LOG_ERROR("Invalid msg; envelope size is too large for 32-bit systems");
-        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
         throw message_serialization_error {
             lth_loc::translate("invalid msg: size too large") };
     }
 
     if (msg_size < VERSION_FIELD_SIZE + CHUNK_METADATA_SIZE + envelope_size) {
         LOG_ERROR("Invalid msg; missing envelope content");
-        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+        LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
         throw message_serialization_error {
             lth_loc::translate("invalid msg: no envelope") };
     }
 
-    auto envelope_content = deserialize<std::string>(envelope_size, next_itr);
+    auto envelope_content = readContent(envelope_size, next_ptr);
 
     // Data and debug (optional chunks)
 
@@ -302,19 +714,19 @@ void Message::parseMessage(const std::string& transport_msg) {
                                        + envelope_size);
 
     while (still_to_parse > CHUNK_METADATA_SIZE) {
-        auto chunk_desc = deserialize<uint8_t>(1, next_itr);
+        auto chunk_desc = readByte(next_ptr);
         auto chunk_desc_bit = chunk_desc & ChunkDescriptor::TYPE_MASK;
 
         if (chunk_desc_bit != ChunkDescriptor::DATA
                 && chunk_desc_bit != ChunkDescriptor::DEBUG) {
             LOG_ERROR("Invalid msg; invalid chunk descriptor {1}",
                       static_cast<int>(chunk_desc));
-            LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+            LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
             throw message_serialization_error {
                 lth_loc::translate("invalid msg: invalid chunk descriptor") };
         }
 
-        auto chunk_size = deserialize<uint32_t>(4, next_itr);
+        auto chunk_size = readSize(next_ptr);
         auto missing_bytes = still_to_parse - CHUNK_METADATA_SIZE;
         if (chunk_size > missing_bytes) {
             // TODO(ale): deal with locale & plural
@@ -330,19 +742,18 @@ void Message::parseMessage(const std::string& transport_msg) {
                           ChunkDescriptor::names[chunk_desc_bit], chunk_size,
                           missing_bytes);
             }
-            LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg);
+            LOG_TRACE("Invalid msg content (unserialized): '{1}'", transport_msg.to_string());
             throw message_serialization_error {
                 lth_loc::translate("invalid msg: missing chunk content") };
         }
 
-        auto chunk_content = deserialize<std::string>(chunk_size, next_itr);
-        MessageChunk chunk { chunk_desc, chunk_size, chunk_content };
+        ChunkView chunk { chunk_desc, readContent(chunk_size, next_ptr) };
 
         if (chunk_desc_bit == ChunkDescriptor::DATA) {
             if (hasData()) {
                 LOG_ERROR("Invalid msg; multiple data chunks");
                 LOG_TRACE("Invalid msg content (unserialized): '{1}'",
-                          transport_msg);
+                          transport_msg.to_string());
                 throw message_serialization_error {
                     lth_loc::translate("invalid msg: multiple data chunks") };
             }
@@ -364,52 +775,11 @@ void Message::parseMessage(const std::string& transport_msg) {
             LOG_ERROR("Failed to parse the entire msg (ignoring last {1} bytes); "
                       "the msg will be processed anyway", still_to_parse);
         }
-        LOG_TRACE("Msg content (unserialized): '{1}'", transport_msg);
+        LOG_TRACE("Msg content (unserialized): '{1}'", transport_msg.to_string());
     }
 
     version_ = msg_version;
-    envelope_chunk_ = MessageChunk  { envelope_desc,
-                                      envelope_size,
-                                      envelope_content };
-}
-
-void Message::validateVersion(const uint8_t& version) const {
-    auto found = std::find(SUPPORTED_VERSIONS.begin(), SUPPORTED_VERSIONS.end(),
-                           version);
-    if (found == SUPPORTED_VERSIONS.end()) {
-        auto version_num = static_cast<int>(version);
-        LOG_ERROR("Unsupported message version: {1}", version_num);
-        throw unsupported_version_error {
-            lth_loc::format("unsupported message version: {1}", version_num) };
-    }
-}
-
-void Message::validateChunk(const MessageChunk& chunk) const {
-    auto desc_bit = chunk.descriptor & ChunkDescriptor::TYPE_MASK;
-
-    if (ChunkDescriptor::names.find(desc_bit) == ChunkDescriptor::names.end()) {
-        LOG_ERROR("Unknown chunk descriptor: {1}",
-                  static_cast<int>(chunk.descriptor));
-        throw invalid_chunk_error { lth_loc::translate("unknown descriptor") };
-    }
-
-    if (chunk.size != static_cast<uint32_t>(chunk.content.size())) {
-        // TODO(ale): deal with locale and plural
-        if (chunk.size == 1) {
-            assert(chunk.content.size() != 1);
-            LOG_ERROR("Incorrect size for {1} chunk; declared {2} byte, got {3} bytes",
-                      ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
-        } else {
-            if (chunk.content.size() == 1) {
-                LOG_ERROR("Incorrect size for {1} chunk; declared {2} bytes, got {3} byte",
-                          ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
-            } else {
-                LOG_ERROR("Incorrect size for {1} chunk; declared {2} bytes, got {3} bytes",
-                          ChunkDescriptor::names[desc_bit], chunk.size, chunk.content.size());
-            }
-        }
-        throw invalid_chunk_error { lth_loc::translate("invalid size") };
-    }
+    envelope_chunk_ = ChunkView { envelope_desc, envelope_content };
 }
 
 }  // namespace v1
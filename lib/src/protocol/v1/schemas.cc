@@ -1,9 +1,113 @@
 #include <cpp-pcp-client/protocol/v1/schemas.hpp>
 
+#include <boost/utility/string_ref.hpp>
+
+#include <rapidjson/document.h>
+
 namespace PCPClient {
 namespace v1 {
 namespace Protocol {
 
+//
+// Native validators
+//
+
+// NB: each validator must accept exactly the data accepted by the
+//     constraints of its schema, as interpreted by valijson (that's
+//     verified by the schemas unit tests). Note that a property that
+//     is not listed in the schema is invalid, as the schema has no
+//     additionalProperties constraint.
+
+static bool validateEnvelope(const lth_jc::JsonContainer& data) {
+    enum : unsigned { ID = 1, MESSAGE_TYPE = 2, EXPIRES = 4,
+                      TARGETS = 8, SENDER = 16, REQUIRED = 31 };
+    const auto& envelope = data.getRaw();
+    unsigned found { 0 };
+
+    if (!envelope.IsObject())
+        return false;
+
+    for (auto itr = envelope.MemberBegin(); itr != envelope.MemberEnd(); ++itr) {
+        boost::string_ref name { itr->name.GetString(), itr->name.GetStringLength() };
+        const auto& value = itr->value;
+
+        if (name == "id") {
+            found |= ID;
+        } else if (name == "message_type") {
+            found |= MESSAGE_TYPE;
+        } else if (name == "expires") {
+            found |= EXPIRES;
+        } else if (name == "targets") {
+            if (!value.IsArray())
+                return false;
+            found |= TARGETS;
+            continue;
+        } else if (name == "sender") {
+            found |= SENDER;
+        } else if (name == "destination_report") {
+            if (!value.IsBool())
+                return false;
+            continue;
+        } else if (name != "in-reply-to") {
+            return false;
+        }
+
+        // All the other listed properties are strings
+        if (!value.IsString())
+            return false;
+    }
+
+    return found == REQUIRED;
+}
+
+static bool validateDebug(const lth_jc::JsonContainer& data) {
+    const auto& debug = data.getRaw();
+    bool found { false };
+
+    if (!debug.IsObject())
+        return false;
+
+    for (auto itr = debug.MemberBegin(); itr != debug.MemberEnd(); ++itr) {
+        boost::string_ref name { itr->name.GetString(), itr->name.GetStringLength() };
+
+        if (name != "hops" || !itr->value.IsArray())
+            return false;
+        found = true;
+    }
+
+    return found;
+}
+
+static bool validateDebugItem(const lth_jc::JsonContainer& data) {
+    enum : unsigned { SERVER = 1, TIME = 2, REQUIRED = 3 };
+    const auto& item = data.getRaw();
+    unsigned found { 0 };
+
+    if (!item.IsObject())
+        return false;
+
+    for (auto itr = item.MemberBegin(); itr != item.MemberEnd(); ++itr) {
+        boost::string_ref name { itr->name.GetString(), itr->name.GetStringLength() };
+
+        if (name == "server") {
+            found |= SERVER;
+        } else if (name == "time") {
+            found |= TIME;
+        } else if (name != "stage") {
+            return false;
+        }
+
+        if (!itr->value.IsString())
+            return false;
+    }
+
+    return found == REQUIRED;
+}
+
+//
+// Schemas
+//
+
 // HERE(ale): this must be kept up to date with
 // https://github.com/puppetlabs/pcp-specifications
 
@@ -17,6 +121,7 @@ Schema EnvelopeSchema() {
     schema.addConstraint("sender", TypeConstraint::String, true);
     schema.addConstraint("destination_report", TypeConstraint::Bool, false);
     schema.addConstraint("in-reply-to", TypeConstraint::String, false);
+    schema.setNativeValidator(validateEnvelope);
     return schema;
 }
 
@@ -75,6 +180,7 @@ Schema VersionErrorSchema() {
 Schema DebugSchema() {
     Schema schema { DEBUG_SCHEMA_NAME, ContentType::Json };
     schema.addConstraint("hops", TypeConstraint::Array, true);
+    schema.setNativeValidator(validateDebug);
     return schema;
 }
 
@@ -83,6 +189,7 @@ Schema DebugItemSchema() {
     schema.addConstraint("server", TypeConstraint::String, true);
     schema.addConstraint("time", TypeConstraint::String, true);
     schema.addConstraint("stage", TypeConstraint::String, false);
+    schema.setNativeValidator(validateDebugItem);
     return schema;
 }
 
@@ -23,5 +23,45 @@ uint32_t getHostNumber(const uint32_t& number)
 
 #endif  // BOOST_ENDIAN_LITTLE_BYTE
 
+//
+// FrameBuffers
+//
+
+FrameBuffers::FrameBuffers(uint8_t version)
+        : version_ { version },
+          chunks_ {} {
+}
+
+void FrameBuffers::addChunk(uint8_t descriptor, boost::string_ref content) {
+    ChunkHeader header;
+    writeChunkHeader(descriptor, static_cast<uint32_t>(content.size()), header.data());
+    chunks_.emplace_back(header, content);
+}
+
+std::vector<boost::string_ref> FrameBuffers::getBuffers() const {
+    std::vector<boost::string_ref> buffers {};
+    buffers.reserve(1 + 2 * chunks_.size());
+    buffers.emplace_back(reinterpret_cast<const char*>(&version_), 1);
+
+    for (const auto& chunk : chunks_) {
+        buffers.emplace_back(reinterpret_cast<const char*>(chunk.first.data()),
+                             chunk.first.size());
+
+        if (!chunk.second.empty())
+            buffers.push_back(chunk.second);
+    }
+
+    return buffers;
+}
+
+size_t FrameBuffers::size() const {
+    size_t size { 1 };
+
+    for (const auto& chunk : chunks_)
+        size += getSerializedChunkSize(chunk.second.size());
+
+    return size;
+}
+
 }  // namespace v1
 }  // namespace PCPClient
@@ -0,0 +1,212 @@
+#include <cpp-pcp-client/protocol/v2/envelope_template.hpp>
+
+#include "util/base64.hpp"
+#include "util/json_scan.hpp"
+
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+
+#include <cstdio>  // snprintf
+
+namespace PCPClient {
+namespace v2 {
+
+namespace lth_jc = leatherman::json_container;
+
+//
+// Constants
+//
+
+static const boost::string_ref ID_PREFIX { "{\"id\":\"" };
+static const boost::string_ref IN_REPLY_TO_PREFIX { "\",\"in_reply_to\":\"" };
+static const boost::string_ref FIELDS_PREFIX { "\"," };
+static const boost::string_ref DATA_KEY { ",\"data\":" };
+
+//
+// JSON string escaping
+//
+
+static size_t getEscapedSize(char c) {
+    switch (c) {
+        case '"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            return 2;
+        default:
+            return static_cast<unsigned char>(c) < 0x20 ? 6 : 1;
+    }
+}
+
+static size_t getEscapedSize(boost::string_ref txt) {
+    size_t size { 0 };
+
+    for (auto c : txt)
+        size += getEscapedSize(c);
+
+    return size;
+}
+
+static void appendEscaped(std::string& buffer, boost::string_ref txt) {
+    for (auto c : txt) {
+        switch (c) {
+            case '"':  buffer.append("\\\"", 2); break;
+            case '\\': buffer.append("\\\\", 2); break;
+            case '\b': buffer.append("\\b", 2); break;
+            case '\f': buffer.append("\\f", 2); break;
+            case '\n': buffer.append("\\n", 2); break;
+            case '\r': buffer.append("\\r", 2); break;
+            case '\t': buffer.append("\\t", 2); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x",
+                                  static_cast<unsigned int>(c));
+                    buffer.append(code, 6);
+                } else {
+                    buffer.push_back(c);
+                }
+        }
+    }
+}
+
+std::string quoteJsonString(boost::string_ref txt) {
+    std::string quoted {};
+    quoted.reserve(getEscapedSize(txt) + 2);
+    quoted.push_back('"');
+    appendEscaped(quoted, txt);
+    quoted.push_back('"');
+    return quoted;
+}
+
+//
+// Writer
+//
+
+using StringWriter = rapidjson::Writer<Util::StringOutputStream>;
+
+static void writeEntry(StringWriter& writer,
+                       boost::string_ref key,
+                       boost::string_ref value) {
+    writer.String(key.data(), static_cast<rapidjson::SizeType>(key.size()));
+    writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+}
+
+//
+// EnvelopeTemplate
+//
+
+EnvelopeTemplate::EnvelopeTemplate(const std::string& target,
+                                   const std::string& message_type,
+                                   const std::string& sender)
+        : message_type_ { message_type },
+          fields_ {} {
+    Util::StringOutputStream stream { fields_ };
+    StringWriter writer { stream };
+
+    writer.StartObject();
+    writeEntry(writer, "message_type", message_type);
+    writeEntry(writer, "target", target);
+    writeEntry(writer, "sender", sender);
+    writer.EndObject();
+
+    // Drop the braces; the entries follow id and in_reply_to
+    fields_ = fields_.substr(1, fields_.size() - 2);
+    fields_.append(DATA_KEY.data(), DATA_KEY.size());
+}
+
+const std::string& EnvelopeTemplate::getMessageType() const {
+    return message_type_;
+}
+
+size_t EnvelopeTemplate::getMessageSize(boost::string_ref id,
+                                        boost::string_ref in_reply_to,
+                                        boost::string_ref data_txt) const {
+    auto size = ID_PREFIX.size() + id.size()
+                + FIELDS_PREFIX.size() + fields_.size()
+                + data_txt.size() + 1;
+
+    if (!in_reply_to.empty())
+        size += IN_REPLY_TO_PREFIX.size() + getEscapedSize(in_reply_to);
+
+    return size;
+}
+
+void EnvelopeTemplate::renderOn(std::string& buffer,
+                                boost::string_ref id,
+                                boost::string_ref in_reply_to,
+                                boost::string_ref data_txt) const {
+    renderHeadOn(buffer, id, in_reply_to);
+    buffer.append(data_txt.data(), data_txt.size());
+    buffer.push_back('}');
+}
+
+std::string EnvelopeTemplate::render(boost::string_ref id,
+                                     boost::string_ref in_reply_to,
+                                     boost::string_ref data_txt) const {
+    std::string msg {};
+    msg.reserve(getMessageSize(id, in_reply_to, data_txt));
+    renderOn(msg, id, in_reply_to, data_txt);
+    return msg;
+}
+
+void EnvelopeTemplate::renderJsonOn(std::string& buffer,
+                                    boost::string_ref id,
+                                    boost::string_ref in_reply_to,
+                                    const lth_jc::JsonContainer& data) const {
+    renderHeadOn(buffer, id, in_reply_to);
+    Util::StringOutputStream stream { buffer };
+    StringWriter writer { stream };
+    data.getRaw().Accept(writer);
+    buffer.push_back('}');
+}
+
+std::string EnvelopeTemplate::renderJson(boost::string_ref id,
+                                         boost::string_ref in_reply_to,
+                                         const lth_jc::JsonContainer& data) const {
+    std::string msg {};
+    renderJsonOn(msg, id, in_reply_to, data);
+    return msg;
+}
+
+void EnvelopeTemplate::renderBinaryOn(std::string& buffer,
+                                      boost::string_ref id,
+                                      boost::string_ref in_reply_to,
+                                      boost::string_ref binary_data) const {
+    // NB: the base64 characters need no JSON escaping
+    renderHeadOn(buffer, id, in_reply_to);
+    buffer.push_back('"');
+    Util::appendBase64(buffer, binary_data);
+    buffer.append("\"}", 2);
+}
+
+std::string EnvelopeTemplate::renderBinary(boost::string_ref id,
+                                           boost::string_ref in_reply_to,
+                                           boost::string_ref binary_data) const {
+    std::string msg {};
+    msg.reserve(getMessageSize(id, in_reply_to, "")
+                + Util::getBase64Size(binary_data.size()) + 2);
+    renderBinaryOn(msg, id, in_reply_to, binary_data);
+    return msg;
+}
+
+void EnvelopeTemplate::renderHeadOn(std::string& buffer,
+                                    boost::string_ref id,
+                                    boost::string_ref in_reply_to) const {
+    buffer.assign(ID_PREFIX.data(), ID_PREFIX.size());
+    buffer.append(id.data(), id.size());
+
+    if (!in_reply_to.empty()) {
+        buffer.append(IN_REPLY_TO_PREFIX.data(), IN_REPLY_TO_PREFIX.size());
+        appendEscaped(buffer, in_reply_to);
+    }
+
+    buffer.append(FIELDS_PREFIX.data(), FIELDS_PREFIX.size());
+    buffer.append(fields_);
+}
+
+}  // namespace v2
+}  // namespace PCPClient
@@ -1,14 +1,20 @@
 #include <cpp-pcp-client/protocol/v2/message.hpp>
 #include <cpp-pcp-client/protocol/v2/schemas.hpp>
+#include <cpp-pcp-client/protocol/v2/msgpack.hpp>
+
+#include "util/base64.hpp"
 
 #define LEATHERMAN_LOGGING_NAMESPACE CPP_PCP_CLIENT_LOGGING_PREFIX".message"
 
 #include <leatherman/logging/logging.hpp>
 
+#include <rapidjson/document.h>
+
 // TODO(ale): disable assert() once we're confident with the code...
 // To disable assert()
 // #define NDEBUG
 #include <cassert>
+#include <utility>  // move
 
 namespace PCPClient {
 namespace v2 {
@@ -28,13 +34,26 @@ Message::Message(const std::string& transport_msg) :
     Message(lth_jc::JsonContainer(transport_msg))
 { }
 
-static bool validate_data(lth_jc::JsonContainer const& envelope, Validator const& validator)
+Message::Message(lth_jc::JsonContainer envelope, boost::string_ref binary_data)
+    : envelope_(std::move(envelope))
 {
-    auto message_type = envelope.get<std::string>("message_type");
-    auto data = envelope.get<lth_jc::JsonContainer>("data");
+    envelope_.set<std::string>("data", Util::encodeBase64(binary_data));
+}
 
+Message Message::fromMessagePack(const std::string& transport_msg)
+{
+    return Message { messagePackToJson(transport_msg) };
+}
+
+static bool validate_data(lth_jc::JsonContainer const& envelope,
+                          std::string const& message_type,
+                          Validator const& validator,
+                          lth_jc::JsonContainer& data)
+{
     try {
-        validator.validate(data, message_type);
+        auto envelope_data = envelope.get<lth_jc::JsonContainer>("data");
+        validator.validate(envelope_data, message_type);
+        data = envelope_data;
         return true;
     } catch (leatherman::json_container::data_type_error& e) {
         LOG_DEBUG("Invalid data in message {1}: {2}", envelope.get<std::string>("id"), e.what());
@@ -47,12 +66,102 @@ static bool validate_data(lth_jc::JsonContainer const& envelope, Validator const
 ParsedChunks Message::getParsedChunks(const Validator& validator) const {
     validator.validate(envelope_, Protocol::ENVELOPE_SCHEMA_NAME);
 
+    EnvelopeFields envelope_fields {
+        envelope_.get<std::string>("id"),
+        envelope_.get<std::string>("message_type"),
+        envelope_.includes("sender") ? envelope_.get<std::string>("sender") : "" };
+    return getParsedChunks(validator, envelope_fields);
+}
+
+EnvelopeFields Message::validateEnvelope(const std::string& transport_msg,
+                                         const Validator& validator,
+                                         Util::MonotonicBufferResource* arena)
+{
+    std::vector<PropertyCapture> captures { { "id", "" },
+                                            { "message_type", "" },
+                                            { "sender", "" } };
+    validator.validateText(transport_msg, Protocol::ENVELOPE_SCHEMA_NAME,
+                           &captures, arena);
+
+    return EnvelopeFields { std::move(captures[0].value),
+                            std::move(captures[1].value),
+                            std::move(captures[2].value) };
+}
+
+static bool isBinarySchema(const Validator& validator,
+                           const std::string& message_type)
+{
+    try {
+        return validator.getSchemaContentType(message_type) == ContentType::Binary;
+    } catch (const schema_not_found_error&) {
+        // Reported when validating the data
+        return false;
+    }
+}
+
+static bool decode_binary_data(lth_jc::JsonContainer const& envelope,
+                               std::string& binary_data)
+{
+    // NB: the base64 text is read in place, as it may be large
+    const auto& envelope_data = envelope.getRaw()["data"];
+
+    if (!envelope_data.IsString()) {
+        LOG_DEBUG("Invalid data in message {1}: binary data must be a base64 string",
+                  envelope.get<std::string>("id"));
+        return false;
+    }
+
+    boost::string_ref data_txt { envelope_data.GetString(),
+                                 envelope_data.GetStringLength() };
+
+    if (!Util::decodeBase64(data_txt, binary_data)) {
+        LOG_DEBUG("Invalid data in message {1}: invalid base64 text",
+                  envelope.get<std::string>("id"));
+        return false;
+    }
+
+    return true;
+}
+
+ParsedChunks Message::getParsedChunks(const Validator& validator,
+                                      const EnvelopeFields& envelope_fields,
+                                      bool lazy_data) const {
+    if (envelope_.includes("data")
+            && isBinarySchema(validator, envelope_fields.message_type)) {
+        // Binary data is decoded right away; it's never lazy
+        std::string binary_data {};
+
+        if (decode_binary_data(envelope_, binary_data)) {
+            return ParsedChunks(envelope_, std::move(binary_data),
+                                std::vector<lth_jc::JsonContainer>{}, 0);
+        } else {
+            return ParsedChunks(envelope_, true,
+                                std::vector<lth_jc::JsonContainer>{}, 0);
+        }
+    }
+
     if (envelope_.includes("data")) {
-        if (validate_data(envelope_, validator)) {
-            return ParsedChunks(envelope_, envelope_.get<lth_jc::JsonContainer>("data"),
+        if (lazy_data) {
+            // The data is extracted from the envelope of the
+            // ParsedChunks instance
+            auto message_type = envelope_fields.message_type;
+            ParsedChunks::DataParser data_parser {
+                [&validator, message_type](lth_jc::JsonContainer const& envelope,
+                                           lth_jc::JsonContainer& data) {
+                    return validate_data(envelope, message_type, validator, data);
+                } };
+            return ParsedChunks(envelope_, std::move(data_parser),
                 std::vector<lth_jc::JsonContainer>{}, 0);
+        }
+
+        lth_jc::JsonContainer data {};
+
+        if (validate_data(envelope_, envelope_fields.message_type, validator, data)) {
+            return ParsedChunks(envelope_, std::move(data),
+                                std::vector<lth_jc::JsonContainer>{}, 0);
         } else {
-            return ParsedChunks(envelope_, true, std::vector<lth_jc::JsonContainer>{}, 0);
+            return ParsedChunks(envelope_, true,
+                                std::vector<lth_jc::JsonContainer>{}, 0);
         }
     } else {
         return ParsedChunks(envelope_, std::vector<lth_jc::JsonContainer>{}, 0);
@@ -71,5 +180,9 @@ std::string Message::toString() const {
     return envelope_.toString();
 }
 
+std::string Message::toMessagePack() const {
+    return jsonToMessagePack(envelope_);
+}
+
 }  // namespace v2
 }  // namespace PCPClient
@@ -0,0 +1,417 @@
+#include <cpp-pcp-client/protocol/v2/msgpack.hpp>
+
+#include "util/json_scan.hpp"
+
+#include <leatherman/locale/locale.hpp>
+
+#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+
+#include <cmath>    // isfinite
+#include <cstdint>
+#include <cstdlib>  // strtod
+#include <cstring>  // memcpy
+#include <vector>
+
+namespace PCPClient {
+namespace v2 {
+
+namespace lth_jc  = leatherman::json_container;
+namespace lth_loc = leatherman::locale;
+
+//
+// Format
+//
+
+// Format tags; the fix formats store the value or size in their
+// low bits
+static const uint8_t TAG_POSITIVE_FIXINT_MAX { 0x7f };
+static const uint8_t TAG_FIXMAP   { 0x80 };
+static const uint8_t TAG_FIXARRAY { 0x90 };
+static const uint8_t TAG_FIXSTR   { 0xa0 };
+static const uint8_t TAG_NIL      { 0xc0 };
+static const uint8_t TAG_FALSE    { 0xc2 };
+static const uint8_t TAG_TRUE     { 0xc3 };
+static const uint8_t TAG_FLOAT32  { 0xca };
+static const uint8_t TAG_FLOAT64  { 0xcb };
+static const uint8_t TAG_UINT8    { 0xcc };
+static const uint8_t TAG_UINT16   { 0xcd };
+static const uint8_t TAG_UINT32   { 0xce };
+static const uint8_t TAG_UINT64   { 0xcf };
+static const uint8_t TAG_INT8     { 0xd0 };
+static const uint8_t TAG_INT16    { 0xd1 };
+static const uint8_t TAG_INT32    { 0xd2 };
+static const uint8_t TAG_INT64    { 0xd3 };
+static const uint8_t TAG_STR8     { 0xd9 };
+static const uint8_t TAG_STR16    { 0xda };
+static const uint8_t TAG_STR32    { 0xdb };
+static const uint8_t TAG_ARRAY16  { 0xdc };
+static const uint8_t TAG_ARRAY32  { 0xdd };
+static const uint8_t TAG_MAP16    { 0xde };
+static const uint8_t TAG_MAP32    { 0xdf };
+static const uint8_t TAG_NEGATIVE_FIXINT_MIN { 0xe0 };
+
+// The largest header of an array or map
+static const std::size_t MAX_CONTAINER_HEADER_SIZE { 5 };
+
+// Maximum nesting of the decoded values, so that the recursion of
+// the decoder is bounded
+static const int MAX_DEPTH { 128 };
+
+template <typename T>
+static void storeBigEndian(char* out, T value) {
+    for (auto idx = sizeof(T); idx-- > 0; value = static_cast<T>(value >> 8))
+        out[idx] = static_cast<char>(value & 0xff);
+}
+
+//
+// Encoding
+//
+
+// A rapidjson handler that writes the MessagePack encoding of the
+// events of a Reader, or of a Document traversal, on a string.
+// As the size of arrays and maps is known at their end, room for the
+// largest header is left at their start; the header is then written
+// and the content moved back over the unused bytes.
+class MessagePackWriter {
+  public:
+    explicit MessagePackWriter(std::string& buffer)
+            : buffer_(buffer),
+              container_offsets_ {} {
+    }
+
+    bool Null() { putTag(TAG_NIL); return true; }
+    bool Bool(bool b) { putTag(b ? TAG_TRUE : TAG_FALSE); return true; }
+    bool Int(int i) { return Int64(i); }
+    bool Uint(unsigned u) { return Uint64(u); }
+
+    bool Int64(std::int64_t i) {
+        if (i >= 0)
+            return Uint64(static_cast<std::uint64_t>(i));
+
+        if (i >= -32)
+            putTag(static_cast<uint8_t>(i));
+        else if (i >= INT8_MIN)
+            put(TAG_INT8, static_cast<uint8_t>(i));
+        else if (i >= INT16_MIN)
+            put(TAG_INT16, static_cast<uint16_t>(i));
+        else if (i >= INT32_MIN)
+            put(TAG_INT32, static_cast<uint32_t>(i));
+        else
+            put(TAG_INT64, static_cast<std::uint64_t>(i));
+
+        return true;
+    }
+
+    bool Uint64(std::uint64_t u) {
+        if (u <= TAG_POSITIVE_FIXINT_MAX)
+            putTag(static_cast<uint8_t>(u));
+        else if (u <= UINT8_MAX)
+            put(TAG_UINT8, static_cast<uint8_t>(u));
+        else if (u <= UINT16_MAX)
+            put(TAG_UINT16, static_cast<uint16_t>(u));
+        else if (u <= UINT32_MAX)
+            put(TAG_UINT32, static_cast<uint32_t>(u));
+        else
+            put(TAG_UINT64, u);
+
+        return true;
+    }
+
+    bool Double(double d) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        put(TAG_FLOAT64, bits);
+        return true;
+    }
+
+    // NB: only called with kParseNumbersAsStringsFlag, not used
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool) {
+        return Double(std::strtod(std::string(str, length).c_str(), nullptr));
+    }
+
+    bool String(const char* str, rapidjson::SizeType length, bool) {
+        if (length < 32)
+            putTag(static_cast<uint8_t>(TAG_FIXSTR | length));
+        else if (length <= UINT8_MAX)
+            put(TAG_STR8, static_cast<uint8_t>(length));
+        else if (length <= UINT16_MAX)
+            put(TAG_STR16, static_cast<uint16_t>(length));
+        else
+            put(TAG_STR32, static_cast<uint32_t>(length));
+
+        buffer_.append(str, length);
+        return true;
+    }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+        return String(str, length, copy);
+    }
+
+    bool StartObject() { startContainer(); return true; }
+
+    bool EndObject(rapidjson::SizeType size) {
+        endContainer(size, TAG_FIXMAP, TAG_MAP16, TAG_MAP32);
+        return true;
+    }
+
+    bool StartArray() { startContainer(); return true; }
+
+    bool EndArray(rapidjson::SizeType size) {
+        endContainer(size, TAG_FIXARRAY, TAG_ARRAY16, TAG_ARRAY32);
+        return true;
+    }
+
+  private:
+    std::string& buffer_;
+
+    // The offsets of the headers of the open arrays and maps
+    std::vector<std::size_t> container_offsets_;
+
+    void putTag(uint8_t tag) {
+        buffer_.push_back(static_cast<char>(tag));
+    }
+
+    template <typename T>
+    void put(uint8_t tag, T value) {
+        char bytes[1 + sizeof(T)];
+        bytes[0] = static_cast<char>(tag);
+        storeBigEndian(bytes + 1, value);
+        buffer_.append(bytes, sizeof(bytes));
+    }
+
+    void startContainer() {
+        container_offsets_.push_back(buffer_.size());
+        buffer_.append(MAX_CONTAINER_HEADER_SIZE, '\0');
+    }
+
+    void endContainer(rapidjson::SizeType size,
+                      uint8_t fix_tag,
+                      uint8_t tag_16,
+                      uint8_t tag_32) {
+        auto offset = container_offsets_.back();
+        container_offsets_.pop_back();
+        auto header = &buffer_[offset];
+        std::size_t header_size;
+
+        if (size < 16) {
+            header[0] = static_cast<char>(fix_tag | size);
+            header_size = 1;
+        } else if (size <= UINT16_MAX) {
+            header[0] = static_cast<char>(tag_16);
+            storeBigEndian(header + 1, static_cast<uint16_t>(size));
+            header_size = 3;
+        } else {
+            header[0] = static_cast<char>(tag_32);
+            storeBigEndian(header + 1, static_cast<uint32_t>(size));
+            header_size = 5;
+        }
+
+        if (header_size < MAX_CONTAINER_HEADER_SIZE)
+            buffer_.erase(offset + header_size,
+                          MAX_CONTAINER_HEADER_SIZE - header_size);
+    }
+};
+
+std::string jsonToMessagePack(boost::string_ref json_txt) {
+    std::string msgpack {};
+    msgpack.reserve(json_txt.size());
+    MessagePackWriter handler { msgpack };
+    Util::JsonTextStream stream { json_txt };
+    rapidjson::Reader reader {};
+    reader.Parse<0>(stream, handler);
+
+    if (reader.HasParseError()) {
+        throw lth_jc::data_parse_error {
+            lth_loc::format("invalid JSON text at offset {1}",
+                            reader.GetErrorOffset()) };
+    }
+
+    return msgpack;
+}
+
+std::string jsonToMessagePack(const lth_jc::JsonContainer& json) {
+    std::string msgpack {};
+    MessagePackWriter handler { msgpack };
+    json.getRaw().Accept(handler);
+    return msgpack;
+}
+
+//
+// Decoding
+//
+
+// Writes the JSON text of a MessagePack value on a string, with a
+// rapidjson Writer, by recursive descent
+class MessagePackDecoder {
+  public:
+    MessagePackDecoder(boost::string_ref msgpack, std::string& buffer)
+            : begin_ { reinterpret_cast<const uint8_t*>(msgpack.data()) },
+              current_ { begin_ },
+              end_ { begin_ + msgpack.size() },
+              stream_ { buffer },
+              writer_ { stream_ } {
+    }
+
+    void decode() {
+        decodeValue(0);
+
+        if (current_ != end_)
+            fail(lth_loc::translate("unexpected bytes after the value"));
+    }
+
+  private:
+    const uint8_t* begin_;
+    const uint8_t* current_;
+    const uint8_t* end_;
+    Util::StringOutputStream stream_;
+    rapidjson::Writer<Util::StringOutputStream> writer_;
+
+    void fail(const std::string& reason) const {
+        throw lth_jc::data_parse_error {
+            lth_loc::format("invalid MessagePack data at offset {1}: {2}",
+                            current_ - begin_, reason) };
+    }
+
+    void require(std::size_t num_bytes) const {
+        if (static_cast<std::size_t>(end_ - current_) < num_bytes)
+            fail(lth_loc::translate("truncated value"));
+    }
+
+    template <typename T>
+    T take() {
+        require(sizeof(T));
+        T value { 0 };
+
+        for (std::size_t idx = 0; idx < sizeof(T); idx++)
+            value = static_cast<T>((value << 8) | *current_++);
+
+        return value;
+    }
+
+    void decodeValue(int depth) {
+        if (depth > MAX_DEPTH)
+            fail(lth_loc::translate("too many nesting levels"));
+
+        auto tag = take<uint8_t>();
+
+        if (tag <= TAG_POSITIVE_FIXINT_MAX) {
+            writer_.Uint(tag);
+        } else if (tag >= TAG_NEGATIVE_FIXINT_MIN) {
+            writer_.Int(static_cast<int8_t>(tag));
+        } else if ((tag & 0xf0) == TAG_FIXMAP) {
+            decodeMap(tag & 0x0f, depth);
+        } else if ((tag & 0xf0) == TAG_FIXARRAY) {
+            decodeArray(tag & 0x0f, depth);
+        } else if ((tag & 0xe0) == TAG_FIXSTR) {
+            decodeString(tag & 0x1f);
+        } else {
+            switch (tag) {
+                case TAG_NIL:     writer_.Null(); break;
+                case TAG_FALSE:   writer_.Bool(false); break;
+                case TAG_TRUE:    writer_.Bool(true); break;
+                case TAG_FLOAT32: decodeFloat32(); break;
+                case TAG_FLOAT64: decodeFloat64(); break;
+                case TAG_UINT8:   writer_.Uint(take<uint8_t>()); break;
+                case TAG_UINT16:  writer_.Uint(take<uint16_t>()); break;
+                case TAG_UINT32:  writer_.Uint(take<uint32_t>()); break;
+                case TAG_UINT64:  writer_.Uint64(take<std::uint64_t>()); break;
+                case TAG_INT8:    writer_.Int(static_cast<int8_t>(take<uint8_t>())); break;
+                case TAG_INT16:   writer_.Int(static_cast<int16_t>(take<uint16_t>())); break;
+                case TAG_INT32:   writer_.Int(static_cast<int32_t>(take<uint32_t>())); break;
+                case TAG_INT64:   writer_.Int64(static_cast<std::int64_t>(take<std::uint64_t>())); break;
+                case TAG_STR8:    decodeString(take<uint8_t>()); break;
+                case TAG_STR16:   decodeString(take<uint16_t>()); break;
+                case TAG_STR32:   decodeString(take<uint32_t>()); break;
+                case TAG_ARRAY16: decodeArray(take<uint16_t>(), depth); break;
+                case TAG_ARRAY32: decodeArray(take<uint32_t>(), depth); break;
+                case TAG_MAP16:   decodeMap(take<uint16_t>(), depth); break;
+                case TAG_MAP32:   decodeMap(take<uint32_t>(), depth); break;
+                default:
+                    // bin, ext and the unused tag
+                    current_--;
+                    fail(lth_loc::translate("type not representable as JSON"));
+            }
+        }
+    }
+
+    void decodeString(uint32_t size) {
+        require(size);
+        writer_.String(reinterpret_cast<const char*>(current_), size);
+        current_ += size;
+    }
+
+    void decodeKey() {
+        auto tag = take<uint8_t>();
+
+        if ((tag & 0xe0) == TAG_FIXSTR) {
+            decodeString(tag & 0x1f);
+        } else if (tag == TAG_STR8) {
+            decodeString(take<uint8_t>());
+        } else if (tag == TAG_STR16) {
+            decodeString(take<uint16_t>());
+        } else if (tag == TAG_STR32) {
+            decodeString(take<uint32_t>());
+        } else {
+            current_--;
+            fail(lth_loc::translate("map keys must be strings"));
+        }
+    }
+
+    // NB: the sizes are not trusted for reserving memory; each entry
+    //     takes at least a byte, so a bad size is reported as a
+    //     truncated value
+    void decodeArray(uint32_t size, int depth) {
+        writer_.StartArray();
+
+        for (uint32_t idx = 0; idx < size; idx++)
+            decodeValue(depth + 1);
+
+        writer_.EndArray(size);
+    }
+
+    void decodeMap(uint32_t size, int depth) {
+        writer_.StartObject();
+
+        for (uint32_t idx = 0; idx < size; idx++) {
+            decodeKey();
+            decodeValue(depth + 1);
+        }
+
+        writer_.EndObject(size);
+    }
+
+    void decodeFloat32() {
+        auto bits = take<uint32_t>();
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        writeDouble(f);
+    }
+
+    void decodeFloat64() {
+        auto bits = take<std::uint64_t>();
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        writeDouble(d);
+    }
+
+    void writeDouble(double d) {
+        if (!std::isfinite(d))
+            fail(lth_loc::translate("infinite or NaN float"));
+
+        writer_.Double(d);
+    }
+};
+
+std::string messagePackToJson(boost::string_ref msgpack) {
+    std::string json_txt {};
+    // NB: JSON text is usually larger than its MessagePack encoding
+    json_txt.reserve(msgpack.size() + msgpack.size() / 4);
+    MessagePackDecoder decoder { msgpack, json_txt };
+    decoder.decode();
+    return json_txt;
+}
+
+}  // namespace v2
+}  // namespace PCPClient
@@ -1,9 +1,54 @@
 #include <cpp-pcp-client/protocol/v2/schemas.hpp>
 
+#include <boost/utility/string_ref.hpp>
+
+#include <rapidjson/document.h>
+
 namespace PCPClient {
 namespace v2 {
 namespace Protocol {
 
+//
+// Native validators
+//
+
+// NB: the validator must accept exactly the data accepted by the
+//     constraints of its schema, as interpreted by valijson (that's
+//     verified by the schemas unit tests)
+
+static bool validateEnvelope(const lth_jc::JsonContainer& data) {
+    enum : unsigned { ID = 1, MESSAGE_TYPE = 2, REQUIRED = 3 };
+    const auto& envelope = data.getRaw();
+    unsigned found { 0 };
+
+    if (!envelope.IsObject())
+        return false;
+
+    for (auto itr = envelope.MemberBegin(); itr != envelope.MemberEnd(); ++itr) {
+        boost::string_ref name { itr->name.GetString(), itr->name.GetStringLength() };
+
+        if (name == "data") {
+            // Any type
+            continue;
+        } else if (name == "id") {
+            found |= ID;
+        } else if (name == "message_type") {
+            found |= MESSAGE_TYPE;
+        } else if (name != "target" && name != "sender" && name != "in_reply_to") {
+            return false;
+        }
+
+        if (!itr->value.IsString())
+            return false;
+    }
+
+    return found == REQUIRED;
+}
+
+//
+// Schemas
+//
+
 // HERE(ale): this must be kept up to date with
 // https://github.com/puppetlabs/pcp-specifications
 
@@ -15,6 +60,7 @@ Schema EnvelopeSchema() {
     schema.addConstraint("sender", TypeConstraint::String, false);
     schema.addConstraint("in_reply_to", TypeConstraint::String, false);
     schema.addConstraint("data", TypeConstraint::Any, false);
+    schema.setNativeValidator(validateEnvelope);
     return schema;
 }
 
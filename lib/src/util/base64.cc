@@ -0,0 +1,381 @@
+#include "util/base64.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#if defined(CPP_PCP_CLIENT_SIMD_BASE64) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+#define CPP_PCP_CLIENT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace PCPClient {
+namespace Util {
+
+static const char ALPHABET[] {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" };
+
+static const uint8_t INVALID_CHAR { 0xff };
+
+// The 6-bit values of the base64 characters, INVALID_CHAR for others
+struct DecodingTable {
+    uint8_t values[256];
+
+    DecodingTable() {
+        for (auto& value : values)
+            value = INVALID_CHAR;
+
+        for (uint8_t idx = 0; idx < 64; idx++)
+            values[static_cast<uint8_t>(ALPHABET[idx])] = idx;
+    }
+};
+
+static const uint8_t* getDecodingTable() {
+    static const DecodingTable table {};
+    return table.values;
+}
+
+//
+// Scalar code
+//
+
+// NB: the functions below process the remainder of the data, after
+//     the SIMD code; they advance src and out
+
+static void encodeScalar(const uint8_t*& src, const uint8_t* end, char*& out) {
+    for (; end - src >= 3; src += 3) {
+        uint32_t triplet = src[0] << 16 | src[1] << 8 | src[2];
+        *out++ = ALPHABET[triplet >> 18];
+        *out++ = ALPHABET[(triplet >> 12) & 0x3f];
+        *out++ = ALPHABET[(triplet >> 6) & 0x3f];
+        *out++ = ALPHABET[triplet & 0x3f];
+    }
+
+    if (end - src == 2) {
+        *out++ = ALPHABET[src[0] >> 2];
+        *out++ = ALPHABET[(src[0] & 0x03) << 4 | src[1] >> 4];
+        *out++ = ALPHABET[(src[1] & 0x0f) << 2];
+        *out++ = '=';
+    } else if (end - src == 1) {
+        *out++ = ALPHABET[src[0] >> 2];
+        *out++ = ALPHABET[(src[0] & 0x03) << 4];
+        *out++ = '=';
+        *out++ = '=';
+    }
+
+    src = end;
+}
+
+// Decode the quadruplets of characters in [src, end); return false in
+// case of invalid characters
+static bool decodeScalar(const uint8_t*& src, const uint8_t* end, uint8_t*& out) {
+    const auto table = getDecodingTable();
+
+    for (; src != end; src += 4) {
+        auto a = table[src[0]];
+        auto b = table[src[1]];
+        auto c = table[src[2]];
+        auto d = table[src[3]];
+
+        if ((a | b | c | d) & 0xc0)
+            return false;
+
+        uint32_t quadruplet = a << 18 | b << 12 | c << 6 | d;
+        *out++ = static_cast<uint8_t>(quadruplet >> 16);
+        *out++ = static_cast<uint8_t>(quadruplet >> 8);
+        *out++ = static_cast<uint8_t>(quadruplet);
+    }
+
+    return true;
+}
+
+#ifdef CPP_PCP_CLIENT_X86_SIMD
+
+// NB: the functions below are compiled for their instruction set,
+//     independently of the target of the build; they must only be
+//     called after checking the CPU (see getSimdLevel). SSSE3 is
+//     part of the SSE4.2 level.
+//     The vectorized codecs are the ones of Wojciech Muła and Alfred
+//     Klomp: encoding splits each 3 bytes into 4 6-bit indices with
+//     multiplications, then maps them to characters by range offsets
+//     looked up with pshufb; decoding validates and maps characters
+//     with nibble lookups, then packs the indices with multiply-adds.
+
+// Return the 16 characters of the 12 bytes in the low part of in
+__attribute__((target("sse4.2")))
+static inline __m128i encodeBlockSsse3(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                            7, 6, 8, 7, 10, 9, 11, 10));
+    const auto t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const auto t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const auto indices = _mm_or_si128(t1, t3);
+
+    // The offsets of the ranges A-Z, a-z, 0-9, + and /
+    const auto offsets = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                       -4, -4, -4, -4, -19, -16, 0, 0);
+    auto ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    ranges = _mm_sub_epi8(ranges, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, ranges));
+}
+
+__attribute__((target("sse4.2")))
+static void encodeSsse3(const uint8_t*& src, const uint8_t* end, char*& out) {
+    // NB: 16 bytes are loaded for 12 bytes of data
+    for (; end - src >= 16; src += 12, out += 16) {
+        const auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encodeBlockSsse3(in));
+    }
+}
+
+__attribute__((target("avx2,sse4.2")))
+static void encodeAvx2(const uint8_t*& src, const uint8_t* end, char*& out) {
+    const auto shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10,
+                                          1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10);
+    const auto offsets = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                          -4, -4, -4, -4, -19, -16, 0, 0,
+                                          65, 71, -4, -4, -4, -4, -4, -4,
+                                          -4, -4, -4, -4, -19, -16, 0, 0);
+
+    // NB: each 128-bit lane gets 12 bytes of data, loaded with 4
+    //     more bytes
+    for (; end - src >= 28; src += 24, out += 32) {
+        auto in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12)),
+            1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const auto t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const auto t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const auto indices = _mm256_or_si256(t1, t3);
+
+        auto ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        ranges = _mm256_sub_epi8(ranges,
+                                 _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        const auto chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, ranges));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), chars);
+    }
+
+    encodeSsse3(src, end, out);
+}
+
+// NB: a block with invalid characters ends the SIMD loops; the scalar
+//     code then reports it. 16 bytes are stored for 12 bytes of data,
+//     so the loops leave enough characters to cover the extra bytes.
+
+__attribute__((target("sse4.2")))
+static void decodeSsse3(const uint8_t*& src, const uint8_t* end, uint8_t*& out) {
+    const auto lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const auto lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const auto lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                        0, 0, 0, 0, 0, 0, 0, 0);
+    const auto mask_2f = _mm_set1_epi8(0x2f);
+
+    for (; end - src >= 24; src += 16, out += 12) {
+        auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const auto hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+        const auto lo_nibbles = _mm_and_si128(in, mask_2f);
+        const auto hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const auto lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                             _mm_setzero_si128())) != 0)
+            break;
+
+        const auto roll = _mm_shuffle_epi8(
+            lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(in, mask_2f), hi_nibbles));
+        in = _mm_add_epi8(in, roll);
+
+        const auto pairs = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+        const auto quadruplets = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const auto packed = _mm_shuffle_epi8(
+            quadruplets, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                       -1, -1, -1, -1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+    }
+}
+
+__attribute__((target("avx2,sse4.2")))
+static void decodeAvx2(const uint8_t*& src, const uint8_t* end, uint8_t*& out) {
+    const auto lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                         0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const auto lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                         0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const auto lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0,
+                                           0, 16, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+    const auto pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                       -1, -1, -1, -1,
+                                       2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                       -1, -1, -1, -1);
+    const auto mask_2f = _mm256_set1_epi8(0x2f);
+
+    for (; end - src >= 48; src += 32, out += 24) {
+        auto in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const auto hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+        const auto lo_nibbles = _mm256_and_si256(in, mask_2f);
+        const auto hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const auto lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi),
+                                                   _mm256_setzero_si256())) != 0)
+            break;
+
+        const auto roll = _mm256_shuffle_epi8(
+            lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, mask_2f), hi_nibbles));
+        in = _mm256_add_epi8(in, roll);
+
+        const auto pairs = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+        const auto quadruplets = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        // Pack the 12 bytes of each lane, then join the lanes
+        auto packed = _mm256_shuffle_epi8(quadruplets, pack);
+        packed = _mm256_permutevar8x32_epi32(packed,
+                                             _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+    }
+
+    decodeSsse3(src, end, out);
+}
+
+static SimdLevel detectSimdLevel() {
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+
+    if (__builtin_cpu_supports("sse4.2"))
+        return SimdLevel::SSE42;
+
+    return SimdLevel::None;
+}
+
+#else
+
+static SimdLevel detectSimdLevel() {
+    return SimdLevel::None;
+}
+
+#endif  // CPP_PCP_CLIENT_X86_SIMD
+
+//
+// Public interface
+//
+
+SimdLevel getSimdLevel() {
+    static const SimdLevel level { detectSimdLevel() };
+    return level;
+}
+
+std::size_t getBase64Size(std::size_t data_size) {
+    return (data_size + 2) / 3 * 4;
+}
+
+void appendBase64(std::string& buffer, boost::string_ref data) {
+    appendBase64(buffer, data, getSimdLevel());
+}
+
+void appendBase64(std::string& buffer, boost::string_ref data, SimdLevel level) {
+    assert(level <= getSimdLevel());
+
+    auto offset = buffer.size();
+    buffer.resize(offset + getBase64Size(data.size()));
+
+    auto src = reinterpret_cast<const uint8_t*>(data.data());
+    auto end = src + data.size();
+    auto out = &buffer[0] + offset;
+
+    switch (level) {
+#ifdef CPP_PCP_CLIENT_X86_SIMD
+        case SimdLevel::AVX2:
+            encodeAvx2(src, end, out);
+            break;
+        case SimdLevel::SSE42:
+            encodeSsse3(src, end, out);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    encodeScalar(src, end, out);
+}
+
+std::string encodeBase64(boost::string_ref data) {
+    std::string txt {};
+    txt.reserve(getBase64Size(data.size()));
+    appendBase64(txt, data);
+    return txt;
+}
+
+bool decodeBase64(boost::string_ref txt, std::string& data) {
+    return decodeBase64(txt, data, getSimdLevel());
+}
+
+bool decodeBase64(boost::string_ref txt, std::string& data, SimdLevel level) {
+    assert(level <= getSimdLevel());
+
+    if (txt.size() % 4 != 0)
+        return false;
+
+    std::size_t padding { 0 };
+    if (!txt.empty() && txt.back() == '=')
+        padding = txt[txt.size() - 2] == '=' ? 2 : 1;
+
+    data.resize(txt.size() / 4 * 3 - padding);
+
+    // The padded quadruplet is decoded last, on its own
+    auto src = reinterpret_cast<const uint8_t*>(txt.data());
+    auto end = src + txt.size() - (padding != 0 ? 4 : 0);
+    auto out = reinterpret_cast<uint8_t*>(&data[0]);
+
+    switch (level) {
+#ifdef CPP_PCP_CLIENT_X86_SIMD
+        case SimdLevel::AVX2:
+            decodeAvx2(src, end, out);
+            break;
+        case SimdLevel::SSE42:
+            decodeSsse3(src, end, out);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    if (!decodeScalar(src, end, out))
+        return false;
+
+    if (padding != 0) {
+        const auto table = getDecodingTable();
+        auto a = table[src[0]];
+        auto b = table[src[1]];
+        auto c = padding == 1 ? table[src[2]] : 0;
+
+        if ((a | b | c) & 0xc0)
+            return false;
+
+        *out++ = static_cast<uint8_t>(a << 2 | b >> 4);
+        if (padding == 1)
+            *out++ = static_cast<uint8_t>(b << 4 | c >> 2);
+    }
+
+    return true;
+}
+
+}  // namespace Util
+}  // namespace PCPClient
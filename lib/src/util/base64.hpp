@@ -0,0 +1,62 @@
+#ifndef CPP_PCP_CLIENT_SRC_UTIL_BASE64_HPP_
+#define CPP_PCP_CLIENT_SRC_UTIL_BASE64_HPP_
+
+#include <cpp-pcp-client/export.h>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <cstddef>
+#include <string>
+
+/* Base64 encoding (RFC 4648, standard alphabet, with padding) of the
+   binary data carried by JSON text, as the data of v2 messages of
+   binary schemas; internal to the library. With the SIMD_BASE64 CMake
+   option (on by default), on x86, the bulk of the data is processed
+   with SSSE3 or AVX2 instructions, 12 or 24 bytes at a time; the
+   instruction set is selected once, at runtime, among those
+   supported by the CPU, so the build doesn't require them.
+*/
+
+namespace PCPClient {
+namespace Util {
+
+enum class SimdLevel { None, SSE42, AVX2 };
+
+// Return the best instruction set supported by both the build and
+// the CPU
+LIBCPP_PCP_CLIENT_EXPORT SimdLevel getSimdLevel();
+
+// Return the size of the base64 encoding of data_size bytes
+LIBCPP_PCP_CLIENT_EXPORT std::size_t getBase64Size(std::size_t data_size);
+
+// Append the base64 encoding of data to buffer; no memory is
+// allocated if its capacity is enough for getBase64Size() more bytes
+LIBCPP_PCP_CLIENT_EXPORT void appendBase64(std::string& buffer,
+                                           boost::string_ref data);
+
+// As above, with the specified instruction set, which must not be
+// better than getSimdLevel()
+LIBCPP_PCP_CLIENT_EXPORT void appendBase64(std::string& buffer,
+                                           boost::string_ref data,
+                                           SimdLevel level);
+
+// Return the base64 encoding of data
+LIBCPP_PCP_CLIENT_EXPORT std::string encodeBase64(boost::string_ref data);
+
+// Decode the base64 text txt, replacing the content of data. Return
+// false, with data in an unspecified state, in case txt is not valid:
+// its size must be a multiple of 4, with padding only at its end, and
+// it must not contain whitespace.
+LIBCPP_PCP_CLIENT_EXPORT bool decodeBase64(boost::string_ref txt,
+                                           std::string& data);
+
+// As above, with the specified instruction set, which must not be
+// better than getSimdLevel()
+LIBCPP_PCP_CLIENT_EXPORT bool decodeBase64(boost::string_ref txt,
+                                           std::string& data,
+                                           SimdLevel level);
+
+}  // namespace Util
+}  // namespace PCPClient
+
+#endif  // CPP_PCP_CLIENT_SRC_UTIL_BASE64_HPP_
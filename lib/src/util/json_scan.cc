@@ -0,0 +1,27 @@
+#include "util/json_scan.hpp"
+
+#include <leatherman/json_container/json_container.hpp>
+#include <leatherman/locale/locale.hpp>
+
+#include <rapidjson/reader.h>
+
+namespace PCPClient {
+namespace Util {
+
+void checkJsonText(boost::string_ref txt) {
+    // NB: BaseReaderHandler accepts all values; the Reader checks
+    //     the syntax and that there's a single root value
+    rapidjson::BaseReaderHandler<> handler {};
+    JsonTextStream stream { txt };
+    rapidjson::Reader reader {};
+    reader.Parse<0>(stream, handler);
+
+    if (reader.HasParseError()) {
+        throw leatherman::json_container::data_parse_error {
+            leatherman::locale::format("invalid JSON text at offset {1}",
+                                       reader.GetErrorOffset()) };
+    }
+}
+
+}  // namespace Util
+}  // namespace PCPClient
@@ -0,0 +1,81 @@
+#ifndef CPP_PCP_CLIENT_SRC_UTIL_JSON_SCAN_HPP_
+#define CPP_PCP_CLIENT_SRC_UTIL_JSON_SCAN_HPP_
+
+#include <cpp-pcp-client/export.h>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+/* Scanning of JSON text, used by the streaming validation of the
+   Validator and to check outgoing data; internal to the library.
+*/
+
+namespace PCPClient {
+namespace Util {
+
+// Throw a leatherman::json_container::data_parse_error in case txt is
+// not well-formed JSON text; it's parsed with the rapidjson SAX
+// reader, without building a DOM.
+LIBCPP_PCP_CLIENT_EXPORT void checkJsonText(boost::string_ref txt);
+
+//
+// JsonTextStream
+//
+
+// A rapidjson input stream over JSON text that, unlike StringStream,
+// is delimited by its size rather than by a null character, so that
+// it can be part of a larger buffer
+class JsonTextStream {
+  public:
+    typedef char Ch;
+
+    explicit JsonTextStream(boost::string_ref txt)
+            : begin_ { txt.begin() },
+              current_ { txt.begin() },
+              end_ { txt.end() } {
+    }
+
+    Ch Peek() const { return current_ == end_ ? '\0' : *current_; }
+    Ch Take() { return current_ == end_ ? '\0' : *current_++; }
+    std::size_t Tell() const { return static_cast<std::size_t>(current_ - begin_); }
+
+    // Not used by the Reader, unless parsing in situ
+    Ch* PutBegin() { assert(false); return nullptr; }
+    void Put(Ch) { assert(false); }
+    void Flush() { assert(false); }
+    std::size_t PutEnd(Ch*) { assert(false); return 0; }
+
+  private:
+    const char* begin_;
+    const char* current_;
+    const char* end_;
+};
+
+//
+// StringOutputStream
+//
+
+// A rapidjson output stream that appends to a string, so that a
+// Writer can render JSON text straight into a message buffer
+class StringOutputStream {
+  public:
+    typedef char Ch;
+
+    explicit StringOutputStream(std::string& buffer)
+            : buffer_(buffer) {
+    }
+
+    void Put(Ch c) { buffer_.push_back(c); }
+    void Flush() {}
+
+  private:
+    std::string& buffer_;
+};
+
+}  // namespace Util
+}  // namespace PCPClient
+
+#endif  // CPP_PCP_CLIENT_SRC_UTIL_JSON_SCAN_HPP_
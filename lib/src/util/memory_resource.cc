@@ -0,0 +1,147 @@
+#include <cpp-pcp-client/util/memory_resource.hpp>
+
+#include <algorithm>  // max
+#include <cstdint>
+
+namespace PCPClient {
+namespace Util {
+
+//
+// MemoryResource
+//
+
+void* MemoryResource::allocate(std::size_t bytes, std::size_t alignment) {
+    return doAllocate(bytes, alignment);
+}
+
+void MemoryResource::deallocate(void* ptr, std::size_t bytes, std::size_t alignment) {
+    doDeallocate(ptr, bytes, alignment);
+}
+
+//
+// NewDeleteResource
+//
+
+// NB: operator new returns memory suitably aligned for any type with
+//     fundamental alignment, i.e. not greater than MAX_ALIGNMENT
+class NewDeleteResource : public MemoryResource {
+  private:
+    void* doAllocate(std::size_t bytes, std::size_t) override {
+        return ::operator new(bytes);
+    }
+
+    void doDeallocate(void* ptr, std::size_t, std::size_t) override {
+        ::operator delete(ptr);
+    }
+};
+
+MemoryResource* getNewDeleteResource() {
+    static NewDeleteResource resource {};
+    return &resource;
+}
+
+//
+// MonotonicBufferResource
+//
+
+// Header of the buffers obtained from upstream
+struct MonotonicBufferResource::Buffer {
+    Buffer* previous;
+    std::size_t size;  // including this header
+};
+
+MonotonicBufferResource::MonotonicBufferResource(std::size_t initial_size,
+                                                 MemoryResource* upstream,
+                                                 std::size_t max_retained_size)
+        : upstream_ { upstream },
+          initial_size_ { std::max<std::size_t>(initial_size, 2 * sizeof(Buffer)) },
+          max_retained_size_ { max_retained_size },
+          next_size_ { initial_size_ },
+          buffers_ { nullptr },
+          current_ { nullptr },
+          end_ { nullptr } {
+}
+
+MonotonicBufferResource::~MonotonicBufferResource() {
+    release();
+}
+
+void MonotonicBufferResource::rewind() {
+    Buffer* kept { nullptr };
+
+    while (buffers_ != nullptr) {
+        auto previous = buffers_->previous;
+
+        if (buffers_->size <= max_retained_size_
+                && (kept == nullptr || buffers_->size > kept->size)) {
+            if (kept != nullptr)
+                upstream_->deallocate(kept, kept->size);
+
+            kept = buffers_;
+        } else {
+            upstream_->deallocate(buffers_, buffers_->size);
+        }
+
+        buffers_ = previous;
+    }
+
+    if (kept == nullptr) {
+        next_size_ = initial_size_;
+        current_ = nullptr;
+        end_ = nullptr;
+        return;
+    }
+
+    kept->previous = nullptr;
+    buffers_ = kept;
+    next_size_ = 2 * kept->size;
+    current_ = reinterpret_cast<char*>(kept) + sizeof(Buffer);
+    end_ = reinterpret_cast<char*>(kept) + kept->size;
+}
+
+void MonotonicBufferResource::release() {
+    while (buffers_ != nullptr) {
+        auto previous = buffers_->previous;
+        upstream_->deallocate(buffers_, buffers_->size);
+        buffers_ = previous;
+    }
+
+    next_size_ = initial_size_;
+    current_ = nullptr;
+    end_ = nullptr;
+}
+
+// Return ptr rounded up to a multiple of alignment (a power of 2)
+static char* align(char* ptr, std::size_t alignment) {
+    auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    return reinterpret_cast<char*>((address + alignment - 1) & ~(alignment - 1));
+}
+
+void* MonotonicBufferResource::doAllocate(std::size_t bytes, std::size_t alignment) {
+    if (current_ == nullptr
+            || align(current_, alignment) > end_
+            || static_cast<std::size_t>(end_ - align(current_, alignment)) < bytes) {
+        addBuffer(bytes + alignment);
+    }
+
+    auto ptr = align(current_, alignment);
+    current_ = ptr + bytes;
+    return ptr;
+}
+
+void MonotonicBufferResource::doDeallocate(void*, std::size_t, std::size_t) {
+}
+
+void MonotonicBufferResource::addBuffer(std::size_t min_size) {
+    auto size = std::max(next_size_, min_size + sizeof(Buffer));
+    auto buffer = static_cast<Buffer*>(upstream_->allocate(size));
+    buffer->previous = buffers_;
+    buffer->size = size;
+    buffers_ = buffer;
+    current_ = reinterpret_cast<char*>(buffer) + sizeof(Buffer);
+    end_ = reinterpret_cast<char*>(buffer) + size;
+    next_size_ = 2 * size;
+}
+
+}  // namespace Util
+}  // namespace PCPClient
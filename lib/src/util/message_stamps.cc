@@ -0,0 +1,151 @@
+#include <cpp-pcp-client/util/message_stamps.hpp>
+
+#include <chrono>
+#include <cstring>  // memcpy
+#include <random>
+
+namespace PCPClient {
+namespace Util {
+
+constexpr size_t MessageIdGenerator::ID_SIZE;
+constexpr size_t ExpiryFormatter::EXPIRY_SIZE;
+
+//
+// MessageIdGenerator
+//
+
+static const uint64_t SPLITMIX64_GAMMA { 0x9E3779B97F4A7C15ULL };
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static uint64_t getRandomSeed() {
+    std::random_device device {};
+    uint64_t seed { (static_cast<uint64_t>(device()) << 32) | device() };
+    return seed ^ static_cast<uint64_t>(
+        std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
+MessageIdGenerator::MessageIdGenerator()
+        : MessageIdGenerator { getRandomSeed() } {
+}
+
+MessageIdGenerator::MessageIdGenerator(uint64_t seed)
+        : state_ { seed } {
+}
+
+uint64_t MessageIdGenerator::next() {
+    auto z = state_.fetch_add(SPLITMIX64_GAMMA, std::memory_order_relaxed)
+             + SPLITMIX64_GAMMA;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void MessageIdGenerator::generateOn(char* buffer) {
+    uint8_t bytes[16];
+    auto high = next();
+    auto low = next();
+
+    for (int idx = 0; idx < 8; idx++) {
+        bytes[idx] = static_cast<uint8_t>(high >> (56 - 8 * idx));
+        bytes[idx + 8] = static_cast<uint8_t>(low >> (56 - 8 * idx));
+    }
+
+    // Version 4 (random) and RFC 4122 variant
+    bytes[6] = (bytes[6] & 0x0F) | 0x40;
+    bytes[8] = (bytes[8] & 0x3F) | 0x80;
+
+    for (int idx = 0; idx < 16; idx++) {
+        if (idx == 4 || idx == 6 || idx == 8 || idx == 10)
+            *buffer++ = '-';
+
+        *buffer++ = HEX_DIGITS[bytes[idx] >> 4];
+        *buffer++ = HEX_DIGITS[bytes[idx] & 0x0F];
+    }
+}
+
+std::string MessageIdGenerator::generate() {
+    char buffer[ID_SIZE];
+    generateOn(buffer);
+    return std::string(buffer, ID_SIZE);
+}
+
+//
+// ExpiryFormatter
+//
+
+static char* writeDigits(unsigned int value, int num_digits, char* buffer) {
+    for (int idx = num_digits - 1; idx >= 0; idx--) {
+        buffer[idx] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+
+    return buffer + num_digits;
+}
+
+ExpiryFormatter::ExpiryFormatter()
+        : mtx_ {},
+          cached_time_ { -1 },
+          cached_txt_ {} {
+}
+
+void ExpiryFormatter::formatOn(unsigned int timeout, char* buffer) {
+    auto expiry_time = std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now()) + timeout;
+    Util::lock_guard<Util::mutex> the_lock { mtx_ };
+
+    if (expiry_time != cached_time_) {
+        formatTimeOn(expiry_time, cached_txt_);
+        cached_time_ = expiry_time;
+    }
+
+    memcpy(buffer, cached_txt_, EXPIRY_SIZE);
+}
+
+std::string ExpiryFormatter::format(unsigned int timeout) {
+    char buffer[EXPIRY_SIZE];
+    formatOn(timeout, buffer);
+    return std::string(buffer, EXPIRY_SIZE);
+}
+
+void ExpiryFormatter::formatTimeOn(std::time_t time, char* buffer) {
+    // Convert the days since the epoch to a civil date with the
+    // algorithm of http://howardhinnant.github.io/date_algorithms.html
+    // (no gmtime, which isn't reentrant, nor its platform variants)
+    int64_t secs = static_cast<int64_t>(time);
+    int64_t days = secs / 86400;
+    int64_t day_secs = secs % 86400;
+
+    if (day_secs < 0) {
+        day_secs += 86400;
+        days--;
+    }
+
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    auto day_of_era = static_cast<unsigned int>(days - era * 146097);
+    auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524
+                        - day_of_era / 146096) / 365;
+    auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4
+                                     - year_of_era / 100);
+    auto month_idx = (5 * day_of_year + 2) / 153;
+    auto day = day_of_year - (153 * month_idx + 2) / 5 + 1;
+    auto month = month_idx < 10 ? month_idx + 3 : month_idx - 9;
+    auto year = static_cast<unsigned int>(year_of_era + era * 400 + (month <= 2));
+
+    buffer = writeDigits(year, 4, buffer);
+    *buffer++ = '-';
+    buffer = writeDigits(month, 2, buffer);
+    *buffer++ = '-';
+    buffer = writeDigits(day, 2, buffer);
+    *buffer++ = 'T';
+    buffer = writeDigits(static_cast<unsigned int>(day_secs / 3600), 2, buffer);
+    *buffer++ = ':';
+    buffer = writeDigits(static_cast<unsigned int>(day_secs % 3600 / 60), 2, buffer);
+    *buffer++ = ':';
+    buffer = writeDigits(static_cast<unsigned int>(day_secs % 60), 2, buffer);
+    *buffer = 'Z';
+}
+
+}  // namespace Util
+}  // namespace PCPClient
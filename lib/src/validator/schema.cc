@@ -43,7 +43,10 @@ Schema::Schema(std::string name,
           type_ { std::move(type) },
           properties_ { new V_C::PropertiesConstraint::PropertySchemaMap() },
           pattern_properties_ { new V_C::PropertiesConstraint::PropertySchemaMap() },
-          required_properties_ { new V_C::RequiredConstraint::RequiredProperties() } {
+          required_properties_ { new V_C::RequiredConstraint::RequiredProperties() },
+          native_validator_ { nullptr },
+          property_types_ {},
+          has_sub_schemas_ { false } {
 }
 
 Schema::Schema(std::string name,
@@ -71,7 +74,10 @@ Schema::Schema(const Schema& s)
           pattern_properties_ {
             new V_C::PropertiesConstraint::PropertySchemaMap(*s.pattern_properties_) },
           required_properties_ {
-            new V_C::RequiredConstraint::RequiredProperties(*s.required_properties_)} {
+            new V_C::RequiredConstraint::RequiredProperties(*s.required_properties_)},
+          native_validator_ { s.native_validator_ },
+          property_types_ { s.property_types_ },
+          has_sub_schemas_ { s.has_sub_schemas_ } {
 }
 
 Schema::Schema(std::string name, const lth_jc::JsonContainer& metadata)
@@ -82,7 +88,10 @@ Schema::Schema(std::string name, const lth_jc::JsonContainer& metadata)
               type_ { TypeConstraint::Object },
               properties_ { new V_C::PropertiesConstraint::PropertySchemaMap() },
               pattern_properties_ { new V_C::PropertiesConstraint::PropertySchemaMap() },
-              required_properties_ { new V_C::RequiredConstraint::RequiredProperties() } {
+              required_properties_ { new V_C::RequiredConstraint::RequiredProperties() },
+              native_validator_ { nullptr },
+              property_types_ {},
+              has_sub_schemas_ { false } {
 } catch (std::exception& e) {
     throw schema_error { lth_loc::format("failed to parse schema: {1}", e.what()) };
 } catch (...) {
@@ -95,6 +104,7 @@ Schema::~Schema() {}
 
 void Schema::addConstraint(std::string field, TypeConstraint type, bool required) {
     checkAddConstraint();
+    native_validator_ = nullptr;
 
     V_C::TypeConstraint constraint { getConstraint(type) };
 
@@ -105,10 +115,13 @@ void Schema::addConstraint(std::string field, TypeConstraint type, bool required
         // add required constraint
         required_properties_->insert(field);
     }
+
+    property_types_.push_back(PropertyType { std::move(field), type, required });
 }
 
 void Schema::addConstraint(std::string field, Schema sub_schema, bool required) {
     checkAddConstraint();
+    native_validator_ = nullptr;
 
     V_C::ItemsConstraint sub_schema_constraint { sub_schema.getRaw() };
 
@@ -118,6 +131,12 @@ void Schema::addConstraint(std::string field, Schema sub_schema, bool required)
     if (required) {
         required_properties_->insert(field);
     }
+
+    has_sub_schemas_ = true;
+}
+
+void Schema::setNativeValidator(NativeValidator native_validator) {
+    native_validator_ = native_validator;
 }
 
 const std::string Schema::getName() const {
@@ -128,6 +147,10 @@ ContentType Schema::getContentType() const {
     return content_type_;
 }
 
+TypeConstraint Schema::getType() const {
+    return type_;
+}
+
 const valijson::Schema Schema::getRaw() const {
     if (parsed_) {
         return *parsed_json_schema_;
@@ -149,6 +172,18 @@ const valijson::Schema Schema::getRaw() const {
     return schema;
 }
 
+NativeValidator Schema::getNativeValidator() const {
+    return native_validator_;
+}
+
+bool Schema::isStreamable() const {
+    return !parsed_ && !has_sub_schemas_;
+}
+
+const std::vector<PropertyType>& Schema::getPropertyTypes() const {
+    return property_types_;
+}
+
 //
 // Private methods
 //
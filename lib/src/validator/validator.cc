@@ -1,5 +1,7 @@
 #include <cpp-pcp-client/validator/validator.hpp>
 
+#include "util/json_scan.hpp"
+
 #define LEATHERMAN_LOGGING_NAMESPACE CPP_PCP_CLIENT_LOGGING_PREFIX".validator"
 #include <leatherman/logging/logging.hpp>
 
@@ -11,9 +13,20 @@
 #include <cpp-pcp-client/valijson/rapidjson_adapter.hpp>
 #include <valijson/schema_parser.hpp>
 #include <valijson/validation_results.hpp>
-#include <valijson/validator.hpp>
+#include <valijson/validation_visitor.hpp>
 #pragma GCC diagnostic pop
 
+#include <rapidjson/reader.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>  // memcpy
+#include <utility>
+
 namespace PCPClient {
 
 namespace lth_jc  = leatherman::json_container;
@@ -43,12 +56,20 @@ std::string getValidationError(valijson::ValidationResults& validation_results)
     return  err_msg;
 }
 
-bool validateJsonContainer(const lth_jc::JsonContainer& data, const Schema& schema) {
-    valijson::Validator validator { schema.getRaw() };
+bool validateJsonContainer(const lth_jc::JsonContainer& data,
+                           const valijson::Schema& raw_schema) {
     valijson::adapters::RapidJsonAdapter adapted_document { data.getRaw() };
     valijson::ValidationResults validation_results;
 
-    auto success = validator.validate(adapted_document, &validation_results);
+    // NB: we don't use valijson::Validator, as its ctor copies the
+    //     whole schema; the visitor only reads the compiled schema
+    valijson::ValidationVisitor<valijson::adapters::RapidJsonAdapter> visitor {
+        adapted_document,
+        std::vector<std::string>(1, "<root>"),
+        true,  // strict types, as valijson::Validator does by default
+        &validation_results };
+
+    auto success = visitor.validateSchema(raw_schema);
 
     if (!success) {
         auto err_msg = getValidationError(validation_results);
@@ -58,62 +79,690 @@ bool validateJsonContainer(const lth_jc::JsonContainer& data, const Schema& sche
     return success;
 }
 
+///
+/// StreamingSchema
+///
+
+// The kinds of JSON values reported by the rapidjson SAX reader, as
+// bit flags
+enum ValueKind : unsigned {
+    NULL_VALUE = 1, BOOL_VALUE = 2, INTEGER_VALUE = 4, DOUBLE_VALUE = 8,
+    STRING_VALUE = 16, ARRAY_VALUE = 32, OBJECT_VALUE = 64, ANY_VALUE = 127
+};
+
+// The value kinds accepted by a type constraint; as for valijson's
+// strict types, a Double constraint accepts integers as well
+static unsigned getValueKinds(TypeConstraint type) {
+    switch (type) {
+        case TypeConstraint::Object :
+            return OBJECT_VALUE;
+        case TypeConstraint::Array :
+            return ARRAY_VALUE;
+        case TypeConstraint::String :
+            return STRING_VALUE;
+        case TypeConstraint::Int :
+            return INTEGER_VALUE;
+        case TypeConstraint::Bool :
+            return BOOL_VALUE;
+        case TypeConstraint::Double :
+            return INTEGER_VALUE | DOUBLE_VALUE;
+        case TypeConstraint::Null :
+            return NULL_VALUE;
+        default:
+            return ANY_VALUE;
+    }
+}
+
+// The maximum number of properties of a streamable schema, so that
+// the required ones can be tracked with a 64-bit mask
+static const std::size_t MAX_STREAMING_PROPERTIES { 64 };
+
+struct Validator::StreamingSchema {
+    struct Property {
+        std::string name;
+        unsigned value_kinds;
+    };
+
+    // Value kinds accepted for the root
+    unsigned value_kinds;
+
+    // The known properties, each listed once; in case the list is
+    // not empty, any other property is invalid (as valijson does for
+    // the schemas built by Schema::addConstraint)
+    std::vector<Property> properties;
+
+    // The bits of the required properties' indexes
+    std::uint64_t required_mask;
+
+    // Return nullptr if the schema is not streamable
+    static std::shared_ptr<const StreamingSchema> create(const Schema& schema) {
+        if (!schema.isStreamable())
+            return nullptr;
+
+        std::shared_ptr<StreamingSchema> streaming_schema { new StreamingSchema() };
+        streaming_schema->value_kinds = getValueKinds(schema.getType());
+        streaming_schema->required_mask = 0;
+
+        for (const auto& property_type : schema.getPropertyTypes()) {
+            auto idx = streaming_schema->find(property_type.name);
+
+            if (idx < 0) {
+                if (streaming_schema->properties.size() == MAX_STREAMING_PROPERTIES)
+                    return nullptr;
+                idx = static_cast<int>(streaming_schema->properties.size());
+                streaming_schema->properties.push_back(
+                    Property { property_type.name, ANY_VALUE });
+            }
+
+            // All the type constraints of a property must be satisfied
+            streaming_schema->properties[idx].value_kinds &=
+                getValueKinds(property_type.type);
+
+            if (property_type.required)
+                streaming_schema->required_mask |= std::uint64_t { 1 } << idx;
+        }
+
+        return streaming_schema;
+    }
+
+    // Return the index of the property or -1 if it's not known
+    int find(boost::string_ref name) const {
+        for (std::size_t idx = 0; idx < properties.size(); idx++)
+            if (name == boost::string_ref(properties[idx].name))
+                return static_cast<int>(idx);
+        return -1;
+    }
+
+    // Handler of the SAX events of rapidjson's Reader; each callback
+    // returns false, so that the Reader stops, as soon as a
+    // violation is found, whose description is then stored in error.
+    // NB: the object keys are handled by String, as the Reader's
+    //     versions that don't call Key report them as strings
+    class Handler {
+      public:
+        std::string error;
+
+        Handler(const StreamingSchema& schema,
+                std::vector<PropertyCapture>* captures)
+                : error {},
+                  schema_(schema),
+                  captures_ { captures },
+                  depth_ { 0 },
+                  in_root_object_ { false },
+                  expecting_key_ { false },
+                  property_idx_ { -1 },
+                  capture_ { nullptr },
+                  captured_ { 0 },
+                  found_ { 0 } {
+            assert(captures == nullptr
+                   || captures->size() <= MAX_STREAMING_PROPERTIES);
+        }
+
+        bool Null() { return checkValue(NULL_VALUE); }
+        bool Bool(bool) { return checkValue(BOOL_VALUE); }
+        bool Int(int) { return checkValue(INTEGER_VALUE); }
+        bool Uint(unsigned) { return checkValue(INTEGER_VALUE); }
+        bool Int64(std::int64_t) { return checkValue(INTEGER_VALUE); }
+        bool Uint64(std::uint64_t) { return checkValue(INTEGER_VALUE); }
+        bool Double(double) { return checkValue(DOUBLE_VALUE); }
+
+        // NB: only called with kParseNumbersAsStringsFlag, not used
+        bool RawNumber(const char*, rapidjson::SizeType, bool) {
+            return checkValue(DOUBLE_VALUE);
+        }
+
+        bool String(const char* str, rapidjson::SizeType length, bool) {
+            if (expecting_key_)
+                return checkKey(boost::string_ref(str, length));
+
+            if (capture_ != nullptr && depth_ == 1)
+                capture_->value.assign(str, length);
+
+            return checkValue(STRING_VALUE);
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+            return String(str, length, copy);
+        }
+
+        bool StartObject() {
+            if (!checkValue(OBJECT_VALUE))
+                return false;
+
+            if (depth_ == 0)
+                in_root_object_ = true;
+            depth_++;
+            expecting_key_ = in_root_object_ && depth_ == 1;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            depth_--;
+
+            if (depth_ == 0 && (found_ & schema_.required_mask) != schema_.required_mask) {
+                error = lth_loc::translate("missing required properties");
+                return false;
+            }
+
+            expecting_key_ = in_root_object_ && depth_ == 1;
+            return true;
+        }
+
+        bool StartArray() {
+            if (!checkValue(ARRAY_VALUE))
+                return false;
+
+            depth_++;
+            expecting_key_ = false;
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType) {
+            depth_--;
+            expecting_key_ = in_root_object_ && depth_ == 1;
+            return true;
+        }
+
+      private:
+        const StreamingSchema& schema_;
+        std::vector<PropertyCapture>* captures_;
+        unsigned int depth_;
+        bool in_root_object_;
+        bool expecting_key_;
+
+        // The schema property and the capture of the current key,
+        // if any
+        int property_idx_;
+        PropertyCapture* capture_;
+
+        // The bits of the indexes of the captures whose key was found
+        // so far; as for the DOM, only the first occurrence of a
+        // duplicate key is taken into account
+        std::uint64_t captured_;
+
+        // The bits of the indexes of the properties found so far
+        std::uint64_t found_;
+
+        bool checkKey(boost::string_ref name) {
+            expecting_key_ = false;
+            property_idx_ = schema_.find(name);
+
+            if (property_idx_ < 0 && !schema_.properties.empty()) {
+                error = lth_loc::format("unknown property '{1}'", name.to_string());
+                return false;
+            }
+
+            capture_ = nullptr;
+            if (captures_ != nullptr) {
+                for (std::size_t idx = 0; idx < captures_->size(); idx++) {
+                    if ((*captures_)[idx].name == name) {
+                        auto bit = std::uint64_t { 1 } << idx;
+
+                        if ((captured_ & bit) == 0)
+                            capture_ = &(*captures_)[idx];
+                        captured_ |= bit;
+                        break;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Values nested in the root's properties are not checked
+        bool checkValue(ValueKind value_kind) {
+            if (depth_ == 0) {
+                if ((schema_.value_kinds & value_kind) == 0) {
+                    error = lth_loc::translate("wrong type");
+                    return false;
+                }
+            } else if (depth_ == 1 && in_root_object_) {
+                expecting_key_ = true;
+
+                if (property_idx_ >= 0) {
+                    const auto& property = schema_.properties[property_idx_];
+
+                    if ((property.value_kinds & value_kind) == 0) {
+                        error = lth_loc::format("wrong type for property '{1}'",
+                                                property.name);
+                        return false;
+                    }
+
+                    found_ |= std::uint64_t { 1 } << property_idx_;
+                }
+            }
+
+            return true;
+        }
+    };
+};
+
+// A rapidjson allocator over an arena, for the stack of the Reader;
+// memory is never freed individually (NB: the Reader's stack calls
+// Free statically), but reclaimed with the arena
+class ArenaAllocator {
+  public:
+    static const bool kNeedFree = false;
+
+    // NB: the default ctor is required by rapidjson, which creates
+    //     its own allocator when none is given; it's never the case
+    explicit ArenaAllocator(Util::MonotonicBufferResource* arena = nullptr)
+            : arena_ { arena } {
+    }
+
+    void* Malloc(size_t size) {
+        assert(arena_ != nullptr);
+        return size > 0 ? arena_->allocate(size) : nullptr;
+    }
+
+    void* Realloc(void* original_ptr, size_t original_size, size_t new_size) {
+        if (new_size <= original_size)
+            return original_ptr;
+
+        auto new_ptr = Malloc(new_size);
+
+        if (original_size > 0)
+            std::memcpy(new_ptr, original_ptr, original_size);
+
+        return new_ptr;
+    }
+
+    static void Free(void*) {}
+
+  private:
+    Util::MonotonicBufferResource* arena_;
+};
+
+// Set the captured properties that have a string value; in case of
+// duplicate keys, the first member is taken, as JsonContainer does
+static void captureProperties(const lth_jc::JsonContainer& data,
+                              std::vector<PropertyCapture>& captures) {
+    const auto& root = data.getRaw();
+
+    if (!root.IsObject())
+        return;
+
+    for (auto& capture : captures) {
+        for (auto itr = root.MemberBegin(); itr != root.MemberEnd(); ++itr) {
+            boost::string_ref name { itr->name.GetString(),
+                                     itr->name.GetStringLength() };
+
+            if (name != capture.name)
+                continue;
+
+            if (itr->value.IsString())
+                capture.value.assign(itr->value.GetString(),
+                                     itr->value.GetStringLength());
+            break;
+        }
+    }
+}
+
+///
+/// Registry
+///
+
+// The minimum number of slots of a Registry's table; must be a power
+// of two
+static const std::size_t MIN_REGISTRY_SLOTS { 16 };
+
+struct Validator::Registry {
+    struct Entry {
+        std::string name;
+        CompiledSchema schema;
+        // Registration order
+        std::size_t index;
+    };
+
+    // Open addressing table with linear probing, whose size is a power
+    // of two that is at least twice the number of entries, so that a
+    // probe sequence always ends on an empty slot. A new entry is
+    // stored in an empty slot, which a concurrent lookup sees either
+    // empty or pointing to the complete entry.
+    struct Table {
+        std::size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+        explicit Table(std::size_t num_slots)
+                : mask { num_slots - 1 },
+                  slots { new std::atomic<const Entry*>[num_slots] } {
+            for (std::size_t slot = 0; slot < num_slots; slot++)
+                slots[slot].store(nullptr, std::memory_order_relaxed);
+        }
+
+        void insert(const Entry* entry) {
+            auto slot = hash(entry->name) & mask;
+            while (slots[slot].load(std::memory_order_relaxed) != nullptr)
+                slot = (slot + 1) & mask;
+            slots[slot].store(entry, std::memory_order_release);
+        }
+    };
+
+    std::atomic<const Table*> table;
+    std::atomic<std::size_t> num_entries;
+
+    // Only modified with registration_mutex_ held. A full table is
+    // replaced by one twice its size, but it's not freed, as lookups
+    // may still be probing it; since the sizes double, the replaced
+    // tables take less memory than the current one
+    std::vector<std::unique_ptr<const Entry>> entries;
+    std::vector<std::unique_ptr<Table>> tables;
+
+    Registry()
+            : table { nullptr },
+              num_entries { 0 },
+              entries {},
+              tables {} {
+        tables.emplace_back(new Table(MIN_REGISTRY_SLOTS));
+        table.store(tables.back().get(), std::memory_order_release);
+    }
+
+    // Consider only the first max_entries registered entries
+    const CompiledSchema* find(boost::string_ref name,
+                               std::size_t max_entries = SIZE_MAX) const {
+        const auto current = table.load(std::memory_order_acquire);
+        const Entry* entry;
+
+        for (auto slot = hash(name) & current->mask;
+             (entry = current->slots[slot].load(std::memory_order_acquire)) != nullptr;
+             slot = (slot + 1) & current->mask) {
+            if (entry->index < max_entries && name == boost::string_ref(entry->name))
+                return &entry->schema;
+        }
+        return nullptr;
+    }
+
+    // Must be called with registration_mutex_ held
+    void add(std::string name, CompiledSchema schema) {
+        entries.emplace_back(new Entry { std::move(name), std::move(schema),
+                                         entries.size() });
+        auto current = tables.back().get();
+
+        if (2 * entries.size() > current->mask + 1) {
+            tables.emplace_back(new Table(2 * (current->mask + 1)));
+            current = tables.back().get();
+            for (const auto& entry : entries)
+                current->insert(entry.get());
+            table.store(current, std::memory_order_release);
+        } else {
+            current->insert(entries.back().get());
+        }
+
+        num_entries.store(entries.size(), std::memory_order_release);
+    }
+
+    static std::size_t hash(boost::string_ref name) {
+        return boost::hash_range(name.begin(), name.end());
+    }
+};
+
 ///
 /// Public API
 ///
 
 Validator::Validator()
-        : schema_map_ {},
-          lookup_mutex_ {} {
+        : registry_ { new Registry() },
+          registration_mutex_ {} {
 }
 
 Validator::Validator(Validator&& other_validator)
-        : schema_map_ { other_validator.schema_map_ },
-          lookup_mutex_ {} {
+        : registry_ { new Registry() },
+          registration_mutex_ {} {
+    Util::lock_guard<Util::mutex> lock(other_validator.registration_mutex_);
+    std::swap(registry_, other_validator.registry_);
 }
 
+Validator::~Validator() = default;
+
 void Validator::registerSchema(const Schema& schema) {
-    Util::lock_guard<Util::mutex> lock(lookup_mutex_);
-    auto schema_name = schema.getName();
-    if (includesSchema(schema_name)) {
-        throw schema_redefinition_error {
-            lth_loc::format("schema '{1}' already defined", schema_name) };
+    addSchema(schema.getName(),
+              CompiledSchema {
+                  schema.getContentType(),
+                  std::make_shared<const valijson::Schema>(schema.getRaw()),
+                  schema.getNativeValidator(),
+                  StreamingSchema::create(schema) });
+}
+
+void Validator::registerCompiledSchema(std::string schema_name,
+                                       NativeValidator compiled_validator,
+                                       ContentType content_type) {
+    if (compiled_validator == nullptr) {
+        throw validator_error {
+            lth_loc::format("no compiled validator for schema '{1}'", schema_name) };
     }
 
-    auto p = std::pair<std::string, Schema>(schema_name, schema);
-    schema_map_.insert(p);
+    addSchema(std::move(schema_name),
+              CompiledSchema { content_type, nullptr, compiled_validator, nullptr });
 }
 
 void Validator::validate(const lth_jc::JsonContainer& data,
-                         std::string schema_name) const {
-    Util::unique_lock<Util::mutex> lock(lookup_mutex_);
-    if (!includesSchema(schema_name)) {
+                         boost::string_ref schema_name) const {
+    // NB: the compiled schema cannot be modified, and it lives as
+    //     long as the Validator does
+    validateData(data, schema_name, getCompiledSchema(schema_name));
+}
+
+void Validator::validateText(boost::string_ref json_txt,
+                             boost::string_ref schema_name,
+                             std::vector<PropertyCapture>* captures,
+                             Util::MonotonicBufferResource* arena) const {
+    const auto& compiled_schema = getCompiledSchema(schema_name);
+
+    if (compiled_schema.streaming_schema != nullptr) {
+        validateStream(json_txt, schema_name, *compiled_schema.streaming_schema,
+                       captures, arena);
+        return;
+    }
+
+    lth_jc::JsonContainer data { json_txt.to_string() };
+    validateData(data, schema_name, compiled_schema);
+
+    if (captures != nullptr)
+        captureProperties(data, *captures);
+}
+
+lth_jc::JsonContainer Validator::parseText(boost::string_ref json_txt,
+                                           boost::string_ref schema_name) const {
+    const auto& compiled_schema = getCompiledSchema(schema_name);
+
+    // Don't build the DOM of invalid data, when possible
+    if (compiled_schema.streaming_schema != nullptr)
+        validateStream(json_txt, schema_name, *compiled_schema.streaming_schema,
+                       nullptr, nullptr);
+
+    lth_jc::JsonContainer data { json_txt.to_string() };
+
+    if (compiled_schema.streaming_schema == nullptr)
+        validateData(data, schema_name, compiled_schema);
+
+    return data;
+}
+
+// The number of items a batch worker claims at a time; large enough
+// to make contention on the shared index negligible, small enough to
+// balance the load of heterogeneous items
+static const std::size_t BATCH_RUN_SIZE { 64 };
+
+std::vector<ValidationResult> Validator::validateBatch(const ValidationItem* items,
+                                                       std::size_t num_items,
+                                                       unsigned int num_workers) const {
+    std::vector<ValidationResult> results(
+        num_items, ValidationResult { ValidationStatus::Valid, "" });
+
+    if (num_items == 0)
+        return results;
+
+    if (num_workers == 0)
+        num_workers = std::max(Util::thread::hardware_concurrency(), 1u);
+
+    // No more workers than runs of items
+    auto num_runs = (num_items + BATCH_RUN_SIZE - 1) / BATCH_RUN_SIZE;
+    if (num_workers > num_runs)
+        num_workers = static_cast<unsigned int>(num_runs);
+
+    // The snapshot: schemas registered from now on are ignored
+    const auto num_schemas = registry_->num_entries.load(std::memory_order_acquire);
+    std::atomic<std::size_t> next_run_start { 0 };
+
+    auto worker = [&]() {
+        std::size_t start;
+
+        while ((start = next_run_start.fetch_add(BATCH_RUN_SIZE)) < num_items) {
+            auto end = std::min(start + BATCH_RUN_SIZE, num_items);
+
+            for (auto idx = start; idx < end; idx++) {
+                const auto& schema_name = items[idx].second;
+                auto& result = results[idx];
+
+                try {
+                    auto compiled_schema = registry_->find(schema_name, num_schemas);
+
+                    if (compiled_schema == nullptr) {
+                        result.status = ValidationStatus::SchemaNotFound;
+                        result.error = lth_loc::format("'{1}' is not a registered schema",
+                                                       schema_name);
+                        continue;
+                    }
+
+                    validateData(items[idx].first, schema_name, *compiled_schema);
+                } catch (const validation_error& e) {
+                    result.status = ValidationStatus::Invalid;
+                    result.error = e.what();
+                } catch (const std::exception& e) {
+                    result.status = ValidationStatus::Error;
+                    result.error = e.what();
+                } catch (...) {
+                    result.status = ValidationStatus::Error;
+                    result.error = lth_loc::translate("unexpected error");
+                }
+            }
+        }
+    };
+
+    // The calling thread is a worker as well
+    std::vector<Util::thread> worker_threads {};
+    worker_threads.reserve(num_workers - 1);
+
+    for (unsigned int idx = 1; idx < num_workers; idx++) {
+        try {
+            worker_threads.emplace_back(worker);
+        } catch (const std::exception& e) {
+            LOG_WARNING("Failed to start a batch validation worker: {1}", e.what());
+            break;
+        }
+    }
+
+    worker();
+
+    for (auto& worker_thread : worker_threads)
+        worker_thread.join();
+
+    return results;
+}
+
+std::vector<ValidationResult> Validator::validateBatch(
+        const std::vector<ValidationItem>& items,
+        unsigned int num_workers) const {
+    return validateBatch(items.data(), items.size(), num_workers);
+}
+
+bool Validator::includesSchema(boost::string_ref schema_name) const {
+    return registry_->find(schema_name) != nullptr;
+}
+
+ContentType Validator::getSchemaContentType(boost::string_ref schema_name) const {
+    return getCompiledSchema(schema_name).content_type;
+}
+
+///
+/// Private methods
+///
+
+const Validator::CompiledSchema& Validator::getCompiledSchema(
+        boost::string_ref schema_name) const {
+    auto compiled_schema = registry_->find(schema_name);
+
+    if (compiled_schema == nullptr) {
         throw schema_not_found_error {
-            lth_loc::format("'{1}' is not a registered schema", schema_name) };
+            lth_loc::format("'{1}' is not a registered schema",
+                            schema_name.to_string()) };
     }
-    lock.unlock();
 
-    // we can freely unlock. When a schema has been set it cannot be modified
+    return *compiled_schema;
+}
+
+void Validator::validateData(const lth_jc::JsonContainer& data,
+                             boost::string_ref schema_name,
+                             const CompiledSchema& compiled_schema) const {
+    auto success = compiled_schema.native_validator != nullptr
+                   ? compiled_schema.native_validator(data)
+                   : validateJsonContainer(data, *compiled_schema.raw_schema);
+
+    if (!success) {
+        if (compiled_schema.raw_schema == nullptr) {
+            LOG_DEBUG("Schema validation failure: rejected by the compiled "
+                      "validator of '{1}'", schema_name.to_string());
+        } else if (compiled_schema.native_validator != nullptr) {
+            // Let valijson log the failure details
+            validateJsonContainer(data, *compiled_schema.raw_schema);
+        }
 
-    if (!validateJsonContainer(data, schema_map_.at(schema_name))) {
         throw validation_error {
-            lth_loc::format("does not match schema: '{1}'", schema_name) };
+            lth_loc::format("does not match schema: '{1}'",
+                            schema_name.to_string()) };
     }
 }
 
-bool Validator::includesSchema(std::string schema_name) const {
-    return schema_map_.find(schema_name) != schema_map_.end();
+void Validator::validateStream(boost::string_ref json_txt,
+                               boost::string_ref schema_name,
+                               const StreamingSchema& streaming_schema,
+                               std::vector<PropertyCapture>* captures,
+                               Util::MonotonicBufferResource* arena) const {
+    if (arena == nullptr) {
+        // The Reader's stack is the only working memory, so an arena
+        // sized for it takes a single block from the heap
+        Util::MonotonicBufferResource local_arena { json_txt.size() + 1 };
+        validateStream(json_txt, schema_name, streaming_schema, captures,
+                       &local_arena);
+        return;
+    }
+
+    StreamingSchema::Handler handler { streaming_schema, captures };
+    Util::JsonTextStream stream { json_txt };
+    ArenaAllocator allocator { arena };
+
+    // NB: the Reader's stack only holds the string being parsed, so
+    //     it's sized for the longest possible one; otherwise it would
+    //     grow, taking a new block from the arena, for each doubling
+    rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, ArenaAllocator>
+        reader { &allocator, json_txt.size() + 1 };
+    reader.Parse<0>(stream, handler);
+
+    // NB: check the handler first, as a violation stops the Reader
+    //     with a termination error
+    if (!handler.error.empty()) {
+        LOG_DEBUG("Schema validation failure: {1}", handler.error);
+        throw validation_error {
+            lth_loc::format("does not match schema: '{1}'",
+                            schema_name.to_string()) };
+    }
+
+    if (reader.HasParseError()) {
+        throw lth_jc::data_parse_error {
+            lth_loc::format("invalid JSON text at offset {1}",
+                            reader.GetErrorOffset()) };
+    }
 }
 
-ContentType Validator::getSchemaContentType(std::string schema_name) const {
-    Util::unique_lock<Util::mutex> lock(lookup_mutex_);
-    if (!includesSchema(schema_name)) {
-        throw schema_not_found_error {
-            lth_loc::format("'{1}' is not a registered schema", schema_name) };
+void Validator::addSchema(std::string schema_name, CompiledSchema compiled_schema) {
+    Util::lock_guard<Util::mutex> lock(registration_mutex_);
+
+    if (registry_->find(schema_name) != nullptr) {
+        throw schema_redefinition_error {
+            lth_loc::format("schema '{1}' already defined", schema_name) };
     }
-    lock.unlock();
 
-    return schema_map_.at(schema_name).getContentType();
+    registry_->add(std::move(schema_name), std::move(compiled_schema));
 }
 
 }  // namespace PCPClient
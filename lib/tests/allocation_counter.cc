@@ -0,0 +1,74 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// NB: the counters are plain thread_local integers, so that updating
+// them never allocates
+
+static thread_local std::size_t num_allocations { 0 };
+static thread_local unsigned int num_active_counters { 0 };
+
+static void* allocate(std::size_t size) {
+    if (num_active_counters > 0)
+        num_allocations++;
+
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    if (auto ptr = allocate(size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+
+void* operator new[](std::size_t size) {
+    if (auto ptr = allocate(size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+namespace PCPClient {
+
+AllocationCounter::AllocationCounter()
+        : start_count_ { num_allocations } {
+    num_active_counters++;
+}
+
+AllocationCounter::~AllocationCounter() {
+    num_active_counters--;
+}
+
+std::size_t AllocationCounter::getCount() const {
+    return num_allocations - start_count_;
+}
+
+void AllocationCounter::reset() {
+    start_count_ = num_allocations;
+}
+
+}  // namespace PCPClient
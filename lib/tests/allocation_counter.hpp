@@ -0,0 +1,33 @@
+#ifndef PCP_CLIENT_TEST_ALLOCATION_COUNTER_HPP_
+#define PCP_CLIENT_TEST_ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+namespace PCPClient {
+
+// Count the heap allocations (calls of the global operator new,
+// replaced by allocation_counter.cc in the unit test executable) made
+// by the current thread while the counter is in scope; allocations
+// made by other threads, such as the WebSocket event loop, are not
+// counted. Counters can be nested.
+class AllocationCounter {
+  public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+    // Return the number of allocations since construction or the
+    // last reset
+    std::size_t getCount() const;
+
+    void reset();
+
+  private:
+    std::size_t start_count_;
+};
+
+}  // namespace PCPClient
+
+#endif  // PCP_CLIENT_TEST_ALLOCATION_COUNTER_HPP_
@@ -6,6 +6,7 @@
 #include <cpp-pcp-client/connector/connection.hpp>
 #include <cpp-pcp-client/connector/client_metadata.hpp>
 #include <cpp-pcp-client/connector/errors.hpp>
+#include <cpp-pcp-client/connector/io_reactor.hpp>
 #include <cpp-pcp-client/connector/timings.hpp>
 
 #include <cpp-pcp-client/util/chrono.hpp>
@@ -17,7 +18,9 @@
 
 #include <leatherman/util/timer.hpp>
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 using namespace PCPClient;
 
@@ -195,6 +198,74 @@ TEST_CASE("Connection::connect", "[connection]") {
     }
 }
 
+TEST_CASE("Connection with a shared IoReactor", "[connection]") {
+    ClientMetadata c_m { "test_client", getCaPath(), getCertPath(),
+                         getKeyPath(), WS_TIMEOUT_MS,
+                         PONG_TIMEOUTS_BEFORE_RETRY, PONG_LONG_TIMEOUT_MS };
+    std::shared_ptr<IoReactor> io_reactor { new IoReactor(2) };
+
+    MockServer mock_server;
+    std::atomic<int> num_connected { 0 };
+    mock_server.set_open_handler([&num_connected](websocketpp::connection_hdl hdl) {
+        num_connected++;
+    });
+    mock_server.go();
+    auto ws_uri = "wss://localhost:" + std::to_string(mock_server.port()) + "/pcp";
+
+    SECTION("many connections are opened and closed on the same threads") {
+        std::vector<std::unique_ptr<Connection>> connections {};
+        for (auto idx = 0; idx < 4; idx++) {
+            connections.emplace_back(new Connection(ws_uri, c_m, io_reactor));
+            connections.back()->connect(10);
+        }
+
+        wait_for([&num_connected]() { return num_connected == 4; });
+        REQUIRE(num_connected == 4);
+
+        for (auto& connection : connections) {
+            REQUIRE(connection->getConnectionState() == ConnectionState::open);
+            connection->close();
+            let_connection_stop(*connection);
+        }
+    }
+
+    SECTION("a connection can be destroyed while open") {
+        {
+            Connection connection { ws_uri, c_m, io_reactor };
+            connection.connect(10);
+            wait_for([&num_connected]() { return num_connected == 1; });
+            REQUIRE(num_connected == 1);
+        }
+
+        // The reactor keeps running for other connections
+        Connection connection { ws_uri, c_m, io_reactor };
+        connection.connect(10);
+        wait_for([&num_connected]() { return num_connected == 2; });
+        REQUIRE(num_connected == 2);
+    }
+
+    SECTION("a connection can be destroyed by a thread of the reactor") {
+        std::unique_ptr<Connection> connection { new Connection(ws_uri, c_m, io_reactor) };
+        connection->connect(10);
+        wait_for([&num_connected]() { return num_connected == 1; });
+        REQUIRE(num_connected == 1);
+
+        std::atomic<bool> destroyed { false };
+        io_reactor->getIoService().post([&]() {
+            connection.reset();
+            destroyed = true;
+        });
+        wait_for([&destroyed]() { return destroyed.load(); });
+        REQUIRE(destroyed);
+
+        // The reactor keeps running for other connections
+        Connection other_connection { ws_uri, c_m, io_reactor };
+        other_connection.connect(10);
+        wait_for([&num_connected]() { return num_connected == 2; });
+        REQUIRE(num_connected == 2);
+    }
+}
+
 TEST_CASE("Connection::~Connection", "[connection]") {
     SECTION("connect fails with connection timeout < server's processing time") {
         MockServer mock_server;
@@ -0,0 +1,100 @@
+#include "tests/test.hpp"
+#include "tests/unit/connector/connector_utils.hpp"
+
+#include <cpp-pcp-client/connector/io_reactor.hpp>
+#include <cpp-pcp-client/connector/errors.hpp>
+
+#include <cpp-pcp-client/util/chrono.hpp>
+#include <cpp-pcp-client/util/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace PCPClient;
+
+TEST_CASE("IoReactor::IoReactor", "[connector]") {
+    SECTION("throws a connection_config_error if it has no threads") {
+        REQUIRE_THROWS_AS(IoReactor(0), connection_config_error);
+    }
+
+    SECTION("starts the specified number of threads") {
+        IoReactor reactor { 4 };
+
+        REQUIRE(reactor.getNumThreads() == 4);
+    }
+}
+
+TEST_CASE("IoReactor event loop", "[connector]") {
+    static const int NUM_HANDLERS { 1000 };
+    IoReactor reactor { 4 };
+    Util::mutex ids_mutex;
+    std::set<Util::thread::id> thread_ids {};
+    std::atomic<int> num_executed { 0 };
+
+    for (auto idx = 0; idx < NUM_HANDLERS; idx++)
+        reactor.getIoService().post([&]() {
+            {
+                Util::lock_guard<Util::mutex> the_lock { ids_mutex };
+                thread_ids.insert(Util::this_thread::get_id());
+            }
+            num_executed++;
+        });
+
+    wait_for([&]() { return num_executed == NUM_HANDLERS; });
+
+    SECTION("executes the handlers on its own threads") {
+        REQUIRE(num_executed == NUM_HANDLERS);
+        Util::lock_guard<Util::mutex> the_lock { ids_mutex };
+        REQUIRE(thread_ids.size() <= 4);
+        REQUIRE(thread_ids.count(Util::this_thread::get_id()) == 0);
+    }
+
+    SECTION("keeps running after a handler throws") {
+        reactor.getIoService().post([]() { throw std::runtime_error { "test" }; });
+        reactor.getIoService().post([&]() { num_executed++; });
+
+        wait_for([&]() { return num_executed == NUM_HANDLERS + 1; });
+        REQUIRE(num_executed == NUM_HANDLERS + 1);
+    }
+}
+
+TEST_CASE("IoReactor::isEventLoopThread", "[connector]") {
+    IoReactor reactor { 2 };
+    std::atomic<bool> executed { false };
+    std::atomic<bool> in_handler { false };
+
+    reactor.getIoService().post([&]() {
+        in_handler = reactor.isEventLoopThread();
+        executed = true;
+    });
+
+    wait_for([&]() { return executed.load(); });
+
+    REQUIRE(executed);
+    REQUIRE(in_handler);
+    REQUIRE_FALSE(reactor.isEventLoopThread());
+}
+
+TEST_CASE("IoReactor::releaseWhenExpired", "[connector]") {
+    IoReactor reactor { 2 };
+    std::shared_ptr<int> object { new int(42) };
+    std::weak_ptr<int> object_ref { object };
+    std::shared_ptr<int> handle { new int(0) };
+
+    reactor.releaseWhenExpired(std::move(object),
+                               std::vector<std::weak_ptr<void>> { handle });
+
+    SECTION("keeps the object while a handle has not expired") {
+        Util::this_thread::sleep_for(Util::chrono::milliseconds(300));
+        REQUIRE_FALSE(object_ref.expired());
+    }
+
+    SECTION("releases the object once the handles have expired") {
+        handle.reset();
+        wait_for([&]() { return object_ref.expired(); });
+        REQUIRE(object_ref.expired());
+    }
+}
@@ -33,6 +33,7 @@
 
 #include <leatherman/logging/logging.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -120,6 +121,18 @@ void MockServer::set_ping_handler(std::function<bool(websocketpp::connection_hdl
     server_->set_ping_handler(func);
 }
 
+void MockServer::accept_subprotocol(std::string subprotocol)
+{
+    server_->set_validate_handler(
+        [this, subprotocol](websocketpp::connection_hdl hdl) {
+            auto conn = server_->get_con_from_hdl(hdl);
+            const auto& requested = conn->get_requested_subprotocols();
+            if (std::find(requested.begin(), requested.end(), subprotocol) != requested.end())
+                conn->select_subprotocol(subprotocol);
+            return true;
+        });
+}
+
 //
 // Private
 //
@@ -182,7 +195,18 @@ void MockServer::message_handler
 {
     using namespace v2;
     try {
-        Message request { req->get_payload() };
+        auto binary = req->get_opcode() == websocketpp::frame::opcode::binary;
+        auto request = binary ? Message::fromMessagePack(req->get_payload())
+                              : Message { req->get_payload() };
+        auto reply = [&](const Message& response) {
+            if (binary) {
+                auto msgpack = response.toMessagePack();
+                server_->send(hdl, &msgpack[0], msgpack.size(),
+                              websocketpp::frame::opcode::binary);
+            } else {
+                server_->send(hdl, response.toString(), websocketpp::frame::opcode::text);
+            }
+        };
 
         // Expect inventory_request/response or error_message
         auto env = request.getEnvelope();
@@ -195,10 +219,9 @@ void MockServer::message_handler
             env.set<std::string>(ID, "42424242");
             env.set("data", data);
 
-            Message response { env };
-            server_->send(hdl, response.toString(), websocketpp::frame::opcode::text);
+            reply(Message { env });
         } else if (message_type == Protocol::ERROR_MSG_TYPE) {
-            server_->send(hdl, request.toString(), websocketpp::frame::opcode::text);
+            reply(request);
         } else {
             LOG_ERROR("Unknown message type: {1}", message_type);
         }
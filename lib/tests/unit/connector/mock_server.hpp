@@ -55,6 +55,13 @@ public:
     void set_ping_handler(std::function<bool(websocketpp::connection_hdl,
                                              std::string)> func);
 
+    // Select the specified subprotocol when the client requests it;
+    // that replaces the validate handler. In v2, binary messages are
+    // decoded as MessagePack and replied to in MessagePack.
+    // NB: call it before go(), as the server copies the handlers
+    // of a connection when it starts accepting it.
+    void accept_subprotocol(std::string subprotocol);
+
 private:
     std::string certPath_, keyPath_;
     std::unique_ptr<boost::thread> bt_;
@@ -1,4 +1,5 @@
 #include "tests/test.hpp"
+#include "tests/allocation_counter.hpp"
 #include "tests/unit/connector/certs.hpp"
 #include "tests/unit/connector/mock_server.hpp"
 #include "tests/unit/connector/connector_utils.hpp"
@@ -9,6 +10,7 @@
 #include <memory>
 #include <atomic>
 #include <functional>
+#include <utility>
 
 using namespace PCPClient;
 using namespace v1;
@@ -119,3 +121,100 @@ TEST_CASE("v1::Connector::connect", "[connector]") {
         }
     }
 }
+
+// Exposes the onMessage callback, to process messages in this thread;
+// local to this file, as each protocol version's test defines its own
+namespace {
+
+class ProcessingConnector : public Connector {
+  public:
+    using Connector::Connector;
+    using Connector::processMessage;
+};
+
+}  // namespace
+
+TEST_CASE("v1::Connector allocation budget", "[connector]") {
+    // Maximum number of heap allocations made by the calling thread
+    // for a send() call and for a processMessage() call; they must not
+    // depend on the size of the data. NB: the data is parsed lazily,
+    // so that the counts don't include the data DOM, whose
+    // allocations are up to leatherman's JSON parser
+    static const std::size_t SEND_BUDGET { 22 };
+    static const std::size_t PROCESS_ENVELOPE_BUDGET { 35 };
+    static const std::size_t PROCESS_DATA_BUDGET { 43 };
+
+    MockServer mock_server(0, getCertPath(), getKeyPath(), MockServer::Version::v1);
+    mock_server.go();
+    auto port = mock_server.port();
+
+    ProcessingConnector c { "wss://localhost:" + std::to_string(port) + "/pcp",
+                            "test_client",
+                            getCaPath(), getCertPath(), getKeyPath(), getEmptyCrlPath(), "",
+                            WS_TIMEOUT_MS, ASSOCIATION_TIMEOUT_S,
+                            ASSOCIATION_REQUEST_TTL_S,
+                            PONG_TIMEOUTS_BEFORE_RETRY, PONG_TIMEOUT };
+    REQUIRE_NOTHROW(c.connect(1));
+    wait_for([&c](){return c.isAssociated();});
+    REQUIRE(c.isAssociated());
+    c.setLazyDataParsing(true);
+
+    std::atomic<int> num_processed { 0 };
+    c.registerMessageCallback(
+        Schema { "test_message" },
+        [&num_processed](const ParsedChunks&) { num_processed++; });
+
+    EnvelopeTemplate e_t { { "pcp://*/test" },
+                           "test_message",
+                           "pcp://broker/test" };
+
+    // Send a message with data_size bytes of data, then process it
+    // as if it were received; return the allocations of both calls
+    auto countRoundTrip = [&](std::size_t data_size)
+            -> std::pair<std::size_t, std::size_t> {
+        std::string data_txt { data_size > 0
+                               ? "{\"payload\":\"" + std::string(data_size, 'x') + "\"}"
+                               : "" };
+        Message msg { MessageChunk { ChunkDescriptor::ENVELOPE,
+                                     e_t.render("f0e71a48-969c-4377-b953-35f0fc55c388",
+                                                "2099-12-31T23:59:59Z") } };
+
+        if (data_size > 0)
+            msg.setDataChunk(MessageChunk { ChunkDescriptor::DATA, data_txt });
+
+        auto serialized_msg = msg.getSerialized();
+        std::string msg_txt { serialized_msg.begin(), serialized_msg.end() };
+
+        auto num_processed_before = num_processed.load();
+        AllocationCounter counter {};
+        c.send(std::vector<std::string> { "pcp://*/test" },
+               "test_message", 10, data_txt);
+        auto num_send_allocations = counter.getCount();
+
+        counter.reset();
+        c.processMessage(msg_txt);
+        auto num_process_allocations = counter.getCount();
+
+        REQUIRE(num_processed == num_processed_before + 1);
+        return std::make_pair(num_send_allocations, num_process_allocations);
+    };
+
+    SECTION("envelope-only messages stay within the budget") {
+        auto counts = countRoundTrip(0);
+        REQUIRE(counts.first <= SEND_BUDGET);
+        REQUIRE(counts.second <= PROCESS_ENVELOPE_BUDGET);
+    }
+
+    SECTION("small data messages stay within the budget") {
+        auto counts = countRoundTrip(100);
+        REQUIRE(counts.first <= SEND_BUDGET);
+        REQUIRE(counts.second <= PROCESS_DATA_BUDGET);
+    }
+
+    SECTION("large data messages make as many allocations as small ones") {
+        auto small_counts = countRoundTrip(100);
+        auto large_counts = countRoundTrip(4 * 1024 * 1024);
+        REQUIRE(large_counts.first == small_counts.first);
+        REQUIRE(large_counts.second == small_counts.second);
+    }
+}
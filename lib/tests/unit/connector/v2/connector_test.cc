@@ -1,15 +1,28 @@
 #include "tests/test.hpp"
+#include "tests/allocation_counter.hpp"
 #include "tests/unit/connector/certs.hpp"
 #include "tests/unit/connector/mock_server.hpp"
 #include "tests/unit/connector/connector_utils.hpp"
 
 #include <cpp-pcp-client/connector/errors.hpp>
+#include <cpp-pcp-client/connector/io_reactor.hpp>
 #include <cpp-pcp-client/connector/v2/connector.hpp>
+#include <cpp-pcp-client/protocol/v2/msgpack.hpp>
 #include <cpp-pcp-client/protocol/v2/schemas.hpp>
 
+#include <boost/nowide/iostream.hpp>
+
+#define LEATHERMAN_LOGGING_NAMESPACE "puppetlabs.cpp_pcp_client.test"
+#include <leatherman/logging/logging.hpp>
+
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <fstream>
 #include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
 
 using namespace PCPClient;
 using namespace v2;
@@ -152,6 +165,22 @@ TEST_CASE("v2::Connector::send", "[connector]") {
         REQUIRE(response_data == R"({"uris":["pcp://foo/bar"]})");
         REQUIRE(in_reply_to == id);
     }
+
+    SECTION("the JSON text of the data is checked, unless disabled") {
+        Connector c { "wss://localhost:" + std::to_string(port) + "/pcp",
+                      "test_client",
+                      getCaPath(), getCertPath(), getKeyPath(), getEmptyCrlPath(), "",
+                      WS_TIMEOUT_MS,
+                      PONG_TIMEOUTS_BEFORE_RETRY, PONG_TIMEOUT };
+
+        REQUIRE_THROWS_AS(c.send("pcp:///server", "test_message", "{\"a\":"),
+                          lth_jc::data_parse_error);
+
+        c.setDataTextChecking(false);
+
+        REQUIRE_THROWS_AS(c.send("pcp:///server", "test_message", "{\"a\":"),
+                          connection_not_init_error);
+    }
 }
 
 TEST_CASE("v2::Connector::sendError", "[connector]") {
@@ -185,3 +214,217 @@ TEST_CASE("v2::Connector::sendError", "[connector]") {
         REQUIRE(in_reply_to == reply_id);
     }
 }
+
+TEST_CASE("v2::Connector MessagePack encoding", "[connector]") {
+    // NB: the server is started by each section, after configuring it
+    MockServer mock_server(0, getCertPath(), getKeyPath(), MockServer::Version::v2);
+    auto port = mock_server.port();
+    Connector c { "wss://localhost:" + std::to_string(port) + "/pcp",
+                  "test_client",
+                  getCaPath(), getCertPath(), getKeyPath(), getEmptyCrlPath(), "",
+                  WS_TIMEOUT_MS,
+                  PONG_TIMEOUTS_BEFORE_RETRY, PONG_TIMEOUT };
+    std::string response_data, in_reply_to;
+    c.registerMessageCallback(Protocol::InventoryResponseSchema(),
+        [&](const ParsedChunks& chunks) {
+            REQUIRE(chunks.has_data);
+            REQUIRE(!chunks.invalid_data);
+            response_data = chunks.data.toString();
+            in_reply_to = chunks.envelope.get<std::string>("in_reply_to");
+        });
+
+    auto sendInventoryRequest = [&]() {
+        lth_jc::JsonContainer data { R"({"query":["pcp://*/*"]})" };
+        auto id = c.send("pcp:///server", Protocol::INVENTORY_REQ_TYPE, data);
+        wait_for([&](){return !in_reply_to.empty();});
+        // Response hard-coded in MockServer.
+        REQUIRE(response_data == R"({"uris":["pcp://foo/bar"]})");
+        REQUIRE(in_reply_to == id);
+    };
+
+    SECTION("messages are exchanged in MessagePack when the broker selects it") {
+        mock_server.accept_subprotocol(Protocol::MESSAGE_PACK_SUBPROTOCOL);
+        mock_server.go();
+        c.setMessagePackEncoding(true);
+        REQUIRE_NOTHROW(c.connect(1));
+        REQUIRE(c.isUsingMessagePack());
+
+        sendInventoryRequest();
+    }
+
+    SECTION("messages are exchanged in JSON when the broker does not select it") {
+        mock_server.go();
+        c.setMessagePackEncoding(true);
+        REQUIRE_NOTHROW(c.connect(1));
+        REQUIRE_FALSE(c.isUsingMessagePack());
+
+        sendInventoryRequest();
+    }
+
+    SECTION("the encoding cannot be changed once connected") {
+        mock_server.go();
+        REQUIRE_NOTHROW(c.connect(1));
+
+        REQUIRE_THROWS_AS(c.setMessagePackEncoding(true), connection_config_error);
+    }
+}
+
+// Exposes the onMessage callback, to process messages in this thread;
+// local to this file, as each protocol version's test defines its own
+namespace {
+
+class ProcessingConnector : public Connector {
+  public:
+    using Connector::Connector;
+    using Connector::processMessage;
+};
+
+}  // namespace
+
+TEST_CASE("v2::Connector allocation budget", "[connector]") {
+    // Maximum number of heap allocations made by the calling thread
+    // for a send() call and for a processMessage() call; they must not
+    // depend on the size of the data. NB: the data is parsed lazily,
+    // so that the counts don't include the data DOM, whose
+    // allocations are up to leatherman's JSON parser
+    static const std::size_t SEND_BUDGET { 19 };
+    static const std::size_t PROCESS_BUDGET { 32 };
+
+    MockServer mock_server(0, getCertPath(), getKeyPath(), MockServer::Version::v2);
+    mock_server.go();
+    auto port = mock_server.port();
+
+    ProcessingConnector c { "wss://localhost:" + std::to_string(port) + "/pcp",
+                            "test_client",
+                            getCaPath(), getCertPath(), getKeyPath(), getEmptyCrlPath(), "",
+                            WS_TIMEOUT_MS,
+                            PONG_TIMEOUTS_BEFORE_RETRY, PONG_TIMEOUT };
+    REQUIRE_NOTHROW(c.connect(1));
+    REQUIRE(c.isConnected());
+    c.setLazyDataParsing(true);
+
+    std::atomic<int> num_processed { 0 };
+    c.registerMessageCallback(
+        Schema { "test_message" },
+        [&num_processed](const ParsedChunks&) { num_processed++; });
+
+    EnvelopeTemplate e_t { "pcp://client/test", "test_message", "pcp://broker/test" };
+
+    // Send a message with data_size bytes of data, then process it
+    // as if it were received; return the allocations of both calls
+    auto countRoundTrip = [&](std::size_t data_size)
+            -> std::pair<std::size_t, std::size_t> {
+        std::string data_txt { "{\"payload\":\"" + std::string(data_size, 'x') + "\"}" };
+        auto msg_txt = e_t.render("f0e71a48-969c-4377-b953-35f0fc55c388", "", data_txt);
+
+        auto num_processed_before = num_processed.load();
+        AllocationCounter counter {};
+        c.send("pcp://client/test", "test_message", data_txt);
+        auto num_send_allocations = counter.getCount();
+
+        counter.reset();
+        c.processMessage(msg_txt);
+        auto num_process_allocations = counter.getCount();
+
+        REQUIRE(num_processed == num_processed_before + 1);
+        return std::make_pair(num_send_allocations, num_process_allocations);
+    };
+
+    SECTION("empty data messages stay within the budget") {
+        auto counts = countRoundTrip(0);
+        REQUIRE(counts.first <= SEND_BUDGET);
+        REQUIRE(counts.second <= PROCESS_BUDGET);
+    }
+
+    SECTION("small data messages stay within the budget") {
+        auto counts = countRoundTrip(100);
+        REQUIRE(counts.first <= SEND_BUDGET);
+        REQUIRE(counts.second <= PROCESS_BUDGET);
+    }
+
+    SECTION("large data messages make as many allocations as small ones") {
+        auto small_counts = countRoundTrip(100);
+        auto large_counts = countRoundTrip(4 * 1024 * 1024);
+        REQUIRE(large_counts.first == small_counts.first);
+        REQUIRE(large_counts.second == small_counts.second);
+    }
+}
+
+// Return the number of threads of this process, or -1 if unknown
+static int getNumProcessThreads() {
+#ifdef __linux__
+    std::ifstream status { "/proc/self/status" };
+    std::string field;
+
+    while (status >> field) {
+        if (field == "Threads:") {
+            int num_threads;
+            if (status >> num_threads)
+                return num_threads;
+            break;
+        }
+    }
+#endif
+    return -1;
+}
+
+TEST_CASE("v2::Connector shared IoReactor performance", "[.][connector][performance]") {
+    static const int NUM_MESSAGES { 10000 };
+    static const unsigned int NUM_REACTOR_THREADS { 4 };
+
+    MockServer mock_server(0, getCertPath(), getKeyPath(), MockServer::Version::v2);
+    mock_server.go();
+    std::vector<std::string> broker_ws_uris {
+        "wss://localhost:" + std::to_string(mock_server.port()) + "/pcp" };
+    lth_jc::JsonContainer data { R"({"query":["pcp://*/*"]})" };
+
+    auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count()) / 1000000;
+    };
+
+    // Connect num_connections Connectors, with their own event loop
+    // threads or sharing a reactor, then send NUM_MESSAGES inventory
+    // requests, spread across them, and wait for all the responses
+    auto run = [&](int num_connections, bool shared) {
+        std::shared_ptr<IoReactor> io_reactor {
+            shared ? new IoReactor(NUM_REACTOR_THREADS) : nullptr };
+        std::atomic<int> num_responses { 0 };
+        std::vector<std::unique_ptr<Connector>> connectors {};
+
+        for (auto idx = 0; idx < num_connections; idx++) {
+            connectors.emplace_back(new Connector(
+                broker_ws_uris, "test_client",
+                getCaPath(), getCertPath(), getKeyPath(), getEmptyCrlPath(), "",
+                leatherman::logging::log_level::none, &boost::nowide::cout,
+                io_reactor, WS_TIMEOUT_MS, PONG_TIMEOUTS_BEFORE_RETRY, PONG_TIMEOUT));
+            connectors.back()->registerMessageCallback(
+                Protocol::InventoryResponseSchema(),
+                [&num_responses](const ParsedChunks&) { num_responses++; });
+            REQUIRE_NOTHROW(connectors.back()->connect(1));
+        }
+
+        auto num_threads = getNumProcessThreads();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (auto idx = 0; idx < NUM_MESSAGES; idx++)
+            connectors[idx % num_connections]->send(
+                "pcp:///server", Protocol::INVENTORY_REQ_TYPE, data);
+
+        wait_for([&]() { return num_responses == NUM_MESSAGES; }, 60);
+        auto exchange_time = elapsed(start);
+
+        REQUIRE(num_responses == NUM_MESSAGES);
+        std::cout << "  " << num_connections << " connections, "
+                  << (shared ? "shared reactor" : "dedicated threads")
+                  << " - process threads: " << num_threads
+                  << ", requests and responses: "
+                  << static_cast<int>(NUM_MESSAGES / exchange_time) << " per s\n";
+    };
+
+    for (auto num_connections : { 1, 10, 100 }) {
+        run(num_connections, false);
+        run(num_connections, true);
+    }
+}
@@ -0,0 +1,135 @@
+#include "tests/test.hpp"
+
+#include <cpp-pcp-client/protocol/v1/envelope_template.hpp>
+#include <cpp-pcp-client/protocol/v1/schemas.hpp>
+#include <cpp-pcp-client/util/message_stamps.hpp>
+#include <cpp-pcp-client/validator/validator.hpp>
+
+#include <leatherman/json_container/json_container.hpp>
+#include <leatherman/util/strings.hpp>
+#include <leatherman/util/time.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace PCPClient;
+using namespace v1;
+
+namespace lth_jc = leatherman::json_container;
+
+static const std::string ID { "f0e71a48-969c-4377-b953-35f0fc55c388" };
+static const std::string EXPIRES { "2026-10-17T12:34:56.789Z" };
+static const std::string SENDER { "pcp://agent_1/test" };
+static const std::vector<std::string> TARGETS { "pcp://*/server",
+                                                "pcp://agent_2/test" };
+
+TEST_CASE("v1::EnvelopeTemplate::render", "[message]") {
+    EnvelopeTemplate e_t { TARGETS, "test_message", SENDER };
+
+    SECTION("it renders the envelope entries") {
+        lth_jc::JsonContainer envelope { e_t.render(ID, EXPIRES) };
+
+        REQUIRE(envelope.get<std::string>("id") == ID);
+        REQUIRE(envelope.get<std::string>("expires") == EXPIRES);
+        REQUIRE(envelope.get<std::string>("message_type") == "test_message");
+        REQUIRE(envelope.get<std::vector<std::string>>("targets") == TARGETS);
+        REQUIRE(envelope.get<std::string>("sender") == SENDER);
+        REQUIRE_FALSE(envelope.includes("destination_report"));
+    }
+
+    SECTION("the rendered envelope is valid") {
+        Validator validator {};
+        validator.registerSchema(Protocol::EnvelopeSchema());
+
+        REQUIRE_NOTHROW(validator.validate(lth_jc::JsonContainer { e_t.render(ID, EXPIRES) },
+                                           Protocol::ENVELOPE_SCHEMA_NAME));
+    }
+
+    SECTION("it can flag the destination report") {
+        EnvelopeTemplate e_t_report { TARGETS, "test_message", SENDER, true };
+        lth_jc::JsonContainer envelope { e_t_report.render(ID, EXPIRES) };
+
+        REQUIRE(envelope.get<bool>("destination_report"));
+    }
+
+    SECTION("it escapes the constant entries") {
+        EnvelopeTemplate e_t_escaped { TARGETS, "test \"message\"", SENDER };
+        lth_jc::JsonContainer envelope { e_t_escaped.render(ID, EXPIRES) };
+
+        REQUIRE(envelope.get<std::string>("message_type") == "test \"message\"");
+    }
+
+    SECTION("it returns the exact size of the envelope") {
+        REQUIRE(e_t.getEnvelopeSize(ID, EXPIRES) == e_t.render(ID, EXPIRES).size());
+    }
+
+    SECTION("it renders on the given buffer without reallocating it") {
+        std::string buffer {};
+        buffer.reserve(e_t.getEnvelopeSize(ID, EXPIRES));
+        auto buffer_ptr = buffer.data();
+
+        e_t.renderOn(buffer, ID, EXPIRES);
+        e_t.renderOn(buffer, ID, EXPIRES);
+
+        REQUIRE(buffer.data() == buffer_ptr);
+        REQUIRE(buffer == e_t.render(ID, EXPIRES));
+    }
+}
+
+TEST_CASE("v1 envelope creation performance", "[message]") {
+    static const int NUM_ENVELOPES { 100000 };
+    static const unsigned int TIMEOUT { 10 };
+    size_t num_bytes { 0 };
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // As the connector did before envelope templates and stamps
+    for (auto idx = 0; idx < NUM_ENVELOPES; idx++) {
+        lth_jc::JsonContainer envelope {};
+        envelope.set<std::string>("id", leatherman::util::get_UUID());
+        envelope.set<std::string>("message_type", "test_message");
+        envelope.set<std::vector<std::string>>("targets", TARGETS);
+        envelope.set<std::string>("expires",
+                                  leatherman::util::get_ISO8601_time(TIMEOUT));
+        envelope.set<std::string>("sender", SENDER);
+        num_bytes += envelope.toString().size();
+    }
+
+    auto middle = std::chrono::high_resolution_clock::now();
+
+    EnvelopeTemplate e_t { TARGETS, "test_message", SENDER };
+    Util::MessageIdGenerator id_generator {};
+    Util::ExpiryFormatter expiry_formatter {};
+    std::string buffer {};
+
+    for (auto idx = 0; idx < NUM_ENVELOPES; idx++) {
+        char id[Util::MessageIdGenerator::ID_SIZE];
+        char expires[Util::ExpiryFormatter::EXPIRY_SIZE];
+        id_generator.generateOn(id);
+        expiry_formatter.formatOn(TIMEOUT, expires);
+        e_t.renderOn(buffer,
+                     boost::string_ref(id, sizeof(id)),
+                     boost::string_ref(expires, sizeof(expires)));
+        num_bytes += buffer.size();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    REQUIRE(num_bytes > 0);
+
+    for (auto times : { std::make_pair("JsonContainer, get_UUID, get_ISO8601_time", middle - start),
+                        std::make_pair("EnvelopeTemplate and stamps", end - middle) }) {
+        auto execution_time =
+            static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    times.second).count());
+
+        std::cout << "  time to create " << NUM_ENVELOPES << " envelopes ("
+                  << times.first << "): "
+                  << execution_time / (1000 * 1000) << " s ("
+                  << static_cast<int>((NUM_ENVELOPES / execution_time) * (1000 * 1000))
+                  << " envelopes/s)\n";
+    }
+}
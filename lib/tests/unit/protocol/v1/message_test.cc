@@ -2,8 +2,12 @@
 
 #include <cpp-pcp-client/protocol/v1/message.hpp>
 #include <cpp-pcp-client/protocol/v1/errors.hpp>
+#include <cpp-pcp-client/protocol/v1/schemas.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <stdint.h>
 #include <chrono>
@@ -325,6 +329,132 @@ TEST_CASE("v1::Message::Message - failure cases", "[message]") {
     }
 }
 
+TEST_CASE("v1::MessageView - parsing", "[message]") {
+    SECTION("it refers to the chunks in place") {
+        auto msg_s = vecToStr(msg_buffer_valid, { data_chunk_buffer_valid,
+                                                  debug_chunk_buffer_valid_1,
+                                                  debug_chunk_buffer_valid_2 });
+        MessageView msg_view { msg_s };
+        REQUIRE(msg_view.getVersion() == 0x01);
+        REQUIRE(msg_view.hasData());
+        REQUIRE(msg_view.hasDebug());
+
+        auto envelope = msg_view.getEnvelopeChunk();
+        REQUIRE(envelope.descriptor == 0x01);
+        REQUIRE(envelope.content == "header");
+        REQUIRE(envelope.content.data() == msg_s.data() + 6);
+
+        auto data = msg_view.getDataChunk();
+        REQUIRE(data.descriptor == 0x02);
+        REQUIRE(data.content == "stuff");
+        REQUIRE(data.content.data() == msg_s.data() + 17);
+
+        const auto& debug = msg_view.getDebugChunks();
+        REQUIRE(debug.size() == 2);
+        REQUIRE(debug[0].descriptor == 0x03);
+        REQUIRE(debug[0].content == "errors");
+        REQUIRE(debug[1].descriptor == 0x13);
+        REQUIRE(debug[1].content == "stats");
+    }
+
+    SECTION("it parses a message that has only the envelope") {
+        auto msg_s = vecToStr(msg_buffer_valid);
+        MessageView msg_view { msg_s };
+        REQUIRE_FALSE(msg_view.hasData());
+        REQUIRE_FALSE(msg_view.hasDebug());
+        REQUIRE(msg_view.toString() == Message(msg_s).toString());
+    }
+
+    SECTION("it fails as Message does") {
+        SerializedMessage msg_buffer_bad = msg_buffer_valid;
+        msg_buffer_bad[0] = { 0xFF };
+        REQUIRE_THROWS_AS(MessageView { vecToStr(msg_buffer_bad) },
+                          unsupported_version_error);
+
+        msg_buffer_bad = msg_buffer_valid;
+        msg_buffer_bad[5] = { 0x10 };
+        REQUIRE_THROWS_AS(MessageView { vecToStr(msg_buffer_bad) },
+                          message_serialization_error);
+
+        REQUIRE_THROWS_AS(MessageView { vecToStr(msg_buffer_valid,
+                                                 { data_chunk_buffer_valid,
+                                                   data_chunk_buffer_valid }) },
+                          message_serialization_error);
+    }
+}
+
+TEST_CASE("v1::MessageView::getParsedChunks", "[message]") {
+    Validator validator {};
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Protocol::DebugSchema());
+    validator.registerSchema(Protocol::DebugItemSchema());
+    Schema data_schema { "some_schema" };
+    data_schema.addConstraint("title", TypeConstraint::String, true);
+    validator.registerSchema(data_schema);
+
+    Message msg {
+        MessageChunk { 0x01,
+            "{\"id\" : \"123\", "
+            "\"message_type\" : \"some_schema\", "
+            "\"expires\" : \"2015-06-26T22:57:09Z\", "
+            "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+            "\"sender\" : \"pcp://client02.example.com/agent\"}" },
+        MessageChunk { 0x02, "{\"title\" : \"Help\"}" },
+        MessageChunk { 0x03,
+            "{\"hops\" : [{\"server\" : \"pcp://broker.example.com/server\", "
+            "\"time\" : \"2015-06-26T22:57:09Z\"}]}" } };
+    auto serialized_msg = msg.getSerialized();
+    std::string msg_s { serialized_msg.begin(), serialized_msg.end() };
+    MessageView msg_view { msg_s };
+
+    SECTION("it returns the chunks that Message returns") {
+        auto parsed_chunks = msg_view.getParsedChunks(validator);
+        auto expected_chunks = msg.getParsedChunks(validator);
+        REQUIRE(parsed_chunks.toString() == expected_chunks.toString());
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+        REQUIRE(parsed_chunks.debug.size() == 1);
+    }
+
+    SECTION("it parses the envelope only once") {
+        auto envelope_ptr = &msg_view.getEnvelope();
+        auto envelope_fields = msg_view.validateEnvelope(validator);
+        REQUIRE(envelope_fields.id == "123");
+        msg_view.getParsedChunks(validator, envelope_fields);
+        msg_view.getParsedChunks(validator);
+        REQUIRE(&msg_view.getEnvelope() == envelope_ptr);
+    }
+
+    SECTION("lazy chunks don't refer to the payload") {
+        auto envelope_fields = msg_view.validateEnvelope(validator);
+        auto parsed_chunks = msg_view.getParsedChunks(validator, envelope_fields,
+                                                      true, DebugChunkPolicy::Lazy);
+        msg_s.assign(msg_s.size(), '\0');
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+        REQUIRE(parsed_chunks.getDebug().size() == 1);
+    }
+
+    SECTION("lazy chunks share the ownership of a shared payload") {
+        auto payload = std::make_shared<const std::string>(msg_s);
+        std::weak_ptr<const std::string> payload_ref { payload };
+        ParsedChunks parsed_chunks {};
+
+        {
+            MessageView shared_view { *payload, payload };
+            auto envelope_fields = shared_view.validateEnvelope(validator);
+            parsed_chunks = shared_view.getParsedChunks(validator, envelope_fields,
+                                                        true, DebugChunkPolicy::Lazy);
+        }
+
+        payload.reset();
+        REQUIRE_FALSE(payload_ref.expired());
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+        REQUIRE(parsed_chunks.getDebug().size() == 1);
+
+        parsed_chunks = ParsedChunks {};
+        REQUIRE(payload_ref.expired());
+    }
+}
+
 TEST_CASE("v1::Message modifiers", "[message]") {
     Message msg { vecToStr(msg_buffer_valid) };
 
@@ -395,6 +525,58 @@ TEST_CASE("v1::Message modifiers", "[message]") {
     }
 }
 
+TEST_CASE("v1::Message - moving chunks", "[message]") {
+    // Large enough to be heap allocated; moved strings keep the buffer
+    std::string data(1024 * 1024, 'x');
+    auto data_ptr = data.data();
+
+    SECTION("MessageChunk moves its content") {
+        MessageChunk d_c { ChunkDescriptor::DATA, std::move(data) };
+
+        REQUIRE(d_c.size == 1024 * 1024);
+        REQUIRE(d_c.content.data() == data_ptr);
+    }
+
+    SECTION("the ctors move the chunks into the message") {
+        Message msg { envelope_chunk,
+                      MessageChunk { ChunkDescriptor::DATA, std::move(data) } };
+
+        REQUIRE(msg.getDataChunk().content.data() == data_ptr);
+    }
+
+    SECTION("the modifiers move the chunks into the message") {
+        Message msg { envelope_chunk };
+        msg.setDataChunk(MessageChunk { ChunkDescriptor::DATA, std::move(data) });
+
+        REQUIRE(msg.getDataChunk().content.data() == data_ptr);
+    }
+
+    SECTION("a message can be moved without copying its chunks") {
+        Message msg { envelope_chunk,
+                      MessageChunk { ChunkDescriptor::DATA, std::move(data) } };
+        Message moved_msg { std::move(msg) };
+
+        REQUIRE(moved_msg.getDataChunk().content.data() == data_ptr);
+    }
+
+    SECTION("the data chunk can be moved out of the message") {
+        Message msg { envelope_chunk,
+                      MessageChunk { ChunkDescriptor::DATA, std::move(data) } };
+        auto d_c = msg.releaseDataChunk();
+
+        REQUIRE(d_c.content.data() == data_ptr);
+        REQUIRE_FALSE(msg.hasData());
+    }
+
+    SECTION("the getters don't copy the chunks") {
+        Message msg { envelope_chunk,
+                      MessageChunk { ChunkDescriptor::DATA, std::move(data) } };
+
+        REQUIRE(&msg.getDataChunk() == &msg.getDataChunk());
+        REQUIRE(msg.getDataChunk().content.data() == data_ptr);
+    }
+}
+
 static const MessageChunk e_c { 0x01, 6, "header" };
 static const MessageChunk da_c { 0x02, 5, "stuff" };
 static const MessageChunk db_c_1 { 0x03, 6, "errors" };
@@ -475,13 +657,320 @@ TEST_CASE("v1::Message::getSerialized", "[message]") {
     }
 }
 
+TEST_CASE("v1::Message::serializeOn", "[message]") {
+    Message msg { e_c, da_c };
+    msg.addDebugChunk(db_c_1);
+    auto expected_buffer = msg.getSerialized();
+
+    SECTION("it returns the exact size of the serialized message") {
+        REQUIRE(msg.getSerializedSize() == expected_buffer.size());
+    }
+
+    SECTION("it serializes the message on a caller buffer") {
+        std::vector<uint8_t> buffer(expected_buffer.size() + 10, 0xFF);
+        REQUIRE(msg.serializeOn(buffer.data(), buffer.size())
+                == expected_buffer.size());
+        REQUIRE(std::equal(expected_buffer.begin(), expected_buffer.end(),
+                           buffer.begin()));
+        REQUIRE(buffer[expected_buffer.size()] == 0xFF);
+    }
+
+    SECTION("it throws a message_serialization_error if the buffer is too small") {
+        std::vector<uint8_t> buffer(expected_buffer.size() - 1);
+        REQUIRE_THROWS_AS(msg.serializeOn(buffer.data(), buffer.size()),
+                          message_serialization_error);
+    }
+}
+
+TEST_CASE("v1::Message::getFrameBuffers", "[message]") {
+    Message msg { e_c, da_c };
+    msg.addDebugChunk(db_c_1);
+    auto expected_buffer = msg.getSerialized();
+    auto frame_buffers = msg.getFrameBuffers();
+
+    SECTION("it returns the size of the serialized message") {
+        REQUIRE(frame_buffers.size() == expected_buffer.size());
+    }
+
+    SECTION("the buffers concatenate to the serialized message") {
+        std::string frame {};
+
+        for (const auto& buffer : frame_buffers.getBuffers())
+            frame.append(buffer.data(), buffer.size());
+
+        REQUIRE(frame == std::string(expected_buffer.begin(),
+                                     expected_buffer.end()));
+    }
+
+    SECTION("the chunk contents are not copied") {
+        FrameBuffers fb { Message::getCurrentVersion() };
+        fb.addChunk(ChunkDescriptor::ENVELOPE, e_c.content);
+        fb.addChunk(ChunkDescriptor::DATA, da_c.content);
+        auto buffers = fb.getBuffers();
+
+        // version, envelope header, envelope, data header, data
+        REQUIRE(buffers.size() == 5);
+        REQUIRE(buffers[2].data() == e_c.content.data());
+        REQUIRE(buffers[4].data() == da_c.content.data());
+    }
+
+    SECTION("it can be built from strings owned by the caller") {
+        FrameBuffers fb { Message::getCurrentVersion() };
+        fb.addChunk(ChunkDescriptor::ENVELOPE, e_c.content);
+        fb.addChunk(ChunkDescriptor::DATA, da_c.content);
+        fb.addChunk(ChunkDescriptor::DEBUG, db_c_1.content);
+        std::string frame {};
+
+        for (const auto& buffer : fb.getBuffers())
+            frame.append(buffer.data(), buffer.size());
+
+        REQUIRE(fb.size() == expected_buffer.size());
+        REQUIRE(frame == std::string(expected_buffer.begin(),
+                                     expected_buffer.end()));
+    }
+}
+
 // TODO(ale): convert the old DataParser::parseAndValidateChunk tests
 // to Message::getParsedChunks
 
+TEST_CASE("v1::Message::validateEnvelope", "[message]") {
+    Validator validator {};
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Protocol::DebugSchema());
+    validator.registerSchema(Protocol::DebugItemSchema());
+    validator.registerSchema(Protocol::AssociateResponseSchema());
+
+    static const MessageChunk valid_envelope { 0x01,
+        "{\"id\" : \"123\", "
+        "\"message_type\" : \"http://puppetlabs.com/associate_response\", "
+        "\"expires\" : \"2015-06-26T22:57:09Z\", "
+        "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+        "\"sender\" : \"pcp:///server\"}" };
+
+    SECTION("it returns the entries needed to route the message") {
+        auto envelope_fields = Message(valid_envelope).validateEnvelope(validator);
+        REQUIRE(envelope_fields.id == "123");
+        REQUIRE(envelope_fields.message_type
+                == "http://puppetlabs.com/associate_response");
+        REQUIRE(envelope_fields.sender == "pcp:///server");
+    }
+
+    SECTION("it throws a validation_error in case of invalid envelope") {
+        MessageChunk bad_envelope { 0x01, "{\"id\" : \"123\"}" };
+        REQUIRE_THROWS_AS(Message(bad_envelope).validateEnvelope(validator),
+                          validation_error);
+    }
+
+    SECTION("it throws a data_parse_error in case of invalid JSON text") {
+        MessageChunk bad_envelope { 0x01, "{\"id\" : " };
+        REQUIRE_THROWS_AS(Message(bad_envelope).validateEnvelope(validator),
+                          lth_jc::data_parse_error);
+    }
+
+    SECTION("getParsedChunks can then parse the chunks") {
+        MessageChunk data { 0x02, "{\"id\" : \"122\", \"success\" : true}" };
+        Message msg { valid_envelope, data };
+        auto parsed_chunks = msg.getParsedChunks(validator,
+                                                 msg.validateEnvelope(validator));
+        REQUIRE(parsed_chunks.envelope.get<std::string>("id") == "123");
+        REQUIRE(parsed_chunks.has_data);
+        REQUIRE_FALSE(parsed_chunks.invalid_data);
+        REQUIRE(parsed_chunks.data.get<std::string>("id") == "122");
+    }
+
+    SECTION("getParsedChunks reports invalid data") {
+        MessageChunk data { 0x02, "{\"id\" : \"122\"}" };
+        Message msg { valid_envelope, data };
+        auto parsed_chunks = msg.getParsedChunks(validator,
+                                                 msg.validateEnvelope(validator));
+        REQUIRE(parsed_chunks.has_data);
+        REQUIRE(parsed_chunks.invalid_data);
+    }
+}
+
+static unsigned int num_song_validations { 0 };
+
+static bool validateSong(const lth_jc::JsonContainer& data) {
+    num_song_validations++;
+    return data.includes("title");
+}
+
+TEST_CASE("v1::Message::getParsedChunks - lazy data", "[message]") {
+    Validator validator {};
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerCompiledSchema("song", validateSong);
+    num_song_validations = 0;
+
+    static const MessageChunk song_envelope { 0x01,
+        "{\"id\" : \"123\", "
+        "\"message_type\" : \"song\", "
+        "\"expires\" : \"2015-06-26T22:57:09Z\", "
+        "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+        "\"sender\" : \"pcp://client02.example.com/agent\"}" };
+
+    SECTION("the data is parsed and validated once, when first accessed") {
+        Message msg { song_envelope, MessageChunk { 0x02, "{\"title\" : \"Help\"}" } };
+        auto parsed_chunks = msg.getParsedChunks(validator,
+                                                 msg.validateEnvelope(validator),
+                                                 true);
+        REQUIRE(parsed_chunks.has_data);
+        REQUIRE(parsed_chunks.data_type == ContentType::Json);
+        REQUIRE(num_song_validations == 0);
+
+        auto parsed_chunks_copy = parsed_chunks;
+        REQUIRE(parsed_chunks_copy.getData().get<std::string>("title") == "Help");
+        REQUIRE_FALSE(parsed_chunks.hasInvalidData());
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+        REQUIRE(num_song_validations == 1);
+    }
+
+    SECTION("invalid data is reported when first accessed") {
+        Message msg { song_envelope, MessageChunk { 0x02, "{\"artist\" : \"Yes\"}" } };
+        auto parsed_chunks = msg.getParsedChunks(validator,
+                                                 msg.validateEnvelope(validator),
+                                                 true);
+        REQUIRE(parsed_chunks.hasInvalidData());
+        REQUIRE(parsed_chunks.getData().empty());
+        REQUIRE(parsed_chunks.toString().find("INVALID") != std::string::npos);
+    }
+
+    SECTION("the data outlives the message") {
+        std::unique_ptr<Message> msg_ptr {
+            new Message(song_envelope, MessageChunk { 0x02, "{\"title\" : \"Help\"}" }) };
+        auto parsed_chunks = msg_ptr->getParsedChunks(
+            validator, msg_ptr->validateEnvelope(validator), true);
+        msg_ptr.reset();
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+    }
+
+    SECTION("the eager data is accessible as well") {
+        Message msg { song_envelope, MessageChunk { 0x02, "{\"title\" : \"Help\"}" } };
+        auto parsed_chunks = msg.getParsedChunks(validator,
+                                                 msg.validateEnvelope(validator));
+        REQUIRE(num_song_validations == 1);
+        REQUIRE_FALSE(parsed_chunks.hasInvalidData());
+        REQUIRE(parsed_chunks.getData().get<std::string>("title") == "Help");
+    }
+}
+
+TEST_CASE("v1::Message::getParsedChunks - debug chunk policy", "[message]") {
+    Validator validator {};
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Protocol::DebugSchema());
+    validator.registerSchema(Protocol::DebugItemSchema());
+
+    static const MessageChunk envelope { 0x01,
+        "{\"id\" : \"123\", "
+        "\"message_type\" : \"some_schema\", "
+        "\"expires\" : \"2015-06-26T22:57:09Z\", "
+        "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+        "\"sender\" : \"pcp://client02.example.com/agent\"}" };
+    static const MessageChunk valid_debug { 0x03,
+        "{\"hops\" : [{\"server\" : \"pcp://broker.example.com/server\", "
+        "\"time\" : \"2015-06-26T22:57:09Z\", \"stage\" : \"accepted\"}]}" };
+    static const MessageChunk invalid_debug { 0x03,
+        "{\"hops\" : [{\"server\" : \"pcp://broker.example.com/server\"}]}" };
+
+    Message msg { envelope };
+    msg.addDebugChunk(valid_debug);
+    msg.addDebugChunk(invalid_debug);
+    msg.addDebugChunk(MessageChunk { 0x03, "not JSON" });
+    auto envelope_fields = msg.validateEnvelope(validator);
+
+    SECTION("eager: the debug chunks are parsed and validated") {
+        auto parsed_chunks = msg.getParsedChunks(validator, envelope_fields,
+                                                 false, DebugChunkPolicy::Eager);
+        REQUIRE(parsed_chunks.debug.size() == 1);
+        REQUIRE(parsed_chunks.num_invalid_debug == 2);
+        REQUIRE(parsed_chunks.num_skipped_debug == 0);
+        REQUIRE(parsed_chunks.getDebug().size() == 1);
+        REQUIRE(parsed_chunks.getNumInvalidDebug() == 2);
+    }
+
+    SECTION("lazy: the debug chunks are parsed and validated when accessed") {
+        auto parsed_chunks = msg.getParsedChunks(validator, envelope_fields,
+                                                 false, DebugChunkPolicy::Lazy);
+        REQUIRE(parsed_chunks.debug.empty());
+        REQUIRE(parsed_chunks.num_invalid_debug == 0);
+
+        auto parsed_chunks_copy = parsed_chunks;
+        REQUIRE(parsed_chunks_copy.getNumInvalidDebug() == 2);
+        REQUIRE(parsed_chunks.getDebug().size() == 1);
+        REQUIRE(parsed_chunks.getDebug()[0].get<std::vector<lth_jc::JsonContainer>>("hops")
+                    .size() == 1);
+        REQUIRE(parsed_chunks.num_skipped_debug == 0);
+    }
+
+    SECTION("skip: the debug chunks are only counted") {
+        auto parsed_chunks = msg.getParsedChunks(validator, envelope_fields,
+                                                 false, DebugChunkPolicy::Skip);
+        REQUIRE(parsed_chunks.getDebug().empty());
+        REQUIRE(parsed_chunks.getNumInvalidDebug() == 0);
+        REQUIRE(parsed_chunks.num_skipped_debug == 3);
+    }
+
+    SECTION("the default policy is eager") {
+        auto parsed_chunks = msg.getParsedChunks(validator);
+        REQUIRE(parsed_chunks.debug.size() == 1);
+        REQUIRE(parsed_chunks.num_invalid_debug == 2);
+    }
+}
+
 //
 // Performance
 //
 
+TEST_CASE("v1::Message serialization performance by data size", "[message]") {
+    static const MessageChunk envelope { 0x01,
+        "{\"id\" : \"123\", "
+        "\"message_type\" : \"some_schema\", "
+        "\"expires\" : \"2015-06-26T22:57:09Z\", "
+        "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+        "\"sender\" : \"pcp://client02.example.com/agent\"}" };
+
+    // Data size [byte] - number of messages
+    std::vector<std::pair<size_t, int>> cases {
+        { 1024, 100000 }, { 64 * 1024, 2000 }, { 8 * 1024 * 1024, 20 } };
+
+    for (const auto& c : cases) {
+        Message msg { envelope, MessageChunk { 0x02, std::string(c.first, 'x') } };
+        auto num_msg = c.second;
+        std::vector<uint8_t> buffer(msg.getSerializedSize());
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (auto idx = 0; idx < num_msg; idx++) {
+            if (msg.getSerialized().size() != buffer.size()) {
+                FAIL("serialization failure");
+            }
+        }
+
+        auto middle = std::chrono::high_resolution_clock::now();
+
+        for (auto idx = 0; idx < num_msg; idx++) {
+            if (msg.serializeOn(buffer.data(), buffer.size()) != buffer.size()) {
+                FAIL("serialization failure");
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+
+        for (auto times : { std::make_pair("getSerialized", middle - start),
+                            std::make_pair("serializeOn a caller buffer", end - middle) }) {
+            auto execution_time =
+                static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        times.second).count());
+
+            std::cout << "  time to serialize (" << times.first << ") " << num_msg
+                      << " messages with " << c.first << " bytes of data: "
+                      << execution_time / (1000 * 1000) << " s ("
+                      << static_cast<int>((num_msg / execution_time) * (1000 * 1000))
+                      << " msg/s)\n";
+        }
+    }
+}
+
 TEST_CASE("v1::Message serialization and parsing performance", "[message]") {
     static const std::string big_txt {
         "a 1019 bytes txt:\n"
@@ -551,6 +1040,22 @@ TEST_CASE("v1::Message serialization and parsing performance", "[message]") {
         }
     }
 
+    SECTION("parse " + std::to_string(num_msg) + " messages with 3 chunks "
+            "of 1024 bytes in place") {
+        current_test = "parse in place";
+        auto big_txt_size = big_txt.size();
+
+        for (auto idx = 0; idx < num_msg; idx++) {
+            MessageView msg_view { big_raw_message };
+
+            if (msg_view.getEnvelopeChunk().content.size() != big_txt_size
+                || msg_view.getDataChunk().content.size() != big_txt_size
+                || msg_view.getDebugChunks()[0].content.size() != big_txt_size) {
+                FAIL("parsing failure");
+            }
+        }
+    }
+
     auto execution_time =
         static_cast<double>(
             std::chrono::duration_cast<std::chrono::microseconds>(
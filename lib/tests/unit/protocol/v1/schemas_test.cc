@@ -1,4 +1,5 @@
 #include "tests/test.hpp"
+#include "tests/unit/validator/validator_utils.hpp"
 
 #include <cpp-pcp-client/protocol/v1/schemas.hpp>
 
@@ -8,3 +9,74 @@ using namespace v1;
 TEST_CASE("AssociateResponseSchema", "[message]") {
     REQUIRE_NOTHROW(Protocol::AssociateResponseSchema());
 }
+
+TEST_CASE("v1 native validators", "[message]") {
+    SECTION("EnvelopeSchema has a native validator") {
+        REQUIRE(Protocol::EnvelopeSchema().getNativeValidator() != nullptr);
+    }
+
+    SECTION("EnvelopeSchema's native validator agrees with valijson") {
+        auto documents = generateDocuments({
+            { "id", "\"123456\"" },
+            { "message_type", "\"http://puppetlabs.com/spam\"" },
+            { "expires", "\"2015-06-26T22:57:09Z\"" },
+            { "targets", "[\"pcp://*/agent\"]" },
+            { "sender", "\"pcp://client01.example.com/test\"" },
+            { "destination_report", "true" },
+            { "in-reply-to", "\"123455\"" } });
+
+        REQUIRE(getDisagreements(Protocol::EnvelopeSchema(), documents).empty());
+    }
+
+    SECTION("DebugSchema's native validator agrees with valijson") {
+        auto documents = generateDocuments({
+            { "hops", "[{\"server\" : \"pcp://broker/server\", "
+                      "\"time\" : \"2015-06-26T22:57:09Z\"}]" } });
+
+        REQUIRE(getDisagreements(Protocol::DebugSchema(), documents).empty());
+    }
+
+    SECTION("DebugItemSchema's native validator agrees with valijson") {
+        auto documents = generateDocuments({
+            { "server", "\"pcp://broker/server\"" },
+            { "time", "\"2015-06-26T22:57:09Z\"" },
+            { "stage", "\"accepted\"" } });
+
+        REQUIRE(getDisagreements(Protocol::DebugItemSchema(), documents).empty());
+    }
+}
+
+TEST_CASE("v1 streaming validation", "[message]") {
+    SECTION("EnvelopeSchema's streaming validation agrees with valijson") {
+        auto documents = generateDocuments({
+            { "id", "\"123456\"" },
+            { "message_type", "\"http://puppetlabs.com/spam\"" },
+            { "expires", "\"2015-06-26T22:57:09Z\"" },
+            { "targets", "[\"pcp://*/agent\"]" },
+            { "sender", "\"pcp://client01.example.com/test\"" },
+            { "destination_report", "true" },
+            { "in-reply-to", "\"123455\"" } });
+
+        REQUIRE(getStreamingDisagreements(Protocol::EnvelopeSchema(),
+                                          documents).empty());
+    }
+
+    SECTION("DebugSchema's streaming validation agrees with valijson") {
+        auto documents = generateDocuments({
+            { "hops", "[{\"server\" : \"pcp://broker/server\", "
+                      "\"time\" : \"2015-06-26T22:57:09Z\"}]" } });
+
+        REQUIRE(getStreamingDisagreements(Protocol::DebugSchema(),
+                                          documents).empty());
+    }
+
+    SECTION("AssociateResponseSchema's streaming validation agrees with valijson") {
+        auto documents = generateDocuments({
+            { "id", "\"123456\"" },
+            { "success", "false" },
+            { "reason", "\"no reason\"" } });
+
+        REQUIRE(getStreamingDisagreements(Protocol::AssociateResponseSchema(),
+                                          documents).empty());
+    }
+}
@@ -4,11 +4,29 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 using namespace PCPClient;
 using namespace v1;
 
+TEST_CASE("PCPClient::writeChunkHeader", "[message]") {
+    SECTION("can write the descriptor and the size in network byte order") {
+        uint8_t header[CHUNK_HEADER_SIZE];
+        auto end_ptr = writeChunkHeader(0x13, 271828, header);
+
+        REQUIRE(end_ptr == header + CHUNK_HEADER_SIZE);
+        REQUIRE(std::vector<uint8_t>(header, end_ptr)
+                == std::vector<uint8_t>({ 0x13, 0, 0x4, 0x25, 0xD4 }));
+    }
+
+    SECTION("the encoding is constexpr") {
+        static_assert(getNetworkByte(0x01020304, 0) == 0x01, "most significant");
+        static_assert(getNetworkByte(0x01020304, 3) == 0x04, "least significant");
+        static_assert(getSerializedChunkSize(1024) == 1029, "chunk size");
+    }
+}
+
 TEST_CASE("PCPClient::serialize", "[message]") {
     SECTION("can serialize a string") {
         std::string s { "lalala" };
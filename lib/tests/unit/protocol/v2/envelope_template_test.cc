@@ -0,0 +1,191 @@
+#include "tests/test.hpp"
+
+#include <cpp-pcp-client/protocol/v2/envelope_template.hpp>
+#include <cpp-pcp-client/protocol/v2/message.hpp>
+#include <cpp-pcp-client/protocol/v2/schemas.hpp>
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace PCPClient;
+using namespace v2;
+
+namespace lth_jc = leatherman::json_container;
+
+static const std::string ID { "f0e71a48-969c-4377-b953-35f0fc55c388" };
+static const std::string IN_REPLY_TO { "a8c3e5e6-50a5-4c3e-b5a2-0f1bbde23a8e" };
+static const std::string SENDER { "pcp://agent_1/test" };
+static const std::string TARGET { "pcp://agent_2/test" };
+
+TEST_CASE("v2::quoteJsonString", "[message]") {
+    SECTION("it quotes and escapes the string") {
+        REQUIRE(quoteJsonString("an \"error\"\n") == "\"an \\\"error\\\"\\n\"");
+    }
+
+    SECTION("the result is a valid JSON string with the same value") {
+        std::string description { "bad \\ stuff\t\x01 happened" };
+        lth_jc::JsonContainer data { "{\"error\":" + quoteJsonString(description) + "}" };
+
+        REQUIRE(data.get<std::string>("error") == description);
+    }
+}
+
+TEST_CASE("v2::EnvelopeTemplate::render", "[message]") {
+    EnvelopeTemplate e_t { TARGET, "test_message", SENDER };
+
+    SECTION("it renders the message entries") {
+        Message msg { e_t.render(ID, IN_REPLY_TO, R"({"foo":["bar","baz"]})") };
+        auto envelope = msg.getEnvelope();
+
+        REQUIRE(envelope.get<std::string>("id") == ID);
+        REQUIRE(envelope.get<std::string>("in_reply_to") == IN_REPLY_TO);
+        REQUIRE(envelope.get<std::string>("message_type") == "test_message");
+        REQUIRE(envelope.get<std::string>("target") == TARGET);
+        REQUIRE(envelope.get<std::string>("sender") == SENDER);
+        REQUIRE(envelope.get<lth_jc::JsonContainer>("data").get<std::vector<std::string>>("foo")
+                == std::vector<std::string>({ "bar", "baz" }));
+    }
+
+    SECTION("it omits an empty in_reply_to") {
+        lth_jc::JsonContainer envelope { e_t.render(ID, "", "null") };
+
+        REQUIRE_FALSE(envelope.includes("in_reply_to"));
+        REQUIRE(envelope.type("data") == lth_jc::DataType::Null);
+    }
+
+    SECTION("it escapes in_reply_to") {
+        std::string in_reply_to { "a \"quoted\" \\ id\n\x01" };
+        lth_jc::JsonContainer envelope { e_t.render(ID, in_reply_to, "{}") };
+
+        REQUIRE(envelope.get<std::string>("in_reply_to") == in_reply_to);
+    }
+
+    SECTION("it returns the exact size of the message") {
+        std::string in_reply_to { "a \"quoted\" id\t\x1f" };
+
+        REQUIRE(e_t.getMessageSize(ID, in_reply_to, "{}")
+                == e_t.render(ID, in_reply_to, "{}").size());
+        REQUIRE(e_t.getMessageSize(ID, "", "{}")
+                == e_t.render(ID, "", "{}").size());
+    }
+
+    SECTION("it renders on the given buffer without reallocating it") {
+        std::string buffer {};
+        buffer.reserve(e_t.getMessageSize(ID, IN_REPLY_TO, "[true]"));
+        auto buffer_ptr = buffer.data();
+
+        e_t.renderOn(buffer, ID, IN_REPLY_TO, "[true]");
+        e_t.renderOn(buffer, ID, IN_REPLY_TO, "[true]");
+
+        REQUIRE(buffer.data() == buffer_ptr);
+        REQUIRE(buffer == e_t.render(ID, IN_REPLY_TO, "[true]"));
+    }
+}
+
+TEST_CASE("v2::EnvelopeTemplate::renderJson", "[message]") {
+    EnvelopeTemplate e_t { TARGET, "test_message", SENDER };
+    lth_jc::JsonContainer data { R"({"foo":["bar","baz"],"n":42,"esc":"a\"b"})" };
+
+    SECTION("it renders the same message as render does with the serialized data") {
+        REQUIRE(e_t.renderJson(ID, IN_REPLY_TO, data)
+                == e_t.render(ID, IN_REPLY_TO, data.toString()));
+        REQUIRE(e_t.renderJson(ID, "", data)
+                == e_t.render(ID, "", data.toString()));
+    }
+
+    SECTION("it replaces the content of the given buffer") {
+        std::string buffer { "garbage" };
+        e_t.renderJsonOn(buffer, ID, IN_REPLY_TO, data);
+
+        Message msg { buffer };
+        REQUIRE(msg.getEnvelope().get<lth_jc::JsonContainer>("data").get<int>("n") == 42);
+    }
+}
+
+//
+// Performance
+//
+
+TEST_CASE("v2::EnvelopeTemplate::renderBinary", "[message]") {
+    EnvelopeTemplate e_t { TARGET, "file_chunk", SENDER };
+    std::string binary_data { "\x00\x01\xfe\xff binary data", 16 };
+
+    SECTION("it renders the data as a base64 string") {
+        Message msg { e_t.renderBinary(ID, IN_REPLY_TO, binary_data) };
+        auto envelope = msg.getEnvelope();
+
+        REQUIRE(envelope.get<std::string>("data") == "AAH+/yBiaW5hcnkgZGF0YQ==");
+        REQUIRE(envelope.get<std::string>("in_reply_to") == IN_REPLY_TO);
+    }
+
+    SECTION("it allocates the exact size") {
+        auto msg_txt = e_t.renderBinary(ID, "", binary_data);
+
+        REQUIRE(msg_txt.size() == msg_txt.capacity());
+    }
+
+    SECTION("the data is decoded for binary schemas") {
+        Validator validator {};
+        validator.registerSchema(Protocol::EnvelopeSchema());
+        validator.registerSchema(Schema { "file_chunk", ContentType::Binary });
+        auto chunks = Message(e_t.renderBinary(ID, "", binary_data))
+                          .getParsedChunks(validator);
+
+        REQUIRE(chunks.data_type == ContentType::Binary);
+        REQUIRE(chunks.binary_data == binary_data);
+    }
+}
+
+TEST_CASE("v2 envelope streaming performance", "[message]") {
+    EnvelopeTemplate e_t { TARGET, "test_message", SENDER };
+
+    // The envelope as built before the templates: entry by entry in
+    // a DOM, with a deep copy of the data, then serialized
+    auto buildWithDom = [](const lth_jc::JsonContainer& data) {
+        lth_jc::JsonContainer envelope {};
+        envelope.set<std::string>("id", ID);
+        envelope.set<std::string>("message_type", "test_message");
+        envelope.set<std::string>("target", TARGET);
+        envelope.set<std::string>("sender", SENDER);
+        envelope.set<std::string>("in_reply_to", IN_REPLY_TO);
+        envelope.set<lth_jc::JsonContainer>("data", data);
+        return envelope.toString();
+    };
+
+    auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count()) / 1000000;
+    };
+
+    // Data objects of about 100 B, 10 KB and 1 MB, made of entries of
+    // about 100 bytes; fewer messages are sent for larger data
+    for (auto num_entries : { 1, 100, 10000 }) {
+        lth_jc::JsonContainer data {};
+        for (auto idx = 0; idx < num_entries; idx++)
+            data.set<std::string>("key_" + std::to_string(idx), std::string(84, 'x'));
+
+        auto num_messages = 100000 / num_entries;
+        auto data_size = data.toString().size();
+        std::size_t total_size { 0 };
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto idx = 0; idx < num_messages; idx++)
+            total_size += buildWithDom(data).size();
+        auto dom_time = elapsed(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (auto idx = 0; idx < num_messages; idx++)
+            total_size -= e_t.renderJson(ID, IN_REPLY_TO, data).size();
+        auto streamed_time = elapsed(start);
+
+        // Both envelopes have the same entries
+        REQUIRE(total_size == 0);
+        std::cout << "  time to create " << num_messages << " messages with "
+                  << data_size << " bytes of data - DOM: " << dom_time
+                  << " s, streamed: " << streamed_time << " s\n";
+    }
+}
@@ -151,6 +151,115 @@ TEST_CASE("v2::Message::getParsedChunks - failure cases", "[message]") {
     }
 }
 
+TEST_CASE("v2::Message::validateEnvelope", "[message]") {
+    Validator validator;
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Protocol::ErrorMessageSchema());
+
+    SECTION("it returns the entries needed to route the message") {
+        auto envelope_fields = Message::validateEnvelope("{"
+            R"("id":"f0e71a48-969c-4377-b953-35f0fc55c388",)"
+            R"("message_type":"http://puppetlabs.com/error_message",)"
+            R"("sender":"pcp://foo/bar",)"
+            R"("data":{"sender":"pcp://spam/eggs"})"
+            "}", validator);
+        REQUIRE(envelope_fields.id == "f0e71a48-969c-4377-b953-35f0fc55c388");
+        REQUIRE(envelope_fields.message_type == "http://puppetlabs.com/error_message");
+        REQUIRE(envelope_fields.sender == "pcp://foo/bar");
+    }
+
+    SECTION("it leaves the missing entries empty") {
+        auto envelope_fields = Message::validateEnvelope(
+            R"({"id":"1","message_type":"http://puppetlabs.com/error_message"})",
+            validator);
+        REQUIRE(envelope_fields.sender.empty());
+    }
+
+    SECTION("it throws a validation_error in case the schema does not match") {
+        REQUIRE_THROWS_AS(Message::validateEnvelope(R"({"id":"1"})", validator),
+                          validation_error);
+    }
+
+    SECTION("it throws a data_parse_error in case the message is invalid json") {
+        REQUIRE_THROWS_AS(Message::validateEnvelope(R"({"id":)", validator),
+                          lth_jc::data_parse_error);
+    }
+
+    SECTION("getParsedChunks can then validate the data") {
+        std::string text { "{"
+            R"("id":"f0e71a48-969c-4377-b953-35f0fc55c388",)"
+            R"("message_type":"http://puppetlabs.com/error_message",)"
+            R"("data":"some error message")"
+            "}" };
+        auto chunks = Message(text).getParsedChunks(
+            validator, Message::validateEnvelope(text, validator));
+        REQUIRE(chunks.has_data);
+        REQUIRE_FALSE(chunks.invalid_data);
+        REQUIRE(chunks.data.get<std::string>() == "some error message");
+    }
+}
+
+TEST_CASE("v2::Message::getParsedChunks - lazy data", "[message]") {
+    Validator validator;
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Protocol::ErrorMessageSchema());
+
+    SECTION("the data is validated when first accessed") {
+        std::string text { "{"
+            R"("id":"f0e71a48-969c-4377-b953-35f0fc55c388",)"
+            R"("message_type":"http://puppetlabs.com/error_message",)"
+            R"("data":"some error message")"
+            "}" };
+        auto chunks = Message(text).getParsedChunks(
+            validator, Message::validateEnvelope(text, validator), true);
+        REQUIRE(chunks.has_data);
+        REQUIRE(chunks.data.empty());
+        REQUIRE_FALSE(chunks.hasInvalidData());
+        REQUIRE(chunks.getData().get<std::string>() == "some error message");
+    }
+
+    SECTION("invalid data is reported when first accessed") {
+        std::string text { "{"
+            R"("id":"f0e71a48-969c-4377-b953-35f0fc55c388",)"
+            R"("message_type":"http://puppetlabs.com/error_message",)"
+            R"("data":{"description":"some error message"})"
+            "}" };
+        auto chunks = Message(text).getParsedChunks(
+            validator, Message::validateEnvelope(text, validator), true);
+        REQUIRE(chunks.hasInvalidData());
+    }
+}
+
+TEST_CASE("v2::Message::getParsedChunks - binary data", "[message]") {
+    Validator validator;
+    validator.registerSchema(Protocol::EnvelopeSchema());
+    validator.registerSchema(Schema { "file_chunk", ContentType::Binary });
+    lth_jc::JsonContainer envelope {
+        R"({"id":"f0e71a48-969c-4377-b953-35f0fc55c388","message_type":"file_chunk"})" };
+
+    SECTION("it decodes the base64 data of binary schemas") {
+        std::string binary_data { "\x00\x01\xfe\xff binary\n", 12 };
+        binary_data += std::string(1000, '\x80');
+        Message msg { envelope, binary_data };
+
+        REQUIRE(msg.getEnvelope().get<std::string>("data").substr(0, 8) == "AAH+/yBi");
+
+        auto chunks = msg.getParsedChunks(validator);
+        REQUIRE(chunks.has_data);
+        REQUIRE_FALSE(chunks.invalid_data);
+        REQUIRE(chunks.data_type == ContentType::Binary);
+        REQUIRE(chunks.binary_data == binary_data);
+    }
+
+    SECTION("marks invalid_data in case the data is not base64 text") {
+        envelope.set<std::string>("data", "not base64!");
+        REQUIRE(Message(envelope).getParsedChunks(validator).invalid_data);
+
+        envelope.set<int>("data", 42);
+        REQUIRE(Message(envelope).getParsedChunks(validator).invalid_data);
+    }
+}
+
 //
 // Performance
 //
@@ -178,6 +287,16 @@ TEST_CASE("v2::Message serialization and parsing performance", "[message]") {
         }
     }
 
+    SECTION("validate the envelope of " + std::to_string(num_msg)
+            + " messages of ~1 Kbyte, without parsing them") {
+        current_test = "validate the envelope of";
+        for (auto idx = 0; idx < num_msg; idx++) {
+            if (Message::validateEnvelope(text, validator).id.empty()) {
+                FAIL("validation failure");
+            }
+        }
+    }
+
     SECTION("parse and validate " + std::to_string(num_msg) + " messages of ~1 Kbyte") {
         current_test = "parse";
         for (auto idx = 0; idx < num_msg; idx++) {
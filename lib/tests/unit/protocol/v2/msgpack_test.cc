@@ -0,0 +1,225 @@
+#include "tests/test.hpp"
+
+#include <cpp-pcp-client/protocol/v2/msgpack.hpp>
+#include <cpp-pcp-client/protocol/v2/message.hpp>
+#include <cpp-pcp-client/protocol/v2/schemas.hpp>
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <chrono>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+using namespace PCPClient;
+using namespace v2;
+
+namespace lth_jc = leatherman::json_container;
+
+static std::string bytes(std::initializer_list<int> values) {
+    std::string result {};
+    for (auto value : values)
+        result.push_back(static_cast<char>(value));
+    return result;
+}
+
+TEST_CASE("v2::jsonToMessagePack", "[message]") {
+    SECTION("it encodes integers with their smallest format") {
+        REQUIRE(jsonToMessagePack(R"({"a":[1,-1,200,-200,70000,true,null]})")
+                == bytes({ 0x81, 0xa1, 'a', 0x97,
+                           0x01,
+                           0xff,
+                           0xcc, 0xc8,
+                           0xd1, 0xff, 0x38,
+                           0xce, 0x00, 0x01, 0x11, 0x70,
+                           0xc3,
+                           0xc0 }));
+    }
+
+    SECTION("it encodes floats as float 64") {
+        REQUIRE(jsonToMessagePack("[1.5]")
+                == bytes({ 0x91, 0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0 }));
+    }
+
+    SECTION("it encodes strings and containers with their smallest header") {
+        std::string json_txt { "[" };
+        for (auto idx = 0; idx < 16; idx++)
+            json_txt += "0,";
+        json_txt += "\"" + std::string(40, 'x') + "\",\"" + std::string(300, 'y') + "\"]";
+        auto msgpack = jsonToMessagePack(json_txt);
+
+        REQUIRE(msgpack.substr(0, 3) == bytes({ 0xdc, 0x00, 0x12 }));
+        REQUIRE(msgpack.substr(19, 2) == bytes({ 0xd9, 40 }));
+        REQUIRE(msgpack.substr(61, 3) == bytes({ 0xda, 0x01, 0x2c }));
+        REQUIRE(msgpack.size() == 64 + 300);
+    }
+
+    SECTION("it encodes a JsonContainer as its JSON text") {
+        lth_jc::JsonContainer json { R"({"b":{"c":[1,"d",false]},"e":-1000000})" };
+
+        REQUIRE(jsonToMessagePack(json) == jsonToMessagePack(json.toString()));
+    }
+
+    SECTION("it throws a data_parse_error in case of invalid JSON") {
+        REQUIRE_THROWS_AS(jsonToMessagePack(R"({"a":)"), lth_jc::data_parse_error);
+    }
+}
+
+TEST_CASE("v2::messagePackToJson", "[message]") {
+    SECTION("it decodes what jsonToMessagePack encodes") {
+        std::string json_txt {
+            R"({"id":"f0e71a48","data":{"uris":["pcp://foo/bar"],"n":[0,-1,)"
+            R"(127,128,-33,65536,-2147483649,18446744073709551615],)"
+            R"("nested":{"t":true,"f":false,"z":null,"e":{},"a":[]}}})" };
+
+        REQUIRE(messagePackToJson(jsonToMessagePack(json_txt)) == json_txt);
+    }
+
+    SECTION("it decodes floats") {
+        REQUIRE(messagePackToJson(bytes({ 0x92, 0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0,
+                                          0xca, 0xc0, 0x20, 0x00, 0x00 }))
+                == "[1.5,-2.5]");
+    }
+
+    SECTION("it throws a data_parse_error in case of") {
+        SECTION("truncated values") {
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x92, 0x01 })),
+                              lth_jc::data_parse_error);
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x91, 0xa3, 'a' })),
+                              lth_jc::data_parse_error);
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0xdd, 0xff, 0xff, 0xff, 0xff })),
+                              lth_jc::data_parse_error);
+        }
+
+        SECTION("bytes following the value") {
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x90, 0x90 })),
+                              lth_jc::data_parse_error);
+        }
+
+        SECTION("bin and ext values") {
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x91, 0xc4, 0x01, 0x00 })),
+                              lth_jc::data_parse_error);
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x91, 0xd4, 0x01, 0x00 })),
+                              lth_jc::data_parse_error);
+        }
+
+        SECTION("map keys that are not strings") {
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x81, 0x01, 0x02 })),
+                              lth_jc::data_parse_error);
+        }
+
+        SECTION("floats that are not finite") {
+            REQUIRE_THROWS_AS(messagePackToJson(bytes({ 0x91, 0xcb, 0x7f, 0xf8,
+                                                        0, 0, 0, 0, 0, 0 })),
+                              lth_jc::data_parse_error);
+        }
+
+        SECTION("values nested too deeply") {
+            std::string msgpack(1000, static_cast<char>(0x91));
+            msgpack.push_back(static_cast<char>(0xc0));
+
+            REQUIRE_THROWS_AS(messagePackToJson(msgpack), lth_jc::data_parse_error);
+        }
+    }
+}
+
+TEST_CASE("v2::Message MessagePack encoding", "[message]") {
+    lth_jc::JsonContainer envelope {};
+    envelope.set<std::string>("id", "123456");
+    envelope.set<std::string>("message_type", Protocol::INVENTORY_RESP_TYPE);
+    envelope.set<std::string>("sender", "pcp:///server");
+    lth_jc::JsonContainer data {};
+    data.set<std::vector<std::string>>("uris", { "pcp://foo/bar" });
+    envelope.set<lth_jc::JsonContainer>("data", data);
+    Message msg { envelope };
+
+    SECTION("a message is decoded with the same envelope") {
+        auto decoded = Message::fromMessagePack(msg.toMessagePack());
+
+        REQUIRE(decoded.toString() == msg.toString());
+    }
+
+    SECTION("a decoded message is validated as a JSON one") {
+        Validator validator {};
+        validator.registerSchema(Protocol::EnvelopeSchema());
+        validator.registerSchema(Protocol::InventoryResponseSchema());
+        auto chunks = Message::fromMessagePack(msg.toMessagePack())
+                          .getParsedChunks(validator);
+
+        REQUIRE(chunks.has_data);
+        REQUIRE_FALSE(chunks.invalid_data);
+        REQUIRE(chunks.data.toString() == data.toString());
+    }
+
+    SECTION("it throws a data_parse_error in case of invalid MessagePack") {
+        REQUIRE_THROWS_AS(Message::fromMessagePack(bytes({ 0x81, 0xa2, 'i' })),
+                          lth_jc::data_parse_error);
+    }
+}
+
+TEST_CASE("v2 MessagePack encoding performance", "[message]") {
+    auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count()) / 1000000;
+    };
+
+    // Typical agent payloads: an inventory response, the output of a
+    // command and a facts report, with nested objects and numbers
+    lth_jc::JsonContainer inventory {};
+    std::vector<std::string> uris {};
+    for (auto idx = 0; idx < 200; idx++)
+        uris.push_back("pcp://agent-" + std::to_string(idx) + ".example.com/agent");
+    inventory.set<std::vector<std::string>>("uris", uris);
+
+    lth_jc::JsonContainer command_output {};
+    command_output.set<std::string>("transaction_id", "f0e71a48-969c-4377-b953-35f0fc55c388");
+    command_output.set<std::string>("status", "success");
+    command_output.set<int>("exitcode", 0);
+    command_output.set<double>("duration", 12.75);
+    command_output.set<std::string>("stdout", std::string(2000, 'o'));
+    command_output.set<std::string>("stderr", "");
+
+    lth_jc::JsonContainer mountpoints {};
+    for (auto idx = 0; idx < 40; idx++) {
+        lth_jc::JsonContainer mountpoint {};
+        mountpoint.set<std::string>("device", "/dev/sda" + std::to_string(idx));
+        mountpoint.set<std::string>("filesystem", "xfs");
+        mountpoint.set<int>("size_kb", 52403200 + idx);
+        mountpoint.set<int>("available_kb", 40278560 - idx);
+        mountpoint.set<double>("capacity", 23.14);
+        mountpoint.set<bool>("readonly", false);
+        mountpoint.set<std::vector<std::string>>("options", { "rw", "relatime", "seclabel" });
+        mountpoints.set<lth_jc::JsonContainer>("/mnt/" + std::to_string(idx), mountpoint);
+    }
+    lth_jc::JsonContainer facts {};
+    facts.set<lth_jc::JsonContainer>("mountpoints", mountpoints);
+
+    for (auto payload : { std::make_pair("inventory response", &inventory),
+                          std::make_pair("command output", &command_output),
+                          std::make_pair("facts", &facts) }) {
+        const auto& data = *payload.second;
+        auto json_txt = data.toString();
+        auto msgpack = jsonToMessagePack(data);
+        REQUIRE(lth_jc::JsonContainer(messagePackToJson(msgpack)).toString() == json_txt);
+
+        static const int NUM_MESSAGES { 2000 };
+        std::size_t total_size { 0 };
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto idx = 0; idx < NUM_MESSAGES; idx++)
+            total_size += lth_jc::JsonContainer(data.toString()).size();
+        auto json_time = elapsed(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (auto idx = 0; idx < NUM_MESSAGES; idx++)
+            total_size -= lth_jc::JsonContainer(messagePackToJson(jsonToMessagePack(data))).size();
+        auto msgpack_time = elapsed(start);
+
+        REQUIRE(total_size == 0);
+        std::cout << "  " << payload.first << " - JSON: " << json_txt.size()
+                  << " bytes, MessagePack: " << msgpack.size() << " bytes; time to "
+                  << "encode and decode " << NUM_MESSAGES << " messages - JSON: "
+                  << json_time << " s, MessagePack: " << msgpack_time << " s\n";
+    }
+}
@@ -0,0 +1,48 @@
+#include "tests/test.hpp"
+#include "tests/unit/validator/validator_utils.hpp"
+
+#include <cpp-pcp-client/protocol/v2/schemas.hpp>
+
+using namespace PCPClient;
+using namespace v2;
+
+TEST_CASE("v2 native validators", "[message]") {
+    SECTION("EnvelopeSchema has a native validator") {
+        REQUIRE(Protocol::EnvelopeSchema().getNativeValidator() != nullptr);
+    }
+
+    SECTION("EnvelopeSchema's native validator agrees with valijson") {
+        auto documents = generateDocuments({
+            { "id", "\"123456\"" },
+            { "message_type", "\"http://puppetlabs.com/spam\"" },
+            { "target", "\"pcp://*/agent\"" },
+            { "sender", "\"pcp://client01.example.com/test\"" },
+            { "in_reply_to", "\"123455\"" },
+            { "data", "{\"spam\" : [1, 2]}" } });
+
+        REQUIRE(getDisagreements(Protocol::EnvelopeSchema(), documents).empty());
+    }
+}
+
+TEST_CASE("v2 streaming validation", "[message]") {
+    SECTION("EnvelopeSchema's streaming validation agrees with valijson") {
+        auto documents = generateDocuments({
+            { "id", "\"123456\"" },
+            { "message_type", "\"http://puppetlabs.com/spam\"" },
+            { "target", "\"pcp://*/agent\"" },
+            { "sender", "\"pcp://client01.example.com/test\"" },
+            { "in_reply_to", "\"123455\"" },
+            { "data", "{\"spam\" : [1, 2]}" } });
+
+        REQUIRE(getStreamingDisagreements(Protocol::EnvelopeSchema(),
+                                          documents).empty());
+    }
+
+    SECTION("ErrorMessageSchema's streaming validation agrees with valijson") {
+        std::vector<std::string> documents { JSON_VALUE_SAMPLES };
+        documents.push_back("\"some error message\"");
+
+        REQUIRE(getStreamingDisagreements(Protocol::ErrorMessageSchema(),
+                                          documents).empty());
+    }
+}
@@ -0,0 +1,143 @@
+#include "tests/test.hpp"
+
+#include "tests/unit/util/simd_utils.hpp"
+#include "util/base64.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace PCPClient;
+using namespace Util;
+
+static std::string getRandomData(std::size_t size) {
+    std::mt19937 generator { static_cast<std::mt19937::result_type>(size) };
+    std::string data(size, '\0');
+
+    for (auto& c : data)
+        c = static_cast<char>(generator() & 0xff);
+
+    return data;
+}
+
+static std::string encode(const std::string& data, SimdLevel level) {
+    std::string txt {};
+    appendBase64(txt, data, level);
+    return txt;
+}
+
+TEST_CASE("Util::appendBase64", "[util]") {
+    SECTION("it encodes the test vectors of RFC 4648") {
+        for (auto level : getSupportedLevels()) {
+            REQUIRE(encode("", level) == "");
+            REQUIRE(encode("f", level) == "Zg==");
+            REQUIRE(encode("fo", level) == "Zm8=");
+            REQUIRE(encode("foo", level) == "Zm9v");
+            REQUIRE(encode("foob", level) == "Zm9vYg==");
+            REQUIRE(encode("fooba", level) == "Zm9vYmE=");
+            REQUIRE(encode("foobar", level) == "Zm9vYmFy");
+        }
+    }
+
+    SECTION("the SIMD code encodes as the scalar one, for any size") {
+        for (std::size_t size = 0; size < 200; size++) {
+            auto data = getRandomData(size);
+            auto expected = encode(data, SimdLevel::None);
+
+            REQUIRE(expected.size() == getBase64Size(size));
+
+            for (auto level : getSupportedLevels())
+                REQUIRE(encode(data, level) == expected);
+        }
+    }
+
+    SECTION("it appends to the buffer") {
+        std::string buffer { "\"" };
+        appendBase64(buffer, "foobar");
+
+        REQUIRE(buffer == "\"Zm9vYmFy");
+    }
+}
+
+TEST_CASE("Util::decodeBase64", "[util]") {
+    SECTION("it decodes what appendBase64 encodes, for any size") {
+        for (std::size_t size = 0; size < 200; size++) {
+            auto data = getRandomData(size);
+            auto txt = encodeBase64(data);
+
+            for (auto level : getSupportedLevels()) {
+                std::string decoded { "previous content" };
+
+                REQUIRE(decodeBase64(txt, decoded, level));
+                REQUIRE(decoded == data);
+            }
+        }
+    }
+
+    SECTION("it returns false in case of invalid text") {
+        auto txt = encodeBase64(getRandomData(150));
+
+        for (auto level : getSupportedLevels()) {
+            std::string data {};
+
+            // Size that is not a multiple of 4
+            REQUIRE_FALSE(decodeBase64(txt.substr(1), data, level));
+            // Padding not at the end
+            REQUIRE_FALSE(decodeBase64("Zg==Zm9v", data, level));
+            REQUIRE_FALSE(decodeBase64("====", data, level));
+            REQUIRE_FALSE(decodeBase64("Z===", data, level));
+
+            // Invalid characters, in any position of the SIMD blocks;
+            // NB: the last character may be padding
+            for (std::size_t idx = 0; idx < txt.size() - 1; idx++) {
+                for (auto c : { '=', '-', '_', ' ', '\n', '\0', '\x80' }) {
+                    auto bad_txt = txt;
+                    bad_txt[idx] = c;
+
+                    REQUIRE_FALSE(decodeBase64(bad_txt, data, level));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD base64 performance", "[util]") {
+    static const int num_iterations { 20 };
+    auto data = getRandomData(4 * 1024 * 1024);
+    auto txt = encodeBase64(data);
+
+    auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count()) / 1000000;
+    };
+
+    for (auto level : getSupportedLevels()) {
+        std::string encoded {};
+        encoded.reserve(txt.size());
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int idx = 0; idx < num_iterations; idx++) {
+            encoded.clear();
+            appendBase64(encoded, data, level);
+        }
+
+        auto encoding_time = elapsed(start);
+        std::string decoded {};
+        start = std::chrono::high_resolution_clock::now();
+
+        for (int idx = 0; idx < num_iterations; idx++)
+            REQUIRE(decodeBase64(txt, decoded, level));
+
+        auto decoding_time = elapsed(start);
+
+        REQUIRE(encoded == txt);
+        REQUIRE(decoded == data);
+        std::cout << "  time to encode and decode " << num_iterations
+                  << " times 4 MB with SIMD level " << static_cast<int>(level)
+                  << " - encoding: " << encoding_time << " s, decoding: "
+                  << decoding_time << " s\n";
+    }
+}
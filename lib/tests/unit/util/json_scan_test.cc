@@ -0,0 +1,29 @@
+#include "tests/test.hpp"
+
+#include "util/json_scan.hpp"
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <string>
+
+using namespace PCPClient;
+using namespace Util;
+
+namespace lth_jc = leatherman::json_container;
+
+TEST_CASE("Util::checkJsonText", "[util]") {
+    SECTION("it accepts well-formed JSON text") {
+        REQUIRE_NOTHROW(checkJsonText("{\"a\" : [1, 2.5, true, null, \"x\"]}"));
+        REQUIRE_NOTHROW(checkJsonText(" [ { } ] \n"));
+    }
+
+    SECTION("it throws a data_parse_error in case of bad JSON text") {
+        for (auto txt : { "", "{", "{\"a\" 1}", "[1,]", "[] []", "{\"a\":\"b}" })
+            REQUIRE_THROWS_AS(checkJsonText(txt), lth_jc::data_parse_error);
+    }
+
+    SECTION("it doesn't read past the end of the text") {
+        std::string txt { "[1, 2]]" };
+        REQUIRE_NOTHROW(checkJsonText(boost::string_ref(txt.data(), 6)));
+    }
+}
@@ -0,0 +1,119 @@
+#include "tests/test.hpp"
+
+#include <cpp-pcp-client/util/memory_resource.hpp>
+
+#include <cstdint>
+
+using namespace PCPClient;
+using namespace Util;
+
+// Counts the allocations and deallocations it forwards to the heap
+class CountingResource : public MemoryResource {
+  public:
+    int num_allocations { 0 };
+    int num_deallocations { 0 };
+    std::size_t last_allocation_size { 0 };
+
+  private:
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override {
+        num_allocations++;
+        last_allocation_size = bytes;
+        return getNewDeleteResource()->allocate(bytes, alignment);
+    }
+
+    void doDeallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        num_deallocations++;
+        getNewDeleteResource()->deallocate(ptr, bytes, alignment);
+    }
+};
+
+static bool isAligned(void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST_CASE("Util::MonotonicBufferResource", "[util]") {
+    CountingResource upstream {};
+
+    SECTION("it allocates aligned memory from a single upstream buffer") {
+        MonotonicBufferResource arena { 1024, &upstream };
+
+        for (std::size_t alignment : { 1, 2, 4, 8, 16 }) {
+            auto ptr = arena.allocate(3, alignment);
+            REQUIRE(isAligned(ptr, alignment));
+        }
+
+        REQUIRE(upstream.num_allocations == 1);
+    }
+
+    SECTION("it grows when a buffer is exhausted") {
+        MonotonicBufferResource arena { 256, &upstream };
+        arena.allocate(200);
+        arena.allocate(200);
+        auto large_ptr = static_cast<char*>(arena.allocate(10000));
+        large_ptr[9999] = 'x';
+
+        REQUIRE(upstream.num_allocations == 3);
+    }
+
+    SECTION("rewinding keeps only the largest buffer") {
+        MonotonicBufferResource arena { 256, &upstream };
+        arena.allocate(200);
+        arena.allocate(1000);
+        arena.rewind();
+
+        REQUIRE(upstream.num_deallocations == 1);
+
+        arena.allocate(1000);
+
+        REQUIRE(upstream.num_allocations == 2);
+    }
+
+    SECTION("rewinding doesn't keep buffers larger than the limit") {
+        MonotonicBufferResource arena { 256, &upstream, 4096 };
+        arena.allocate(200);
+        arena.allocate(10000);
+        arena.rewind();
+
+        REQUIRE(upstream.num_deallocations == 1);
+
+        arena.allocate(200);
+
+        REQUIRE(upstream.num_allocations == 2);
+
+        arena.allocate(20000);
+        arena.rewind();
+
+        REQUIRE(upstream.num_deallocations == 2);
+    }
+
+    SECTION("the growth restarts from the kept buffer after rewinding") {
+        MonotonicBufferResource arena { 256, &upstream, 1024 };
+        arena.allocate(10000);
+        arena.rewind();
+        arena.allocate(200);
+
+        REQUIRE(upstream.num_allocations == 2);
+        REQUIRE(upstream.last_allocation_size == 256);
+
+        arena.allocate(200);
+
+        REQUIRE(upstream.num_allocations == 3);
+        REQUIRE(upstream.last_allocation_size == 512);
+    }
+
+    SECTION("the memory is returned upstream when released or destroyed") {
+        {
+            MonotonicBufferResource arena { 256, &upstream };
+            arena.allocate(200);
+            arena.allocate(200);
+            arena.release();
+
+            REQUIRE(upstream.num_deallocations == 2);
+
+            arena.allocate(200);
+        }
+
+        REQUIRE(upstream.num_allocations == 3);
+        REQUIRE(upstream.num_deallocations == 3);
+    }
+}
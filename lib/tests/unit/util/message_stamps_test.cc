@@ -0,0 +1,81 @@
+#include "tests/test.hpp"
+
+#include <cpp-pcp-client/util/message_stamps.hpp>
+
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace PCPClient;
+using namespace PCPClient::Util;
+
+TEST_CASE("MessageIdGenerator::generate", "[message]") {
+    MessageIdGenerator id_generator {};
+
+    SECTION("it generates version 4 UUIDs") {
+        boost::regex uuid_v4 {
+            "[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12}" };
+
+        for (auto idx = 0; idx < 100; idx++)
+            REQUIRE(boost::regex_match(id_generator.generate(), uuid_v4));
+    }
+
+    SECTION("it generates unique IDs") {
+        std::set<std::string> ids {};
+
+        for (auto idx = 0; idx < 10000; idx++)
+            ids.insert(id_generator.generate());
+
+        REQUIRE(ids.size() == 10000);
+    }
+
+    SECTION("generators seeded differently generate different IDs") {
+        MessageIdGenerator other_generator {};
+
+        REQUIRE(id_generator.generate() != other_generator.generate());
+    }
+
+    SECTION("it writes exactly ID_SIZE chars on the buffer") {
+        std::string buffer(MessageIdGenerator::ID_SIZE + 1, '#');
+        id_generator.generateOn(&buffer[0]);
+
+        REQUIRE(buffer.back() == '#');
+        REQUIRE(buffer.find('#') == MessageIdGenerator::ID_SIZE);
+    }
+}
+
+TEST_CASE("ExpiryFormatter::format", "[message]") {
+    SECTION("it formats times in UTC, ISO 8601 format") {
+        std::vector<std::pair<std::time_t, std::string>> times {
+            { 0, "1970-01-01T00:00:00Z" },
+            { 951782400, "2000-02-29T00:00:00Z" },
+            { 1792240496, "2026-10-17T12:34:56Z" },
+            { 4102444799, "2099-12-31T23:59:59Z" } };
+
+        for (const auto& t : times) {
+            char buffer[ExpiryFormatter::EXPIRY_SIZE];
+            ExpiryFormatter::formatTimeOn(t.first, buffer);
+
+            REQUIRE(std::string(buffer, sizeof(buffer)) == t.second);
+        }
+    }
+
+    SECTION("it formats the time timeout seconds from now") {
+        ExpiryFormatter expiry_formatter {};
+        auto now = std::time(nullptr);
+        auto expires = expiry_formatter.format(60);
+        std::vector<std::string> expected_times {};
+
+        for (auto t = now + 59; t <= now + 62; t++) {
+            char buffer[ExpiryFormatter::EXPIRY_SIZE];
+            ExpiryFormatter::formatTimeOn(t, buffer);
+            expected_times.emplace_back(buffer, sizeof(buffer));
+        }
+
+        REQUIRE(std::find(expected_times.begin(), expected_times.end(), expires)
+                != expected_times.end());
+    }
+}
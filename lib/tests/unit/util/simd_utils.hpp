@@ -0,0 +1,25 @@
+#pragma once
+
+#include "util/base64.hpp"
+
+#include <vector>
+
+namespace PCPClient {
+namespace Util {
+
+// The instruction sets supported by both the build and the CPU, from
+// the scalar code up; the SIMD code is tested against the scalar one
+inline std::vector<SimdLevel> getSupportedLevels() {
+    std::vector<SimdLevel> levels { SimdLevel::None };
+
+    if (getSimdLevel() >= SimdLevel::SSE42)
+        levels.push_back(SimdLevel::SSE42);
+
+    if (getSimdLevel() >= SimdLevel::AVX2)
+        levels.push_back(SimdLevel::AVX2);
+
+    return levels;
+}
+
+}  // namespace Util
+}  // namespace PCPClient
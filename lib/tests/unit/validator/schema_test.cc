@@ -1,6 +1,11 @@
 #include "tests/test.hpp"
+#include "tests/unit/validator/validator_utils.hpp"
+
+// Generated from lib/tests/resources/schemas
+#include "test_schemas.hpp"
 
 #include <cpp-pcp-client/validator/schema.hpp>
+#include <cpp-pcp-client/validator/validator.hpp>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wextra"
@@ -11,6 +16,9 @@
 #include <valijson/validator.hpp>
 #pragma GCC diagnostic pop
 
+#include <chrono>
+#include <iostream>
+
 using namespace PCPClient;
 
 bool validateTest(lth_jc::JsonContainer document, Schema schema) {
@@ -288,3 +296,180 @@ TEST_CASE("Schema::getContentType()", "[validation]") {
     Schema schema { "eggs", ContentType::Binary };
     REQUIRE(schema.getContentType() == ContentType::Binary);
 }
+
+static bool acceptAll(const lth_jc::JsonContainer&) {
+    return true;
+}
+
+TEST_CASE("Schema::setNativeValidator", "[validation]") {
+    Schema schema { "spam" };
+
+    SECTION("a schema has no native validator by default") {
+        REQUIRE(schema.getNativeValidator() == nullptr);
+    }
+
+    SECTION("it sets the native validator") {
+        schema.setNativeValidator(acceptAll);
+        REQUIRE(schema.getNativeValidator() == acceptAll);
+        REQUIRE(Schema(schema).getNativeValidator() == acceptAll);
+    }
+
+    SECTION("adding a constraint removes the native validator") {
+        schema.setNativeValidator(acceptAll);
+        schema.addConstraint("foo", TypeConstraint::String);
+        REQUIRE(schema.getNativeValidator() == nullptr);
+    }
+}
+
+TEST_CASE("Schema::isStreamable", "[validation]") {
+    SECTION("a schema with type constraints is streamable") {
+        Schema schema { "spam" };
+        schema.addConstraint("foo", TypeConstraint::String, true);
+        schema.addConstraint("bar", TypeConstraint::Int);
+        REQUIRE(schema.isStreamable());
+        REQUIRE(Schema(schema).isStreamable());
+        REQUIRE(schema.getPropertyTypes().size() == 2);
+        REQUIRE(schema.getPropertyTypes()[0].name == "foo");
+        REQUIRE(schema.getPropertyTypes()[0].type == TypeConstraint::String);
+        REQUIRE(schema.getPropertyTypes()[0].required);
+        REQUIRE_FALSE(schema.getPropertyTypes()[1].required);
+    }
+
+    SECTION("a schema with a sub-schema constraint is not streamable") {
+        Schema schema { "spam" };
+        schema.addConstraint("foo", Schema { "eggs" });
+        REQUIRE_FALSE(schema.isStreamable());
+        REQUIRE_FALSE(Schema(schema).isStreamable());
+    }
+
+    SECTION("a parsed schema is not streamable") {
+        Schema schema { "song", lth_jc::JsonContainer { song_schema_txt } };
+        REQUIRE_FALSE(schema.isStreamable());
+    }
+}
+
+TEST_CASE("streaming validation", "[validation]") {
+    SECTION("it agrees with valijson for all the type constraints") {
+        Schema schema { "spam" };
+        schema.addConstraint("string", TypeConstraint::String, true);
+        schema.addConstraint("int", TypeConstraint::Int, true);
+        schema.addConstraint("double", TypeConstraint::Double);
+        schema.addConstraint("bool", TypeConstraint::Bool);
+        schema.addConstraint("null", TypeConstraint::Null);
+        schema.addConstraint("array", TypeConstraint::Array);
+        schema.addConstraint("object", TypeConstraint::Object);
+        schema.addConstraint("any", TypeConstraint::Any, true);
+        auto documents = generateDocuments({
+            { "string", "\"eggs\"" },
+            { "int", "-3" },
+            { "double", "0.5" },
+            { "bool", "false" },
+            { "null", "null" },
+            { "array", "[{\"int\" : \"spam\"}]" },
+            { "object", "{\"string\" : 1, \"int\" : [\"x\"]}" },
+            { "any", "{}" } });
+
+        REQUIRE(getStreamingDisagreements(schema, documents).empty());
+    }
+
+    SECTION("it agrees with valijson for multiple constraints of a property") {
+        Schema schema { "spam" };
+        schema.addConstraint("foo", TypeConstraint::Double, true);
+        schema.addConstraint("foo", TypeConstraint::Int);
+        auto documents = generateDocuments({ { "foo", "1" } });
+
+        REQUIRE(getStreamingDisagreements(schema, documents).empty());
+    }
+
+    SECTION("it agrees with valijson for schemas without properties") {
+        for (auto type : { TypeConstraint::Object, TypeConstraint::Array,
+                           TypeConstraint::String, TypeConstraint::Int,
+                           TypeConstraint::Bool, TypeConstraint::Double,
+                           TypeConstraint::Null, TypeConstraint::Any }) {
+            std::vector<std::string> documents { JSON_VALUE_SAMPLES };
+            documents.push_back("{\"foo\" : 1}");
+
+            REQUIRE(getStreamingDisagreements(Schema { "spam", type },
+                                              documents).empty());
+        }
+    }
+}
+
+// NB: lib/tests/resources/schemas contains the above trivial and
+//     song schemas; the validators generated from them must agree
+//     with the valijson ones
+
+TEST_CASE("generated validators", "[validation]") {
+    SECTION("the song validator agrees with valijson") {
+        Schema schema { "song", lth_jc::JsonContainer { song_schema_txt } };
+        schema.setNativeValidator(Tests::validateSong);
+        auto documents = generateDocuments({
+            { "artist", "\"Zappa\"" },
+            { "title", "\"Bobby Brown\"" },
+            { "album", "\"Sheik Yerbouti\"" },
+            { "year", "1979" } });
+
+        for (auto year : { "1949", "1950", "1949.5", "1950.0", "-1950" })
+            documents.push_back(
+                "{\"artist\" : \"Wire\", \"title\" : \"Mannequin\", "
+                "\"year\" : " + std::string { year } + "}");
+
+        REQUIRE(getDisagreements(schema, documents).empty());
+    }
+
+    SECTION("the trivial validator agrees with valijson") {
+        Schema schema { "trivial", lth_jc::JsonContainer { trivial_schema_txt } };
+        schema.setNativeValidator(Tests::validateTrivial);
+        auto documents = generateDocuments({ { "index", "42" } });
+
+        REQUIRE(getDisagreements(schema, documents).empty());
+    }
+}
+
+//
+// Performance
+//
+
+TEST_CASE("generated and interpreted validators performance", "[validation]") {
+    static const lth_jc::JsonContainer good_song {
+        " { \"artist\": \"Zappa\","
+        "   \"title\" : \"Bobby Brown\","
+        "   \"album\" : \"Sheik Yerbouti\","
+        "   \"year\"  : 1979 }" };
+    static const lth_jc::JsonContainer trivial_data { "{ \"index\" : 42 }" };
+    static auto num_validations = 100000;
+
+    Validator validator {};
+    validator.registerSchema(Schema { "song", lth_jc::JsonContainer { song_schema_txt } });
+    validator.registerSchema(Schema { "trivial", lth_jc::JsonContainer { trivial_schema_txt } });
+    validator.registerCompiledSchema("compiled song", Tests::validateSong);
+    validator.registerCompiledSchema("compiled trivial", Tests::validateTrivial);
+
+    auto benchmark = [&](const lth_jc::JsonContainer& data, const std::string& schema_name) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (auto idx = 0; idx < num_validations; idx++)
+            validator.validate(data, schema_name);
+
+        auto execution_time =
+            static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - start)
+                        .count());
+
+        std::cout << "  time to validate " << num_validations << " times with the '"
+                  << schema_name << "' schema: " << execution_time / (1000 * 1000)
+                  << " s (" << static_cast<int>((num_validations / execution_time) * (1000 * 1000))
+                  << " validations/s)\n";
+    };
+
+    SECTION("song schema") {
+        REQUIRE_NOTHROW(benchmark(good_song, "song"));
+        REQUIRE_NOTHROW(benchmark(good_song, "compiled song"));
+    }
+
+    SECTION("trivial schema") {
+        REQUIRE_NOTHROW(benchmark(trivial_data, "trivial"));
+        REQUIRE_NOTHROW(benchmark(trivial_data, "compiled trivial"));
+    }
+}
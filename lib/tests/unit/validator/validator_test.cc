@@ -1,7 +1,16 @@
 #include "tests/test.hpp"
+#include "tests/allocation_counter.hpp"
 
 #include <cpp-pcp-client/validator/validator.hpp>
 #include <cpp-pcp-client/validator/schema.hpp>
+#include <cpp-pcp-client/util/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
 
 using namespace PCPClient;
 
@@ -20,6 +29,40 @@ TEST_CASE("Validator::registerSchema", "[validation]") {
     }
 }
 
+static bool isSpam(const lth_jc::JsonContainer& data) {
+    return data.includes("spam");
+}
+
+TEST_CASE("Validator::registerCompiledSchema", "[validation]") {
+    Validator validator {};
+
+    SECTION("it can register a compiled schema") {
+        validator.registerCompiledSchema("spam", isSpam, ContentType::Binary);
+        REQUIRE(validator.includesSchema("spam"));
+        REQUIRE(validator.getSchemaContentType("spam") == ContentType::Binary);
+    }
+
+    SECTION("it cannot register a schema name more than once") {
+        validator.registerSchema(Schema { "spam" });
+        REQUIRE_THROWS_AS(validator.registerCompiledSchema("spam", isSpam),
+                          schema_redefinition_error);
+    }
+
+    SECTION("it throws a validator_error if the validator is null") {
+        REQUIRE_THROWS_AS(validator.registerCompiledSchema("spam", nullptr),
+                          validator_error);
+    }
+
+    SECTION("validate runs the compiled validator") {
+        validator.registerCompiledSchema("spam", isSpam);
+        REQUIRE_NOTHROW(validator.validate(lth_jc::JsonContainer { "{\"spam\" : 1}" },
+                                           "spam"));
+        REQUIRE_THROWS_AS(validator.validate(lth_jc::JsonContainer { "{\"eggs\" : 1}" },
+                                             "spam"),
+                          validation_error);
+    }
+}
+
 TEST_CASE("Validator::validate", "[validation]") {
     lth_jc::JsonContainer data {};
     Schema schema { "test-schema" };
@@ -46,9 +89,146 @@ TEST_CASE("Validator::validate", "[validation]") {
         REQUIRE_NOTHROW(validator.validate(data, "test-schema"));
     }
 
+    SECTION("it uses the schema as it was when registered") {
+        data.set<std::string>("key", "value");
+        schema.addConstraint("key", TypeConstraint::String);
+        validator.registerSchema(schema);
+        schema.addConstraint("key", TypeConstraint::Int);
+        REQUIRE_NOTHROW(validator.validate(data, "test-schema"));
+        REQUIRE_NOTHROW(validator.validate(data, "test-schema"));
+    }
+
     // TODO(ale): move old SECTION("default schemas") to Connector test
 }
 
+TEST_CASE("Validator::validateText", "[validation]") {
+    Schema schema { "test-schema" };
+    schema.addConstraint("id", TypeConstraint::String, true);
+    schema.addConstraint("count", TypeConstraint::Int);
+    Validator validator {};
+    validator.registerSchema(schema);
+
+    SECTION("it throws a schema_not_found_error if the requested schema was "
+            "not registered") {
+        REQUIRE_THROWS_AS(validator.validateText("{}", "spam"),
+                          schema_not_found_error);
+    }
+
+    SECTION("it doesn't throw when validation succeeds") {
+        REQUIRE_NOTHROW(validator.validateText(
+            "{\"id\" : \"1\", \"count\" : 2}", "test-schema"));
+    }
+
+    SECTION("it throws a validation_error when validation fails") {
+        for (auto txt : { "{\"count\" : 2}",
+                          "{\"id\" : \"1\", \"count\" : \"2\"}",
+                          "{\"id\" : \"1\", \"spam\" : 2}",
+                          "[\"id\", \"1\"]" })
+            REQUIRE_THROWS_AS(validator.validateText(txt, "test-schema"),
+                              validation_error);
+    }
+
+    SECTION("it throws a validation_error before reaching invalid JSON text") {
+        REQUIRE_THROWS_AS(validator.validateText("{\"spam\" : 1, {{{", "test-schema"),
+                          validation_error);
+    }
+
+    SECTION("it throws a data_parse_error in case of invalid JSON text") {
+        REQUIRE_THROWS_AS(validator.validateText("{\"id\" : \"1\"", "test-schema"),
+                          lth_jc::data_parse_error);
+        REQUIRE_THROWS_AS(validator.validateText("{\"id\" : \"1\"} {}", "test-schema"),
+                          lth_jc::data_parse_error);
+    }
+
+    SECTION("it captures the string values of top-level properties") {
+        std::vector<PropertyCapture> captures { { "id", "" }, { "name", "" } };
+        validator.registerSchema(Schema { "open-schema" });
+        validator.validateText(
+            "{\"spam\" : {\"id\" : \"2\"}, \"id\" : \"1\", \"name\" : 3}",
+            "open-schema",
+            &captures);
+        REQUIRE(captures[0].value == "1");
+        REQUIRE(captures[1].value.empty());
+    }
+
+    SECTION("it captures the first value of duplicate keys, as the DOM does") {
+        std::string txt { "{\"id\" : \"1\", \"id\" : \"2\"}" };
+        Schema parsed_schema { "parsed-schema", lth_jc::JsonContainer {
+            "{\"type\" : \"object\"}" } };
+        validator.registerSchema(parsed_schema);
+
+        for (auto schema_name : { "test-schema", "parsed-schema" }) {
+            std::vector<PropertyCapture> captures { { "id", "" } };
+            validator.validateText(txt, schema_name, &captures);
+            REQUIRE(captures[0].value == lth_jc::JsonContainer(txt).get<std::string>("id"));
+            REQUIRE(captures[0].value == "1");
+        }
+    }
+
+    SECTION("it validates and captures with schemas that are not streamable") {
+        Schema parsed_schema { "parsed-schema", lth_jc::JsonContainer {
+            "{\"type\" : \"object\", \"required\" : [\"id\"]}" } };
+        validator.registerSchema(parsed_schema);
+        std::vector<PropertyCapture> captures { { "id", "" } };
+
+        REQUIRE_NOTHROW(validator.validateText("{\"id\" : \"1\"}", "parsed-schema",
+                                               &captures));
+        REQUIRE(captures[0].value == "1");
+        REQUIRE_THROWS_AS(validator.validateText("{}", "parsed-schema"),
+                          validation_error);
+    }
+
+    SECTION("it takes the working memory from an arena, if specified") {
+        Util::MonotonicBufferResource arena {};
+        std::string txt { "{\"id\" : \"" + std::string(1000, 'x') + "\", \"count\" : 2}" };
+        std::vector<PropertyCapture> captures { { "id", std::string(1000, ' ') } };
+
+        // Allocate the arena buffers
+        validator.validateText(txt, "test-schema", &captures, &arena);
+        arena.rewind();
+
+        AllocationCounter counter {};
+        validator.validateText(txt, "test-schema", &captures, &arena);
+
+        REQUIRE(counter.getCount() == 0);
+        REQUIRE(captures[0].value == std::string(1000, 'x'));
+        REQUIRE_THROWS_AS(validator.validateText("{\"id\" : ", "test-schema",
+                                                 nullptr, &arena),
+                          lth_jc::data_parse_error);
+    }
+
+    SECTION("otherwise it allocates its working memory at once") {
+        std::string txt { "{\"id\" : \"" + std::string(1000, 'x') + "\", \"count\" : 2}" };
+
+        AllocationCounter counter {};
+        validator.validateText(txt, "test-schema");
+
+        REQUIRE(counter.getCount() == 1);
+    }
+}
+
+TEST_CASE("Validator::parseText", "[validation]") {
+    Schema schema { "test-schema" };
+    schema.addConstraint("id", TypeConstraint::String, true);
+    Validator validator {};
+    validator.registerSchema(schema);
+
+    SECTION("it returns the parsed data when validation succeeds") {
+        auto data = validator.parseText("{\"id\" : \"1\"}", "test-schema");
+        REQUIRE(data.get<std::string>("id") == "1");
+    }
+
+    SECTION("it throws a validation_error when validation fails") {
+        REQUIRE_THROWS_AS(validator.parseText("{\"id\" : 1}", "test-schema"),
+                          validation_error);
+    }
+
+    SECTION("it throws a data_parse_error in case of invalid JSON text") {
+        REQUIRE_THROWS_AS(validator.parseText("{\"id\" : ", "test-schema"),
+                          lth_jc::data_parse_error);
+    }
+}
+
 TEST_CASE("Validator::getSchemaContentType", "[validation]") {
     Schema schema { "foo", ContentType::Binary };
     Validator validator {};
@@ -63,3 +243,175 @@ TEST_CASE("Validator::getSchemaContentType", "[validation]") {
                           schema_not_found_error);
     }
 }
+
+TEST_CASE("Validator::includesSchema", "[validation]") {
+    Validator validator {};
+
+    SECTION("it can find all the registered schemas") {
+        for (int idx = 0; idx < 100; idx++)
+            validator.registerSchema(Schema { "schema_" + std::to_string(idx) });
+
+        for (int idx = 0; idx < 100; idx++)
+            REQUIRE(validator.includesSchema("schema_" + std::to_string(idx)));
+        REQUIRE_FALSE(validator.includesSchema("schema_100"));
+        REQUIRE_FALSE(validator.includesSchema("schema_"));
+    }
+
+    SECTION("lookups don't allocate memory") {
+        for (int idx = 0; idx < 100; idx++)
+            validator.registerSchema(Schema { "schema_" + std::to_string(idx) });
+
+        AllocationCounter counter {};
+        auto found = validator.includesSchema("schema_42");
+        auto missing = validator.includesSchema("schema_100");
+
+        REQUIRE(counter.getCount() == 0);
+        REQUIRE(found);
+        REQUIRE_FALSE(missing);
+    }
+
+    SECTION("it can look up a schema by a substring of a larger buffer") {
+        validator.registerSchema(Schema { "spam" });
+        std::string buffer { "spam eggs" };
+        REQUIRE(validator.includesSchema(boost::string_ref(buffer.data(), 4)));
+        REQUIRE_FALSE(validator.includesSchema(boost::string_ref(buffer.data(), 3)));
+    }
+
+    SECTION("lookups can run while other schemas are being registered") {
+        validator.registerSchema(Schema { "spam" });
+        std::atomic<bool> done { false };
+        std::atomic<bool> failed { false };
+        std::vector<Util::thread> readers {};
+
+        for (int idx = 0; idx < 4; idx++) {
+            readers.emplace_back([&validator, &done, &failed]() {
+                while (!done)
+                    if (!validator.includesSchema("spam"))
+                        failed = true;
+            });
+        }
+
+        for (int idx = 0; idx < 200; idx++)
+            validator.registerSchema(Schema { "eggs_" + std::to_string(idx) });
+        done = true;
+
+        for (auto& reader : readers)
+            reader.join();
+        REQUIRE_FALSE(failed);
+        REQUIRE(validator.includesSchema("eggs_199"));
+    }
+}
+
+TEST_CASE("Validator::validateBatch", "[validation]") {
+    Validator validator {};
+    Schema schema { "test-schema" };
+    schema.addConstraint("key", TypeConstraint::String, true);
+    validator.registerSchema(schema);
+
+    lth_jc::JsonContainer valid_data {};
+    valid_data.set<std::string>("key", "value");
+    lth_jc::JsonContainer invalid_data {};
+    invalid_data.set<int>("key", 1);
+
+    SECTION("it returns an empty vector for an empty batch") {
+        REQUIRE(validator.validateBatch(std::vector<ValidationItem> {}).empty());
+    }
+
+    SECTION("it reports the result of each item, without throwing") {
+        std::vector<ValidationItem> items {
+            { valid_data, "test-schema" },
+            { invalid_data, "test-schema" },
+            { valid_data, "unknown-schema" },
+            { valid_data, "test-schema" } };
+        std::vector<ValidationResult> results;
+
+        REQUIRE_NOTHROW(results = validator.validateBatch(items, 2));
+        REQUIRE(results.size() == 4);
+        REQUIRE(results[0].status == ValidationStatus::Valid);
+        REQUIRE(results[0].error.empty());
+        REQUIRE(results[1].status == ValidationStatus::Invalid);
+        REQUIRE_FALSE(results[1].error.empty());
+        REQUIRE(results[2].status == ValidationStatus::SchemaNotFound);
+        REQUIRE(results[3].status == ValidationStatus::Valid);
+    }
+
+    SECTION("the results don't depend on the number of workers") {
+        std::vector<ValidationItem> items {};
+        for (int idx = 0; idx < 1000; idx++)
+            items.emplace_back(idx % 3 == 0 ? invalid_data : valid_data, "test-schema");
+
+        for (unsigned int num_workers : { 0u, 1u, 3u, 16u }) {
+            auto results = validator.validateBatch(items.data(), items.size(),
+                                                   num_workers);
+            REQUIRE(results.size() == items.size());
+            for (int idx = 0; idx < 1000; idx++) {
+                REQUIRE(results[idx].status == (idx % 3 == 0
+                                                ? ValidationStatus::Invalid
+                                                : ValidationStatus::Valid));
+            }
+        }
+    }
+
+    SECTION("it reports the exceptions thrown by compiled validators") {
+        validator.registerCompiledSchema("throwing-schema",
+            [](const lth_jc::JsonContainer& data) {
+                return data.get<int>("key") > 0;
+            });
+        auto results = validator.validateBatch(
+            std::vector<ValidationItem> { { valid_data, "throwing-schema" },
+                                          { invalid_data, "throwing-schema" } });
+        REQUIRE(results[0].status == ValidationStatus::Error);
+        REQUIRE(results[1].status == ValidationStatus::Valid);
+    }
+}
+
+//
+// Performance
+//
+
+TEST_CASE("Validator::validateBatch performance", "[validation]") {
+    Validator validator {};
+    Schema schema { "test-schema" };
+    schema.addConstraint("id", TypeConstraint::String, true);
+    schema.addConstraint("message_type", TypeConstraint::String, true);
+    schema.addConstraint("targets", TypeConstraint::Array, true);
+    schema.addConstraint("expires", TypeConstraint::String, true);
+    schema.addConstraint("sender", TypeConstraint::String, false);
+    validator.registerSchema(schema);
+
+    lth_jc::JsonContainer data {
+        "{\"id\" : \"f0e71a48-969c-4377-b953-35f0fc55c388\", "
+        "\"message_type\" : \"http://puppetlabs.com/rpc_blocking_request\", "
+        "\"targets\" : [\"pcp://client01.example.com/agent\"], "
+        "\"expires\" : \"2015-06-26T22:57:09Z\", "
+        "\"sender\" : \"pcp://client02.example.com/agent\"}" };
+    static const std::size_t num_items { 100000 };
+    std::vector<ValidationItem> items(num_items, ValidationItem { data, "test-schema" });
+
+    auto max_workers = std::max(Util::thread::hardware_concurrency(), 1u);
+    double single_worker_time { 0 };
+
+    for (unsigned int num_workers = 1; num_workers <= max_workers; num_workers *= 2) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto results = validator.validateBatch(items, num_workers);
+        auto execution_time =
+            static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - start)
+                        .count());
+
+        REQUIRE(std::all_of(results.begin(), results.end(),
+                            [](const ValidationResult& r) {
+                                return r.status == ValidationStatus::Valid;
+                            }));
+        if (num_workers == 1)
+            single_worker_time = execution_time;
+
+        std::cout << "  time to validate a batch of " << num_items
+                  << " items with " << num_workers << " workers: "
+                  << execution_time / (1000 * 1000) << " s ("
+                  << static_cast<int>((num_items / execution_time) * (1000 * 1000))
+                  << " items/s, speedup " << single_worker_time / execution_time
+                  << ")\n";
+    }
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cpp-pcp-client/validator/validator.hpp>
+#include <cpp-pcp-client/validator/schema.hpp>
+
+#include <leatherman/json_container/json_container.hpp>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PCPClient {
+
+namespace lth_jc = leatherman::json_container;
+
+// A property name and a valid JSON value for it
+using PropertySample = std::pair<std::string, std::string>;
+
+// JSON values of all types, including the integer corner cases
+static const std::vector<std::string> JSON_VALUE_SAMPLES {
+    "\"spam\"", "\"\"", "0", "-1", "2147483648", "-9223372036854775808",
+    "18446744073709551615", "1.5", "-0.0", "1e300", "true", "false", "null",
+    "[]", "[\"spam\", 1]", "{}", "{\"spam\" : \"eggs\"}" };
+
+// Property names that are not expected to be in the tested schemas
+static const std::vector<std::string> UNKNOWN_PROPERTY_SAMPLES {
+    "", "spam", "ID", "i", "idd", "in_reply", "id ", "data_" };
+
+inline std::string toJsonObject(const std::vector<PropertySample>& properties) {
+    std::string json_txt { "{" };
+
+    for (const auto& property : properties) {
+        if (json_txt.size() > 1)
+            json_txt += ", ";
+        json_txt += "\"" + property.first + "\" : " + property.second;
+    }
+
+    return json_txt + "}";
+}
+
+// Generate JSON documents to be checked against the schema whose
+// valid properties are passed: a valid document, then the same one
+// without each property, with a duplicate of each property, with
+// each property set to each JSON value sample and with each unknown
+// property; then arrays, instead of objects, and, last, random
+// combinations of known and unknown properties
+inline std::vector<std::string> generateDocuments(
+        const std::vector<PropertySample>& valid_properties,
+        unsigned int num_random_documents = 2000) {
+    std::vector<std::string> documents { toJsonObject(valid_properties) };
+
+    for (std::size_t idx = 0; idx < valid_properties.size(); idx++) {
+        auto properties = valid_properties;
+        properties.erase(properties.begin() + idx);
+        documents.push_back(toJsonObject(properties));
+
+        properties = valid_properties;
+        properties.push_back(valid_properties[idx]);
+        documents.push_back(toJsonObject(properties));
+
+        for (const auto& value : JSON_VALUE_SAMPLES) {
+            properties = valid_properties;
+            properties[idx].second = value;
+            documents.push_back(toJsonObject(properties));
+        }
+    }
+
+    for (const auto& name : UNKNOWN_PROPERTY_SAMPLES) {
+        auto properties = valid_properties;
+        properties.push_back(PropertySample { name, "\"spam\"" });
+        documents.push_back(toJsonObject(properties));
+    }
+
+    for (const auto& value : JSON_VALUE_SAMPLES)
+        documents.push_back("[" + value + "]");
+
+    // NB: fixed seed, so that failures can be reproduced
+    std::mt19937 generator { 42 };
+    std::vector<std::string> names {};
+
+    for (const auto& property : valid_properties)
+        names.push_back(property.first);
+    names.insert(names.end(),
+                 UNKNOWN_PROPERTY_SAMPLES.begin(), UNKNOWN_PROPERTY_SAMPLES.end());
+
+    std::uniform_int_distribution<std::size_t> num_properties_dist { 0, names.size() };
+    std::uniform_int_distribution<std::size_t> name_dist { 0, names.size() - 1 };
+    std::uniform_int_distribution<std::size_t> value_dist {
+        0, valid_properties.size() + JSON_VALUE_SAMPLES.size() - 1 };
+
+    for (unsigned int doc_idx = 0; doc_idx < num_random_documents; doc_idx++) {
+        std::vector<PropertySample> properties {};
+        auto num_properties = num_properties_dist(generator);
+
+        for (std::size_t idx = 0; idx < num_properties; idx++) {
+            // Valid values are as likely as the samples of each type
+            auto value_idx = value_dist(generator);
+            auto value = value_idx < valid_properties.size()
+                         ? valid_properties[value_idx].second
+                         : JSON_VALUE_SAMPLES[value_idx - valid_properties.size()];
+            properties.push_back(PropertySample { names[name_dist(generator)], value });
+        }
+
+        documents.push_back(toJsonObject(properties));
+    }
+
+    return documents;
+}
+
+inline bool isValid(const Validator& validator,
+                    const lth_jc::JsonContainer& data,
+                    const std::string& schema_name) {
+    try {
+        validator.validate(data, schema_name);
+        return true;
+    } catch (const validation_error&) {
+        return false;
+    }
+}
+
+// Return the documents for which the native validator of the
+// specified schema and the valijson one disagree
+inline std::vector<std::string> getDisagreements(Schema schema,
+                                                 const std::vector<std::string>& documents) {
+    Validator native_validator {};
+    native_validator.registerSchema(schema);
+
+    Validator valijson_validator {};
+    schema.setNativeValidator(nullptr);
+    valijson_validator.registerSchema(schema);
+
+    std::vector<std::string> disagreements {};
+
+    for (const auto& document : documents) {
+        lth_jc::JsonContainer data { document };
+
+        if (isValid(native_validator, data, schema.getName())
+                != isValid(valijson_validator, data, schema.getName()))
+            disagreements.push_back(document);
+    }
+
+    return disagreements;
+}
+
+inline bool isValidText(const Validator& validator,
+                        const std::string& json_txt,
+                        const std::string& schema_name) {
+    try {
+        validator.validateText(json_txt, schema_name);
+        return true;
+    } catch (const validation_error&) {
+        return false;
+    }
+}
+
+// Return the documents for which the streaming validation of the
+// specified schema (see Validator::validateText) and the valijson
+// one disagree
+inline std::vector<std::string> getStreamingDisagreements(
+        Schema schema,
+        const std::vector<std::string>& documents) {
+    schema.setNativeValidator(nullptr);
+    Validator validator {};
+    validator.registerSchema(schema);
+
+    std::vector<std::string> disagreements {};
+
+    for (const auto& document : documents) {
+        if (isValidText(validator, document, schema.getName())
+                != isValid(validator, lth_jc::JsonContainer { document },
+                           schema.getName()))
+            disagreements.push_back(document);
+    }
+
+    return disagreements;
+}
+
+}  // namespace PCPClient
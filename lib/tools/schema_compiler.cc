@@ -0,0 +1,592 @@
+// Generate C++ validation functions from JSON schema files; it's
+// meant to be run by the pcp_compile_schemas CMake function (see
+// lib/CMakeLists.txt).
+//
+// Usage:
+//   cpp-pcp-client-schema-compiler <namespace> <header> <source> <schema>...
+//
+// For each schema file, the generated source defines a function
+//   bool validate<Name>(const leatherman::json_container::JsonContainer&)
+// where <Name> is the file name, without extension, in camel case;
+// such functions can be registered with the
+// PCPClient::Validator::registerCompiledSchema method.
+//
+// Only a subset of JSON Schema draft 4 is supported: type,
+// properties, additionalProperties, required, items (as a single
+// schema), minimum, maximum, exclusiveMinimum, exclusiveMaximum,
+// minItems, maxItems, minProperties and maxProperties. The compiler
+// fails on the other keywords that valijson knows, so that a
+// generated function accepts exactly the data that valijson accepts
+// for the same schema; unknown keywords are ignored, as valijson does.
+
+#include <leatherman/json_container/json_container.hpp>
+#include <leatherman/locale/locale.hpp>
+
+#include <boost/nowide/fstream.hpp>
+#include <boost/nowide/iostream.hpp>
+
+#include <rapidjson/document.h>
+
+#include <cctype>
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lth_jc  = leatherman::json_container;
+namespace lth_loc = leatherman::locale;
+
+using JsonValue = rapidjson::GenericValue<rapidjson::UTF8<char>, rapidjson::CrtAllocator>;
+
+class schema_compiler_error : public std::runtime_error {
+  public:
+    explicit schema_compiler_error(std::string const& msg)
+        : std::runtime_error(msg) {}
+};
+
+// Keywords interpreted by valijson that we don't translate
+static const std::set<std::string> UNSUPPORTED_KEYWORDS {
+    "$ref", "additionalItems", "allOf", "anyOf", "dependencies",
+    "divisibleBy", "enum", "maxLength", "minLength", "multipleOf", "not",
+    "oneOf", "pattern", "patternProperties", "uniqueItems" };
+
+//
+// Auxiliary functions
+//
+
+static std::string readFile(const std::string& file_path) {
+    boost::nowide::ifstream file { file_path.c_str() };
+
+    if (!file) {
+        throw schema_compiler_error {
+            lth_loc::format("failed to open '{1}'", file_path) };
+    }
+
+    std::stringstream buffer {};
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+static void writeFile(const std::string& file_path, const std::string& content) {
+    boost::nowide::ofstream file { file_path.c_str(), std::ios::binary };
+    file << content;
+
+    if (!file) {
+        throw schema_compiler_error {
+            lth_loc::format("failed to write '{1}'", file_path) };
+    }
+}
+
+static std::string getBaseName(const std::string& file_path, bool strip_extension) {
+    auto name = file_path.substr(file_path.find_last_of("/\\") + 1);
+    return strip_extension ? name.substr(0, name.rfind('.')) : name;
+}
+
+// "inventory_request.json" -> "validateInventoryRequest"
+static std::string getFunctionName(const std::string& file_path) {
+    std::string function_name { "validate" };
+    auto capitalize = true;
+
+    for (auto c : getBaseName(file_path, true)) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) {
+            capitalize = true;
+        } else {
+            function_name += capitalize
+                             ? static_cast<char>(std::toupper(static_cast<unsigned char>(c)))
+                             : c;
+            capitalize = false;
+        }
+    }
+
+    if (function_name == "validate") {
+        throw schema_compiler_error {
+            lth_loc::format("cannot derive a function name from '{1}'", file_path) };
+    }
+
+    return function_name;
+}
+
+// Return a C++ string literal; non alphanumeric characters are
+// escaped as octal sequences, so that any byte is supported
+static std::string toLiteral(const char* str, std::size_t length) {
+    std::string literal { "\"" };
+
+    for (std::size_t idx = 0; idx < length; idx++) {
+        auto c = static_cast<unsigned char>(str[idx]);
+
+        if (std::isalnum(c) || c == '_' || c == '-' || c == ' ') {
+            literal += static_cast<char>(c);
+        } else {
+            char escaped[5];
+            std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            literal += escaped;
+        }
+    }
+
+    return literal + "\"";
+}
+
+static std::string toLiteral(double number) {
+    char literal[32];
+    std::snprintf(literal, sizeof(literal), "%.17g", number);
+    return literal;
+}
+
+static std::string getKeywordName(const JsonValue& name) {
+    return std::string(name.GetString(), name.GetStringLength());
+}
+
+static const JsonValue* findKeyword(const JsonValue& schema, const char* keyword) {
+    for (auto itr = schema.MemberBegin(); itr != schema.MemberEnd(); ++itr)
+        if (getKeywordName(itr->name) == keyword)
+            return &itr->value;
+    return nullptr;
+}
+
+static unsigned long long getCount(const JsonValue& value, const std::string& keyword) {
+    if (value.IsUint64())
+        return value.GetUint64();
+
+    throw schema_compiler_error {
+        lth_loc::format("'{1}' must be a non negative integer", keyword) };
+}
+
+//
+// Generator
+//
+
+// Generates the statements that validate the value of a variable;
+// each statement returns false if validation fails
+class Generator {
+  public:
+    Generator() : num_vars_ { 0 } {}
+
+    std::string generateFunction(const std::string& function_name,
+                                 const JsonValue& schema) {
+        num_vars_ = 0;
+        std::string body { generateSchema(schema, "value0", 1) };
+        std::string function {
+            "bool " + function_name + "(const lth_jc::JsonContainer& data) {\n" };
+
+        if (!body.empty())
+            function += "    const auto& value0 = data.getRaw();\n" + body;
+
+        return function + "    return true;\n}\n";
+    }
+
+  private:
+    unsigned int num_vars_;
+
+    static std::string indentation(unsigned int indent) {
+        return std::string(4 * indent, ' ');
+    }
+
+    std::string generateSchema(const JsonValue& schema,
+                               const std::string& var,
+                               unsigned int indent) {
+        if (!schema.IsObject())
+            throw schema_compiler_error { lth_loc::translate("a schema must be an object") };
+
+        for (auto itr = schema.MemberBegin(); itr != schema.MemberEnd(); ++itr) {
+            auto keyword = getKeywordName(itr->name);
+
+            if (UNSUPPORTED_KEYWORDS.find(keyword) != UNSUPPORTED_KEYWORDS.end()) {
+                throw schema_compiler_error {
+                    lth_loc::format("the '{1}' keyword is not supported", keyword) };
+            }
+        }
+
+        std::string code {};
+        const JsonValue* keyword_value { nullptr };
+
+        if ((keyword_value = findKeyword(schema, "type")))
+            code += generateType(*keyword_value, var, indent);
+
+        if ((keyword_value = findKeyword(schema, "required")))
+            code += generateRequired(*keyword_value, var, indent);
+
+        code += generateBound(schema, "minimum", "exclusiveMinimum", "<", var, indent);
+        code += generateBound(schema, "maximum", "exclusiveMaximum", ">", var, indent);
+        code += generateCount(schema, "minItems", "IsArray()", "Size()", "<", var, indent);
+        code += generateCount(schema, "maxItems", "IsArray()", "Size()", ">", var, indent);
+        code += generateCount(schema, "minProperties", "IsObject()",
+                              "MemberEnd() - " + var + ".MemberBegin()", "<", var, indent);
+        code += generateCount(schema, "maxProperties", "IsObject()",
+                              "MemberEnd() - " + var + ".MemberBegin()", ">", var, indent);
+
+        if ((keyword_value = findKeyword(schema, "items")))
+            code += generateItems(*keyword_value, var, indent);
+
+        auto properties = findKeyword(schema, "properties");
+        auto additional_properties = findKeyword(schema, "additionalProperties");
+
+        if (properties != nullptr || additional_properties != nullptr)
+            code += generateProperties(properties, additional_properties, var, indent);
+
+        return code;
+    }
+
+    std::string generateType(const JsonValue& type,
+                             const std::string& var,
+                             unsigned int indent) {
+        std::vector<const JsonValue*> type_names {};
+
+        if (type.IsString()) {
+            type_names.push_back(&type);
+        } else if (type.IsArray()) {
+            for (auto itr = type.Begin(); itr != type.End(); ++itr)
+                type_names.push_back(&*itr);
+        }
+
+        if (type_names.empty() && !type.IsArray())
+            throw schema_compiler_error { lth_loc::translate("'type' must be a string or an array") };
+
+        std::string condition {};
+
+        for (auto type_name : type_names) {
+            if (!type_name->IsString())
+                throw schema_compiler_error { lth_loc::translate("type names must be strings") };
+
+            auto name = getKeywordName(*type_name);
+            std::string check {};
+
+            if (name == "object") {
+                check = var + ".IsObject()";
+            } else if (name == "array") {
+                check = var + ".IsArray()";
+            } else if (name == "string") {
+                check = var + ".IsString()";
+            } else if (name == "integer") {
+                check = var + ".IsInt() || " + var + ".IsUint() || "
+                        + var + ".IsInt64() || " + var + ".IsUint64()";
+            } else if (name == "number") {
+                check = var + ".IsNumber()";
+            } else if (name == "boolean") {
+                check = var + ".IsBool()";
+            } else if (name == "null") {
+                check = var + ".IsNull()";
+            } else {
+                throw schema_compiler_error {
+                    lth_loc::format("the '{1}' type is not supported", name) };
+            }
+
+            condition += (condition.empty() ? "" : " || ") + check;
+        }
+
+        // NB: an empty list of types matches nothing
+        if (condition.empty())
+            condition = "false";
+
+        return indentation(indent) + "if (!(" + condition + "))\n"
+               + indentation(indent + 1) + "return false;\n";
+    }
+
+    std::string generateRequired(const JsonValue& required,
+                                 const std::string& var,
+                                 unsigned int indent) {
+        if (!required.IsArray())
+            throw schema_compiler_error { lth_loc::translate("'required' must be an array") };
+
+        // NB: valijson fails the 'required' constraint for any value
+        //     that is not an object, even with no required property
+        std::string code { indentation(indent) + "if (!" + var + ".IsObject())\n"
+                           + indentation(indent + 1) + "return false;\n" };
+
+        for (auto itr = required.Begin(); itr != required.End(); ++itr) {
+            if (!itr->IsString())
+                throw schema_compiler_error { lth_loc::translate("required properties must be strings") };
+
+            code += indentation(indent) + "if (!hasMember(" + var + ", "
+                    + toLiteral(itr->GetString(), itr->GetStringLength()) + ", "
+                    + std::to_string(itr->GetStringLength()) + "))\n"
+                    + indentation(indent + 1) + "return false;\n";
+        }
+
+        return code;
+    }
+
+    std::string generateBound(const JsonValue& schema,
+                              const char* keyword,
+                              const char* exclusive_keyword,
+                              const std::string& comparison,
+                              const std::string& var,
+                              unsigned int indent) {
+        auto bound = findKeyword(schema, keyword);
+
+        // NB: like valijson, ignore an exclusive flag with no bound
+        if (bound == nullptr)
+            return "";
+
+        if (!bound->IsNumber()) {
+            throw schema_compiler_error {
+                lth_loc::format("'{1}' must be a number", keyword) };
+        }
+
+        auto exclusive = findKeyword(schema, exclusive_keyword);
+
+        if (exclusive != nullptr && !exclusive->IsBool()) {
+            throw schema_compiler_error {
+                lth_loc::format("'{1}' must be a boolean", exclusive_keyword) };
+        }
+
+        auto op = comparison + (exclusive != nullptr && exclusive->GetBool() ? "=" : "");
+
+        return indentation(indent) + "if (" + var + ".IsNumber() && getNumber(" + var
+               + ") " + op + " " + toLiteral(bound->GetDouble()) + ")\n"
+               + indentation(indent + 1) + "return false;\n";
+    }
+
+    std::string generateCount(const JsonValue& schema,
+                              const char* keyword,
+                              const std::string& type_check,
+                              const std::string& count,
+                              const std::string& comparison,
+                              const std::string& var,
+                              unsigned int indent) {
+        auto limit = findKeyword(schema, keyword);
+
+        if (limit == nullptr)
+            return "";
+
+        return indentation(indent) + "if (" + var + "." + type_check + " && static_cast<"
+               "unsigned long long>(" + var + "." + count + ") " + comparison + " "
+               + std::to_string(getCount(*limit, keyword)) + "ULL)\n"
+               + indentation(indent + 1) + "return false;\n";
+    }
+
+    std::string generateItems(const JsonValue& items,
+                              const std::string& var,
+                              unsigned int indent) {
+        if (!items.IsObject()) {
+            throw schema_compiler_error {
+                lth_loc::translate("'items' is only supported as a single schema") };
+        }
+
+        auto item_var = "value" + std::to_string(++num_vars_);
+        auto itr_var = "itr" + std::to_string(num_vars_);
+        auto item_code = generateSchema(items, item_var, indent + 2);
+
+        if (item_code.empty())
+            return "";
+
+        return indentation(indent) + "if (" + var + ".IsArray()) {\n"
+               + indentation(indent + 1) + "for (auto " + itr_var + " = " + var
+               + ".Begin(); " + itr_var + " != " + var + ".End(); ++" + itr_var + ") {\n"
+               + indentation(indent + 2) + "const auto& " + item_var + " = *" + itr_var + ";\n"
+               + item_code
+               + indentation(indent + 1) + "}\n"
+               + indentation(indent) + "}\n";
+    }
+
+    std::string generateProperties(const JsonValue* properties,
+                                   const JsonValue* additional_properties,
+                                   const std::string& var,
+                                   unsigned int indent) {
+        if (properties != nullptr && !properties->IsObject())
+            throw schema_compiler_error { lth_loc::translate("'properties' must be an object") };
+
+        auto member_var = "value" + std::to_string(++num_vars_);
+        auto itr_var = "itr" + std::to_string(num_vars_);
+
+        // As in valijson, a property listed more than once must
+        // match all its schemas
+        std::vector<std::pair<std::string, std::string>> property_codes {};
+
+        if (properties != nullptr) {
+            for (auto itr = properties->MemberBegin(); itr != properties->MemberEnd(); ++itr) {
+                auto name = toLiteral(itr->name.GetString(), itr->name.GetStringLength())
+                            + ", " + std::to_string(itr->name.GetStringLength());
+                auto property_code = generateSchema(itr->value, member_var, indent + 3);
+                auto found = false;
+
+                for (auto& named_code : property_codes) {
+                    if (named_code.first == name) {
+                        named_code.second += property_code;
+                        found = true;
+                    }
+                }
+
+                if (!found)
+                    property_codes.push_back(std::make_pair(name, property_code));
+            }
+        }
+
+        // NB: additional properties are allowed by default
+        std::string additional_code {};
+
+        if (additional_properties == nullptr) {
+        } else if (additional_properties->IsBool()) {
+            if (!additional_properties->GetBool())
+                additional_code = indentation(indent + 3) + "return false;\n";
+        } else if (additional_properties->IsObject()) {
+            additional_code = generateSchema(*additional_properties, member_var, indent + 3);
+        } else {
+            throw schema_compiler_error {
+                lth_loc::translate("'additionalProperties' must be a boolean or an object") };
+        }
+
+        std::string branches {};
+
+        for (const auto& named_code : property_codes) {
+            branches += indentation(indent + 2) + (branches.empty() ? "if" : "} else if")
+                        + " (isName(" + itr_var + "->name, " + named_code.first + ")) {\n"
+                        + named_code.second;
+        }
+
+        if (branches.empty()) {
+            if (additional_code.empty())
+                return "";
+            branches = additional_code;
+        } else {
+            if (!additional_code.empty())
+                branches += indentation(indent + 2) + "} else {\n" + additional_code;
+            branches += indentation(indent + 2) + "}\n";
+        }
+
+        return indentation(indent) + "if (" + var + ".IsObject()) {\n"
+               + indentation(indent + 1) + "for (auto " + itr_var + " = " + var
+               + ".MemberBegin(); " + itr_var + " != " + var + ".MemberEnd(); ++"
+               + itr_var + ") {\n"
+               + indentation(indent + 2) + "const auto& " + member_var + " = "
+               + itr_var + "->value;\n"
+               + indentation(indent + 2) + "(void) " + member_var + ";\n"
+               + branches
+               + indentation(indent + 1) + "}\n"
+               + indentation(indent) + "}\n";
+    }
+};
+
+//
+// Output
+//
+
+static const std::string HELPERS {
+    "namespace {\n"
+    "\n"
+    "namespace lth_jc = leatherman::json_container;\n"
+    "\n"
+    "template <typename String>\n"
+    "bool isName(const String& name, const char* expected, std::size_t length) {\n"
+    "    return name.GetStringLength() == length\n"
+    "           && std::memcmp(name.GetString(), expected, length) == 0;\n"
+    "}\n"
+    "\n"
+    "template <typename Object>\n"
+    "bool hasMember(const Object& object, const char* name, std::size_t length) {\n"
+    "    for (auto itr = object.MemberBegin(); itr != object.MemberEnd(); ++itr)\n"
+    "        if (isName(itr->name, name, length))\n"
+    "            return true;\n"
+    "    return false;\n"
+    "}\n"
+    "\n"
+    "// As in valijson, integers are converted to double via int64_t\n"
+    "template <typename Number>\n"
+    "double getNumber(const Number& number) {\n"
+    "    if (number.IsDouble())\n"
+    "        return number.GetDouble();\n"
+    "    if (number.IsInt())\n"
+    "        return number.GetInt();\n"
+    "    if (number.IsInt64())\n"
+    "        return static_cast<double>(number.GetInt64());\n"
+    "    if (number.IsUint())\n"
+    "        return static_cast<double>(static_cast<int64_t>(number.GetUint()));\n"
+    "    return static_cast<double>(static_cast<int64_t>(number.GetUint64()));\n"
+    "}\n"
+    "\n"
+    "}  // namespace\n" };
+
+static std::vector<std::string> splitNamespace(const std::string& name_space) {
+    std::vector<std::string> names {};
+    std::string::size_type start { 0 };
+
+    while (start <= name_space.size()) {
+        auto end = name_space.find("::", start);
+        if (end == std::string::npos)
+            end = name_space.size();
+
+        auto name = name_space.substr(start, end - start);
+        if (name.empty())
+            throw schema_compiler_error {
+                lth_loc::format("invalid namespace '{1}'", name_space) };
+
+        names.push_back(name);
+        start = end + 2;
+    }
+
+    return names;
+}
+
+static std::string openNamespaces(const std::vector<std::string>& names) {
+    std::string code {};
+    for (const auto& name : names)
+        code += "namespace " + name + " {\n";
+    return code;
+}
+
+static std::string closeNamespaces(const std::vector<std::string>& names) {
+    std::string code {};
+    for (auto itr = names.rbegin(); itr != names.rend(); ++itr)
+        code += "}  // namespace " + *itr + "\n";
+    return code;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        boost::nowide::cerr << "usage: cpp-pcp-client-schema-compiler "
+                            << "<namespace> <header> <source> <schema>...\n";
+        return 2;
+    }
+
+    std::string header_path { argv[2] };
+    std::string source_path { argv[3] };
+    std::string schema_path {};
+
+    try {
+        auto namespaces = splitNamespace(argv[1]);
+        static const std::string banner {
+            "// Generated by cpp-pcp-client-schema-compiler; do not edit\n\n" };
+        std::string header { banner + "#pragma once\n\n"
+                             "#include <leatherman/json_container/json_container.hpp>\n\n"
+                             + openNamespaces(namespaces) + "\n" };
+        std::string source { banner + "#include \"" + getBaseName(header_path, false) + "\"\n\n"
+                             "#include <rapidjson/document.h>\n\n"
+                             "#include <cstddef>\n"
+                             "#include <cstdint>\n"
+                             "#include <cstring>\n\n"
+                             + HELPERS + "\n" + openNamespaces(namespaces) };
+        std::set<std::string> function_names {};
+        Generator generator {};
+
+        for (int idx = 4; idx < argc; idx++) {
+            schema_path = argv[idx];
+            auto function_name = getFunctionName(schema_path);
+
+            if (!function_names.insert(function_name).second) {
+                throw schema_compiler_error {
+                    lth_loc::format("more than one schema for function '{1}'", function_name) };
+            }
+
+            lth_jc::JsonContainer schema { readFile(schema_path) };
+
+            header += "// " + getBaseName(schema_path, false) + "\n"
+                      "bool " + function_name
+                      + "(const leatherman::json_container::JsonContainer& data);\n\n";
+            source += "\n// " + getBaseName(schema_path, false) + "\n"
+                      + generator.generateFunction(function_name, schema.getRaw());
+        }
+
+        schema_path.clear();
+        writeFile(header_path, header + closeNamespaces(namespaces));
+        writeFile(source_path, source + "\n" + closeNamespaces(namespaces));
+    } catch (const std::exception& e) {
+        boost::nowide::cerr << "cpp-pcp-client-schema-compiler: "
+                            << (schema_path.empty() ? "" : schema_path + ": ")
+                            << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}